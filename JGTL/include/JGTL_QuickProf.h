@@ -338,6 +338,19 @@ namespace JGTL
 		*/
 		inline void endBlock(const std::string& name);
 
+		/**
+		Adds a duration that was measured elsewhere to the named block.
+
+		Unlike beginBlock and endBlock, this does not keep a start time in
+		the block, so it also works for blocks that run on several threads
+		at once, as long as the calls themselves are serialized.
+
+		@param name         The name of the block.
+		@param microseconds The duration to add.
+		*/
+		inline void addBlockTime(const std::string& name,
+			unsigned long int microseconds);
+
 		inline void beginCycle();
 
 		/**
@@ -618,6 +631,39 @@ namespace JGTL
 		block->totalMicroseconds += blockDuration;
 	}
 
+	void Profiler::addBlockTime(const std::string& name,
+		unsigned long int microseconds)
+	{
+		if (!mEnabled || !inCycle)
+		{
+			return;
+		}
+
+		if (name.empty())
+		{
+			printError("Cannot allow unnamed profile blocks.");
+			return;
+		}
+
+		ProfileBlock** blockPtr = mProfileBlocks.getData(name);
+		ProfileBlock* block;
+
+		if (!blockPtr)
+		{
+			// Create a new ProfileBlock.
+			mProfileBlocks.insert(name,new ProfileBlock());
+			block = mProfileBlocks.getDataRef(name);
+		}
+		else
+		{
+			block = (*blockPtr);
+		}
+
+		block->currentCycleTotalMicroseconds += microseconds;
+
+		block->totalMicroseconds += microseconds;
+	}
+
 	void Profiler::beginCycle()
 	{
 		if (!mEnabled)
@@ -22,6 +22,11 @@ namespace HCUBE
 
         int outputLayerIndx; // The index of the substrate layer at which the output nodes are located
 
+        // Number of frames each selected action is held for (the FrameSkip
+        // parameter).  The objects are painted onto the substrate and the
+        // substrate is updated once per action, not once per frame.
+        int frameSkip;
+
     public: // TODO: Make this protected 
         NEAT::LayeredSubstrate<float> substrate;
 
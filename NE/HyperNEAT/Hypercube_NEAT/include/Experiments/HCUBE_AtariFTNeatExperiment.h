@@ -23,10 +23,30 @@ namespace HCUBE
         int numActions;
         int numObjClasses;
 
+        // Number of frames each selected action is held for (the FrameSkip
+        // parameter).  It is read like AtariExperiment's, so both halves of a
+        // hybrid run pick their actions at the same interval.
+        int frameSkip;
+
     public:
         NEAT::FastNetwork<float> substrate;
         map<Node,string> nameLookup; // Name lookup table
 
+        // Substrate node indices, resolved once per individual so the per-frame
+        // code does not go through nameLookup and the network's name map.
+        // Inputs are indexed by (substrateIndx*substrate_height+y)*substrate_width+x
+        vector<int> inputNodeIndices;
+        vector<int> outputNodeIndices;
+
+        // The node genes of an individual in the order createInitialPopulation()
+        // makes them, with the HyperNEAT substrate node each one stands for, and
+        // its links as pairs of indices into these.  Built once per topology by
+        // initializeExperiment(), so convertIndividual() copies weights by index.
+        vector<string> geneNames;
+        vector<Node> geneSubstrateNodes;
+        vector<pair<int,int> > geneLinks;
+        int numInputGenes;
+
         void initializeExperiment(string rom_file);
 
         AtariFTNeatExperiment(string _experimentName,int _threadID);
@@ -43,11 +63,23 @@ namespace HCUBE
         // Sets the weights of the FTNEAT_individual from the HyperNEAT_individual
         void convertIndividual(shared_ptr<NEAT::GeneticIndividual> FTNEAT_individual,
                                NEAT::LayeredSubstrate<float>* HyperNEAT_substrate);
+
+        // As convertIndividual, but finds each gene by name.  Used for individuals
+        // whose genes are no longer in the order of createInitialPopulation()
+        void convertIndividualByName(shared_ptr<NEAT::GeneticIndividual> FTNEAT_individual,
+                                     NEAT::LayeredSubstrate<float>* HyperNEAT_substrate);
+
+        // True when the first node and link genes of the individual are the
+        // ones geneNames and geneLinks describe, in that order
+        bool hasInitialGeneOrder(shared_ptr<NEAT::GeneticIndividual> individual);
         
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
         virtual void evaluateIndividual(shared_ptr<NEAT::GeneticIndividual> individual);
         void runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual);
 
+        // Resolves inputNodeIndices/outputNodeIndices for the current substrate
+        void resolveNodeIndices();
+
         // Locates the object of each class on screen and populates their values to the
         // corresponding substrate layers
         void setSubstrateObjectValues(VisualProcessor& visProc);
@@ -43,6 +43,11 @@ namespace HCUBE
         int numActions, numFeatures;
         int numObjClasses;
 
+        // Number of frames each action of the Sarsa agent is held for (the
+        // FrameSkip parameter).  phi is painted and the agent acts once per
+        // action, and it learns from the reward summed over the held frames.
+        int frameSkip;
+
         SarsaLambda *agent;
         std::vector<bool> phi;
 
@@ -50,6 +55,10 @@ namespace HCUBE
         NEAT::FastNetwork<double> substrate;
         map<Node,string> nameLookup; // Name lookup table
 
+        // Substrate input node indices, resolved once per individual.
+        // Indexed by (substrateIndx*substrate_height+y)*substrate_width+x
+        vector<int> inputNodeIndices;
+
         void initializeExperiment(string rom_file);
 
         AtariIntrinsicExperiment(string _experimentName,int _threadID);
@@ -59,6 +68,9 @@ namespace HCUBE
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
         void runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual);
 
+        // Resolves inputNodeIndices for the current substrate
+        void resolveNodeIndices();
+
         // Locates the object of each class on screen and populates their values to the
         // corresponding substrate layers
         void setSubstrateObjectValues(VisualProcessor& visProc);
@@ -22,10 +22,21 @@ namespace HCUBE
         int numActions;
         int numObjClasses;
 
+        // Number of frames each selected action is held for (the FrameSkip
+        // parameter).  The network's inputs are set and it is updated once
+        // per action.
+        int frameSkip;
+
     public:
         NEAT::FastNetwork<double> substrate;
         map<Node,string> nameLookup; // Name lookup table
 
+        // Substrate node indices, resolved once per individual so the per-frame
+        // code does not go through nameLookup and the network's name map.
+        // Inputs are indexed by (substrateIndx*substrate_height+y)*substrate_width+x
+        vector<int> inputNodeIndices;
+        vector<int> outputNodeIndices;
+
         void initializeExperiment(string rom_file);
 
         AtariNoGeomExperiment(string _experimentName,int _threadID);
@@ -35,6 +46,9 @@ namespace HCUBE
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
         void runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual);
 
+        // Resolves inputNodeIndices/outputNodeIndices for the current substrate
+        void resolveNodeIndices();
+
         // Locates the object of each class on screen and populates their values to the
         // corresponding substrate layers
         void setSubstrateObjectValues(VisualProcessor& visProc);
@@ -24,6 +24,14 @@ extern "C"
 
 #define MAX_TOTAL_MOVES (262144)
 
+//Must be a power of two.  Each bucket fills one 64 byte cache line.
+#define CHECKERS_TRANSPOSITION_TABLE_BUCKETS (65536)
+
+#define CHECKERS_MAX_BITBOARD_MOVES (128)
+
+//The from square of a bitboard move that hasn't been chosen
+#define CHECKERS_NO_BITBOARD_MOVE (255)
+
 /*
  * The data type to be used in the checkers experiments.
  * -NOTE- This should be a float for speed reasons.  It should only
@@ -44,7 +52,7 @@ namespace HCUBE
         uchar pieceCaptured;
         CheckersMove *nextJump;
         bool promoted;
-        boost::shared_ptr<CheckersMovePool> checkersMovePoolPtr;
+        boost::shared_ptr<CheckersMovePool> checkersMovePoolPtr;
 
         CheckersMove();
 
@@ -96,6 +104,237 @@ namespace HCUBE
 
     typedef vector<CheckersMove>::iterator MoveListIterator;
 
+    /**
+    * CheckersBitboard is a position stored as masks over the 32 dark squares.
+    * Square s is at x=s/4, y=2*(s%4)+(x%2), which is the order generateMoveList
+    * walks the board in, so both generators return moves in the same order.
+    */
+    class CheckersBitboard
+    {
+    public:
+        unsigned int black;
+        unsigned int white;
+        unsigned int kings;
+
+        CheckersBitboard()
+            :
+        black(0),
+            white(0),
+            kings(0)
+        {}
+
+        CheckersBitboard(uchar b[8][8]);
+
+        /**
+        * Writes the position to a board, including the piece counts
+        */
+        void toBoard(uchar b[8][8]) const;
+
+        inline unsigned int getPieces(int color) const
+        {
+            return (color==BLACK) ? black : white;
+        }
+
+        inline unsigned int getEmpty() const
+        {
+            return ~(black|white);
+        }
+
+        inline bool operator==(const CheckersBitboard &other) const
+        {
+            return black==other.black && white==other.white && kings==other.kings;
+        }
+
+        static inline int getSquare(int x,int y)
+        {
+            return x*4 + y/2;
+        }
+
+        static inline int getX(int square)
+        {
+            return square/4;
+        }
+
+        static inline int getY(int square)
+        {
+            return 2*(square%4) + (square/4)%2;
+        }
+    };
+
+    class CheckersBitboardMove
+    {
+    public:
+        //Squares, see CheckersBitboard
+        uchar from,to;
+        bool promoted;
+        unsigned int captured;
+    };
+
+    /**
+    * CheckersTranspositionTable is a fixed-size table of searched positions
+    * indexed by their Zobrist key.  Entries are grouped into buckets that each
+    * fill one cache line, so a probe touches a single line of memory.
+    * Copies of a table start out empty.
+    */
+    class CheckersTranspositionTable
+    {
+    public:
+        enum BoundType
+        {
+            BOUND_NONE=0,
+            BOUND_EXACT,
+            BOUND_LOWER,
+            BOUND_UPPER
+        };
+
+        //bestMove is the index of the move in generation order
+        enum { NO_MOVE=255 };
+
+        struct Entry
+        {
+            unsigned long long key;
+            CheckersNEATDatatype value;
+            signed char depth;
+            uchar bound;
+            uchar bestMove;
+        };
+
+    protected:
+        enum { BUCKET_BYTES=64 };
+
+        char *storage;
+        char *buckets;
+        int bucketCount;
+
+    public:
+        CheckersTranspositionTable(int _bucketCount=CHECKERS_TRANSPOSITION_TABLE_BUCKETS);
+
+        CheckersTranspositionTable(const CheckersTranspositionTable &other);
+
+        const CheckersTranspositionTable &operator=(const CheckersTranspositionTable &other);
+
+        virtual ~CheckersTranspositionTable();
+
+        void clear();
+
+        /**
+        * Returns the entry for the key, or NULL if the position isn't stored
+        */
+        const Entry *probe(unsigned long long key) const;
+
+        /**
+        * Stores a search result.  depth is the number of plies that were left to
+        * search below the position.  When the bucket is full the shallowest
+        * entry is replaced.
+        */
+        void store(
+            unsigned long long key,
+            CheckersNEATDatatype value,
+            int depth,
+            BoundType bound,
+            int bestMove
+        );
+
+    protected:
+        void allocate();
+
+        inline Entry *getBucket(unsigned long long key) const
+        {
+            return (Entry*)(buckets + (size_t(key>>32)&(bucketCount-1))*BUCKET_BYTES);
+        }
+
+        inline int getEntriesPerBucket() const
+        {
+            return int(BUCKET_BYTES/sizeof(Entry));
+        }
+    };
+
+    /**
+    * CakeSearchContext owns the hashtable and history of one cake player.
+    * A copy allocates a context of its own, so the clones of an experiment
+    * can all play cake at the same time.
+    */
+    class CakeSearchContext
+    {
+    protected:
+        CAKE_CONTEXT *context;
+
+    public:
+        CakeSearchContext()
+            :
+        context(allocate())
+        {}
+
+        CakeSearchContext(const CakeSearchContext &other)
+            :
+        context(allocate())
+        {}
+
+        ~CakeSearchContext()
+        {
+            cake_freecontext(context);
+        }
+
+        //Keeps its own context: the hashtable is cleared before every search anyway
+        const CakeSearchContext &operator=(const CakeSearchContext &other)
+        {
+            return *this;
+        }
+
+        inline CAKE_CONTEXT *get()
+        {
+            return context;
+        }
+
+    protected:
+        static CAKE_CONTEXT *allocate()
+        {
+            CAKE_CONTEXT *newContext = cake_newcontext();
+
+            if (!newContext)
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Could not allocate a cake search context!");
+            }
+
+            return newContext;
+        }
+    };
+
+    /**
+    * CakeSearchInfo is a SEARCHINFO that owns its repetition list.  A copy
+    * starts without one and allocates its own before it plays cake, so the
+    * clones of an experiment never free each other's list.
+    */
+    class CakeSearchInfo : public SEARCHINFO
+    {
+    public:
+        CakeSearchInfo()
+        {
+            repcheck = NULL;
+        }
+
+        CakeSearchInfo(const CakeSearchInfo &other)
+            :
+        SEARCHINFO(other)
+        {
+            repcheck = NULL;
+        }
+
+        ~CakeSearchInfo()
+        {
+            free(repcheck);
+        }
+
+        //Keeps its own repetition list
+        const CakeSearchInfo &operator=(const CakeSearchInfo &other)
+        {
+            REPETITION *ownRepcheck = repcheck;
+            SEARCHINFO::operator=(other);
+            repcheck = ownRepcheck;
+            return *this;
+        }
+    };
+
     class CheckersCommon
     {
 	protected:
@@ -121,6 +360,44 @@ namespace HCUBE
 
         void reverseMove(CheckersMove &move,uchar b[8][8]);
 
+        /**
+        * generateMoves: the bitboard version of generateMoveList.  Writes up to
+        * CHECKERS_MAX_BITBOARD_MOVES moves for color and returns how many there are.
+        */
+        int generateMoves(
+            const CheckersBitboard &position,
+            int color,
+            CheckersBitboardMove *moveList,
+            bool &foundJump
+        );
+
+        static void makeMove(const CheckersBitboardMove &move,CheckersBitboard &position,int color);
+
+        /**
+        * Returns the Zobrist key of a position (without the color to move)
+        */
+        static unsigned long long computeHash(const CheckersBitboard &position);
+
+        /**
+        * Returns what a move changes in the Zobrist key of the position it is made from
+        */
+        static unsigned long long getMoveHash(const CheckersBitboardMove &move,const CheckersBitboard &position,int color);
+
+        static unsigned long long getColorHash(int colorToMove);
+
+        /**
+        * Finds the move in generateMoveList that matches a bitboard move
+        */
+        CheckersMove findMove(uchar b[8][8],int color,const CheckersBitboardMove &move);
+
+        /**
+        * perft: counts the leaf positions of the move tree below a position.
+        * Used to check the bitboard generator against generateMoveList.
+        */
+        unsigned long long perft(const CheckersBitboard &position,int color,int depth);
+
+        unsigned long long perft(uchar b[8][8],int color,int depth);
+
         bool hasJump(
             uchar b[8][8],
             int color,
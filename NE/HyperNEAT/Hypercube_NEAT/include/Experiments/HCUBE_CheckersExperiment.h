@@ -37,14 +37,19 @@ namespace HCUBE
         CheckersNEATDatatype childBetaForSecondBestMove;
         CheckersMove secondBestMoveToMake;
 
+        //The moves chosen by searchmax/searchmin at the root of the search
+        CheckersBitboardMove bitboardMoveToMake;
+        CheckersBitboardMove secondBestBitboardMoveToMake;
+
         vector<CheckersMove> totalMoveList;
 
         uchar userEvaluationBoard[8][8];
         int userEvaluationRound;
 
-        BoardCacheList boardEvaluationCaches[2][65336];
+        CheckersTranspositionTable transpositionTable;
 
-        BoardStateList boardStateLists[3][3][65536];
+        //The evaluator the transposition table was filled with (see prepareTranspositionTable)
+        int transpositionTableEvaluator;
 
         Vector2<uchar> from;
 
@@ -52,7 +57,6 @@ namespace HCUBE
 
         int DEBUG_USE_HANDCODED_EVALUATION;
         int DEBUG_USE_HYPERNEAT_EVALUATION;
-        CheckersCachedBoard tmpboard;
 
 		bool dumpEvaluationImages;
 
@@ -62,7 +66,8 @@ namespace HCUBE
 		int numHyperNEATEvaluations;
 
 		int cakeRandomSeed;
-        SEARCHINFO searchInfo;
+        CakeSearchInfo searchInfo;
+        CakeSearchContext cakeContext;
 
         int currentRound;
 
@@ -91,6 +96,13 @@ namespace HCUBE
 
         virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(uchar b[8][8]);
 
+        /**
+        * Drops the transposition table if it was filled using a different evaluator
+        */
+        void prepareTranspositionTable();
+
+        void clearTranspositionTable();
+
         virtual pair<CheckersNEATDatatype,int> evaluatemax(
             uchar b[8][8],
             CheckersNEATDatatype parentBeta,
@@ -105,6 +117,27 @@ namespace HCUBE
             int maxDepth
         );
 
+        /**
+        * searchmax/searchmin do the actual search on bitboards.  positionHash
+        * is the Zobrist key of the position without the color to move.  Only
+        * the leaves are converted back to a board for the evaluators.
+        */
+        pair<CheckersNEATDatatype,int> searchmax(
+            const CheckersBitboard &position,
+            unsigned long long positionHash,
+            CheckersNEATDatatype parentBeta,
+            int depth,
+            int maxDepth
+        );
+
+        pair<CheckersNEATDatatype,int> searchmin(
+            const CheckersBitboard &position,
+            unsigned long long positionHash,
+            CheckersNEATDatatype parentAlpha,
+            int depth,
+            int maxDepth
+        );
+
         virtual pair<CheckersNEATDatatype,int> firstevaluatemax(
             uchar b[8][8],
             int maxDepth,
@@ -22,6 +22,14 @@ namespace HCUBE
         NEAT::FastNetwork<CheckersNEATDatatype> networks[2];
 #endif
 
+        //Node indices into networks[], resolved in populateSubstrate so
+        //evaluateLeafHyperNEAT does not build and look up node names.
+        //inputNodeIndex is [substrate][windowSize-3][x][y] for the
+        //"Input_NxN_x_y" nodes; biasNodeIndex is -1 when there is no bias.
+        int biasNodeIndex[2];
+        int inputNodeIndex[2][6][6][6];
+        int outputNodeIndex[2];
+
     public:
         CheckersExperimentFogel(string _experimentName,int _threadID);
 
@@ -20,6 +20,13 @@ namespace HCUBE
         NEAT::FastNetwork<CheckersNEATDatatype> networks[2];
 #endif
 
+        //Node indices into networks[], resolved in populateSubstrate so
+        //evaluateLeafHyperNEAT does not look nodes up by name.
+        //biasNodeIndex is -1 when the network has no bias node.
+        int biasNodeIndex[2];
+        int boardNodeIndex[2][8][8];
+        int outputNodeIndex[2];
+
     public:
         CheckersExperimentNoGeom(string _experimentName,int _threadID);
 
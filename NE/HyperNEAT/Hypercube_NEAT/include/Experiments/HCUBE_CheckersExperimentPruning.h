@@ -54,6 +54,7 @@ namespace HCUBE
 
 		int cakeRandomSeed;
         SEARCHINFO searchInfo;
+        CakeSearchContext cakeContext;
 
         int currentRound;
 
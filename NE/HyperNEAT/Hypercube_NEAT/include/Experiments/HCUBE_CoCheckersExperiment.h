@@ -39,6 +39,8 @@ namespace HCUBE
 
         virtual Experiment* clone();
 
+        virtual NEAT::CoEvoExperiment* cloneCoEvoExperiment();
+
         virtual int getGroupCapacity()
         {
             return 1;
@@ -53,6 +53,17 @@ namespace HCUBE
             return 1;
         }
 
+        /**
+        * isFitnessCacheable: true if an individual's fitness depends only on its
+        * genome, so a cached fitness can stand in for an evaluation.  Group
+        * evaluations depend on the other group members and are never cached.
+        * Caching is turned on with the FitnessCacheSize parameter.
+        */
+        virtual bool isFitnessCacheable()
+        {
+            return getGroupCapacity()==1;
+        }
+
         inline int getGroupSize()
         {
             return int(group.size());
@@ -28,6 +28,15 @@ namespace HCUBE
 
         int sizeMultiplier;
 
+        //Substrate node indices of the two layers, indexed by y*numNodesX+x
+        vector<int> inputNodeIndices,outputNodeIndices;
+
+        //(small, big) placements waiting for processQueuedEvaluations
+        vector<Vector2<int> > queuedSmallPositions,queuedBigPositions;
+
+        //Node-major substrate values of the queued placements (see FastNetwork::updateBatch)
+        vector<double> batchValues;
+
     public:
         FindClusterExperiment(string _experimentName,int _threadID);
 
@@ -49,6 +58,26 @@ namespace HCUBE
             int y1Big
         );
 
+        /**
+         * queueEvaluation: Queues a (small, big) placement.  When the queue is
+         * full the queued placements are evaluated and their total score is
+         * returned, otherwise this returns 0.
+         */
+        double queueEvaluation(
+            shared_ptr<NEAT::GeneticIndividual> individual,
+            int x1,
+            int y1,
+            int x1Big,
+            int y1Big
+        );
+
+        /**
+         * processQueuedEvaluations: Evaluates every queued placement with one
+         * batched substrate update and returns their total score.  Each one
+         * scores exactly what processEvaluation() would give it.
+         */
+        double processQueuedEvaluations(shared_ptr<NEAT::GeneticIndividual> individual);
+
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
 
         virtual void processIndividualPostHoc(shared_ptr<NEAT::GeneticIndividual> individual);
@@ -76,6 +105,11 @@ namespace HCUBE
         void decreaseResolution();
 
         virtual Experiment* clone();
+
+    protected:
+        void getObjectSizes(int &smallRadius,int &bigRadius,double &filledValue);
+
+        void setQueuedObject(const Vector2<int> &position,int radius,double filledValue,int pattern,int batchSize);
     };
 
     class FindClusterStats
@@ -31,6 +31,8 @@ namespace HCUBE
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
 
         virtual Experiment* clone();
+
+        virtual NEAT::CoEvoExperiment* cloneCoEvoExperiment();
     };
 
 }
@@ -81,6 +81,89 @@ namespace HCUBE
         ~OthelloMove();
     };
 
+    /**
+    * OthelloBitboard is a position stored as one mask per color.  Square s
+    * is at x=s/8, y=s%8, so walking the set bits of a mask from the lowest
+    * visits squares in the same order generateMoveList does.
+    */
+    class OthelloBitboard
+    {
+    public:
+        unsigned long long black;
+        unsigned long long white;
+
+        OthelloBitboard()
+            :
+            black(0),
+            white(0)
+        {}
+
+        OthelloBitboard(ushort b[8][8]);
+
+        /**
+        * Writes the position to a board, including the piece counts
+        */
+        void toBoard(ushort b[8][8]) const;
+
+        inline unsigned long long getPieces(int color) const
+        {
+            return (color==OTHELLO_BLACK) ? black : white;
+        }
+
+        inline unsigned long long getEmpty() const
+        {
+            return ~(black|white);
+        }
+
+        inline bool operator==(const OthelloBitboard &other) const
+        {
+            return black==other.black && white==other.white;
+        }
+
+        static inline int getSquare(int x,int y)
+        {
+            return x*8 + y;
+        }
+
+        static inline int getX(int square)
+        {
+            return square/8;
+        }
+
+        static inline int getY(int square)
+        {
+            return square%8;
+        }
+
+        static inline int getSquareCount(unsigned long long squares)
+        {
+#ifdef __GNUC__
+            return __builtin_popcountll(squares);
+#else
+            int count=0;
+            for (;squares;squares&=(squares-1))
+            {
+                count++;
+            }
+            return count;
+#endif
+        }
+
+        static inline int getFirstSquare(unsigned long long squares)
+        {
+#ifdef __GNUC__
+            return __builtin_ctzll(squares);
+#else
+            int square=0;
+            while (!(squares&(1ULL<<square)))
+            {
+                square++;
+            }
+            return square;
+#endif
+        }
+    };
+
 #if OTHELLO_USE_BOOST_POOL
     struct OthelloMovePoolTag
         { };
@@ -119,6 +202,21 @@ namespace HCUBE
         );
 
         int getWinner(ushort b[8][8]);
+
+        /**
+        * getMobility: the bitboard version of generateMoveList.  Returns the
+        * squares color can move to.
+        */
+        static unsigned long long getMobility(const OthelloBitboard &position,int color);
+
+        /**
+        * Returns the pieces that color flips by moving to square
+        */
+        static unsigned long long getFlips(const OthelloBitboard &position,int color,int square);
+
+        static void makeMove(int square,OthelloBitboard &position,int color);
+
+        static int getWinner(const OthelloBitboard &position);
     };
 
 }
@@ -6,6 +6,9 @@
 
 #define MAX_CACHED_BOARDS (8192)
 
+//Must be a power of two
+#define OTHELLO_EVALUATION_CACHE_SIZE (16384)
+
 #define OTHELLO_EXPERIMENT_ENABLE_BIASES (1)
 
 #define OTHELLO_EXPERIMENT_LOG_EVALUATIONS (1)
@@ -20,83 +23,76 @@ typedef float OthelloNEATDatatype;
 
 namespace HCUBE
 {
-    class OthelloBoardState
+    /**
+    * OthelloEvaluationCache is a direct-mapped table of leaf evaluations
+    * indexed by a hash of the position and the substrate that evaluated it.
+    * Entries keep both, so a collision only replaces an entry, and the two
+    * players of a game don't evict each other's evaluations of a position.
+    */
+    class OthelloEvaluationCache
     {
     public:
-        ushort board[8][8];
-        uchar playerToMove;
-        int depth;
+        class Entry
+        {
+        public:
+            OthelloBitboard position;
+            OthelloNEATDatatype value;
+            int substrateIndex;
+        };
 
-        OthelloBoardState()
-        {}
+    protected:
+        vector<Entry> entries;
 
-        OthelloBoardState(ushort _board[8][8],uchar _playerToMove,int _depth)
+    public:
+        OthelloEvaluationCache()
                 :
-                playerToMove(_playerToMove),
-                depth(_depth)
+                entries(OTHELLO_EVALUATION_CACHE_SIZE)
         {
-            memcpy(board,_board,sizeof(ushort)*8*8);
+            clear();
         }
 
-        bool operator <(const OthelloBoardState &bs2) const
+        void clear()
         {
-            if (playerToMove<bs2.playerToMove)
-            {
-                return true;
-            }
-            else if (playerToMove==bs2.playerToMove)
+            for (int a=0;a<(int)entries.size();a++)
             {
-                if (depth < bs2.depth)
-                {
-                    return true;
-                }
-                else if (depth == bs2.depth)
-                {
-                    return (memcmp(board,bs2.board,8*8*sizeof(ushort))==-1);
-                }
+                entries[a].substrateIndex = -1;
             }
-
-            return false;
         }
 
-        bool operator ==(const OthelloBoardState &bs2) const
+        inline Entry &getEntry(const OthelloBitboard &position,int substrateIndex)
         {
-            return memcmp(this,&bs2,sizeof(OthelloBoardState))==0;
+            unsigned long long hash =
+                position.black*0x9E3779B97F4A7C15ULL ^
+                position.white*0xC2B2AE3D27D4EB4FULL ^
+                (unsigned long long)substrateIndex*0x94D049BB133111EBULL;
+            return entries[int((hash^(hash>>32))&(OTHELLO_EVALUATION_CACHE_SIZE-1))];
         }
-    };
 
-    class OthelloCachedBoard
-    {
-    public:
-        ushort b[8][8];
-
-        OthelloCachedBoard()
-        {}
-
-        OthelloCachedBoard(ushort _b[8][8])
+        /**
+        * Returns the cached evaluation of a position, or NULL
+        */
+        inline const OthelloNEATDatatype *probe(const OthelloBitboard &position,int substrateIndex)
         {
-            memcpy(b,_b,sizeof(ushort)*8*8);
-        }
+            const Entry &entry = getEntry(position,substrateIndex);
 
-        void loadBoard(ushort _b[8][8])
-        {
-            memcpy(b,_b,sizeof(ushort)*8*8);
-        }
+            if (entry.substrateIndex==substrateIndex && entry.position==position)
+            {
+                return &entry.value;
+            }
 
-        bool operator <(const OthelloCachedBoard &bs2) const
-        {
-            return (memcmp(b,bs2.b,8*8*sizeof(ushort))==-1);
+            return NULL;
         }
 
-        bool operator ==(const OthelloCachedBoard &bs2) const
+        inline void store(const OthelloBitboard &position,int substrateIndex,OthelloNEATDatatype value)
         {
-            return (memcmp(b,bs2.b,8*8*sizeof(ushort))==0);
+            Entry &entry = getEntry(position,substrateIndex);
+
+            entry.position = position;
+            entry.substrateIndex = substrateIndex;
+            entry.value = value;
         }
     };
 
-    typedef map<OthelloCachedBoard,OthelloNEATDatatype> OthelloBoardCacheMap;
-    typedef map<OthelloBoardState,OthelloNEATDatatype> OthelloBoardStateMap;
-
     class OthelloExperiment : public Experiment, public OthelloCommon
     {
     public:
@@ -122,16 +118,13 @@ namespace HCUBE
         ushort userEvaluationBoard[8][8];
         int userEvaluationRound;
 
-        OthelloBoardCacheMap boardEvaluationCache;
-
-        OthelloBoardStateMap boardStateCache;
+        OthelloEvaluationCache boardEvaluationCache;
 
         int handCodedType;
         int handCodedDepth;
 
         int DEBUG_USE_HANDCODED_EVALUATION;
         int DEBUG_USE_HYPERNEAT_EVALUATION;
-        OthelloCachedBoard tmpboard;
 
         int randomMoveChance;
 
@@ -173,6 +166,19 @@ namespace HCUBE
 
         OthelloNEATDatatype evaluatemin(ushort b[8][8],  OthelloNEATDatatype parentAlpha, int depth,int maxDepth);
 
+        /**
+        * searchmax/searchmin do the actual search on bitboards.  Only the
+        * leaves are converted back to a board for the evaluators.
+        */
+        OthelloNEATDatatype searchmax(const OthelloBitboard &position,  OthelloNEATDatatype parentBeta, int depth,int maxDepth);
+
+        OthelloNEATDatatype searchmin(const OthelloBitboard &position,  OthelloNEATDatatype parentAlpha, int depth,int maxDepth);
+
+        /**
+        * Sets moveToMake to a move to square
+        */
+        void setMoveToMake(int square,int color);
+
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
 
         virtual void processIndividualPostHoc(shared_ptr<NEAT::GeneticIndividual> individual);
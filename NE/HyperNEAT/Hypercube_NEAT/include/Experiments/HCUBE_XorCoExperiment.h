@@ -89,6 +89,8 @@ namespace HCUBE
 
         virtual Experiment* clone();
 
+        virtual NEAT::CoEvoExperiment* cloneCoEvoExperiment();
+
         virtual void resetGenerationData(shared_ptr<NEAT::GeneticGeneration> generation)
         {}
 
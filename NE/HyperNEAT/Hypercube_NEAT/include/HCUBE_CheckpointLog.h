@@ -0,0 +1,78 @@
+#ifndef HCUBE_CHECKPOINTLOG_H_INCLUDED
+#define HCUBE_CHECKPOINTLOG_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+namespace HCUBE
+{
+    /**
+    * CheckpointLog is an append-only file of population checkpoint records.
+    * Every record starts with a small header (magic, generation, payload size
+    * and a CRC-32 of the payload), so the index of a log is built by hopping
+    * from header to header without reading any payload.  A record that was
+    * only partly written is ignored and overwritten by the next append.
+    */
+    class CheckpointLog
+    {
+    public:
+        struct Record
+        {
+            int generation;
+            long long payloadOffset;
+            unsigned int payloadSize;
+            unsigned int checksum;
+        };
+
+    protected:
+        string fileName;
+
+        vector<Record> records;
+
+        //The end of the last complete record
+        long long validEnd;
+
+    public:
+        CheckpointLog(string _fileName);
+
+        /**
+        * Returns true if the file exists and starts with a checkpoint record
+        */
+        static bool isCheckpointLog(string fileName);
+
+        static unsigned int computeChecksum(const string &payload);
+
+        inline int getRecordCount()
+        {
+            return int(records.size());
+        }
+
+        inline const Record &getRecord(int index)
+        {
+            return records[index];
+        }
+
+        /**
+        * Returns the index of the newest record for a generation, or of the
+        * newest record when generation is -1
+        */
+        int findRecord(int generation);
+
+        void append(int generation,const string &payload);
+
+        /**
+        * Reads the payload of a record and throws if it doesn't match its checksum
+        */
+        string readPayload(int index);
+
+        /**
+        * Checks the record against its checksum (and the checksum the caller
+        * computed when writing it) without decoding the payload
+        */
+        bool verifyRecord(int index,unsigned int expectedChecksum);
+
+    protected:
+        void readIndex();
+    };
+}
+
+#endif // HCUBE_CHECKPOINTLOG_H_INCLUDED
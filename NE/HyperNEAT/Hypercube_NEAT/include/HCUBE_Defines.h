@@ -107,6 +107,8 @@ namespace HCUBE
     /** class Prototypes **/
     class Experiment;
     class ExperimentRun;
+    class EvaluationPool;
+    class FitnessCache;
 
     class MainFrame;
     class ExperimentPanel;
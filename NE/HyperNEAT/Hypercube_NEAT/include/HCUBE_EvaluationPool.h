@@ -0,0 +1,112 @@
+#ifndef HCUBE_EVALUATIONPOOL_H_INCLUDED
+#define HCUBE_EVALUATIONPOOL_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_Experiment.h"
+
+namespace HCUBE
+{
+    /**
+    * EvaluationPool keeps a set of evaluation threads alive between generations.
+    * Each thread owns one of the experiment clones and a queue of evaluation groups
+    * (one individual, or getGroupCapacity() individuals for group experiments).
+    * A thread whose queue runs dry steals groups from the back of the other queues,
+    * so a few long evaluations no longer leave the remaining threads idle.
+    */
+    class EvaluationPool
+    {
+    public:
+    protected:
+        /**
+        * Worker holds the task queue and timing statistics of one thread
+        */
+        struct Worker
+        {
+            deque<int> tasks;
+            mutex taskMutex;
+
+            int tasksRun;
+            int tasksStolen;
+            double batchBusySeconds;
+            double totalBusySeconds;
+            double totalIdleSeconds;
+
+            Worker()
+                :
+                tasksRun(0),
+                tasksStolen(0),
+                batchBusySeconds(0),
+                totalBusySeconds(0),
+                totalIdleSeconds(0)
+            {}
+        };
+
+        vector<shared_ptr<Worker> > workers;
+        vector<shared_ptr<boost::thread> > threads;
+
+        mutex poolMutex;
+        condition workAvailable;
+        condition workFinished;
+        int batchNumber;
+        int tasksRemaining;
+        bool stopping;
+
+        //The current batch, only written while all threads are waiting
+        vector<shared_ptr<Experiment> > batchExperiments;
+        shared_ptr<NEAT::GeneticGeneration> batchGeneration;
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator batchIterator;
+        int batchIndividualCount;
+        int batchGroupCapacity;
+
+    public:
+        EvaluationPool(int numThreads);
+
+        virtual ~EvaluationPool();
+
+        inline int getThreadCount()
+        {
+            return int(workers.size());
+        }
+
+        /**
+        * Evaluates individualCount individuals starting at individualIterator and
+        * blocks until all of them have a fitness.  Thread i uses experiments[i].
+        */
+        void evaluate(
+            const vector<shared_ptr<Experiment> > &experiments,
+            shared_ptr<NEAT::GeneticGeneration> generation,
+            vector<shared_ptr<NEAT::GeneticIndividual> >::iterator individualIterator,
+            int individualCount
+        );
+
+        /**
+        * Prints the busy and idle time of each thread for the last batch
+        * and in total
+        */
+        void printThreadTimes(double batchSeconds);
+
+    protected:
+        void runWorker(int workerIndex);
+
+        bool takeTask(int workerIndex,int &task);
+
+        void runTask(int workerIndex,int task);
+
+        /**
+        * This class cannot be copied
+        */
+        EvaluationPool(const EvaluationPool &other)
+        {}
+
+        /**
+        * This class cannot be copied
+        */
+        const EvaluationPool &operator=(const EvaluationPool &other)
+        {
+            return *this;
+        }
+    };
+}
+
+#endif // HCUBE_EVALUATIONPOOL_H_INCLUDED
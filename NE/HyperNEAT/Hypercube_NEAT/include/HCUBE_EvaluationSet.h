@@ -19,6 +19,7 @@ namespace HCUBE
         shared_ptr<NEAT::GeneticGeneration> generation;
         vector<shared_ptr<NEAT::GeneticIndividual> >::iterator individualIterator;
         int individualCount;
+        int firstIndividualIndex;
         bool finished;
 
     public:
@@ -26,7 +27,8 @@ namespace HCUBE
             shared_ptr<Experiment> _experiment,
             shared_ptr<NEAT::GeneticGeneration> _generation,
             vector<shared_ptr<NEAT::GeneticIndividual> >::iterator _individualIterator,
-            int _individualCount
+            int _individualCount,
+            int _firstIndividualIndex=0
         )
                 :
                 running(false),
@@ -34,6 +36,7 @@ namespace HCUBE
                 generation(_generation),
                 individualIterator(_individualIterator),
                 individualCount(_individualCount),
+                firstIndividualIndex(_firstIndividualIndex),
                 finished(false)
         {}
 
@@ -42,7 +45,9 @@ namespace HCUBE
 
         /**
         * Group the individuals based on the experiment (some experiments support more than one individual per
-        * evaluation) and then sequentially evaluate each group.
+        * evaluation) and then sequentially evaluate each group.  Each group draws random numbers from a
+        * stream derived from the generation number and the index of its first individual, so fitness does
+        * not depend on which thread evaluates the group.
         */
         virtual void run();
 
@@ -3,6 +3,10 @@
 
 #include "HCUBE_Defines.h"
 
+//The number of records the backup checkpoint log may hold before it is
+//compacted into a single record
+#define CHECKPOINT_BACKUP_MAX_RECORDS (10)
+
 namespace HCUBE
 {
     /**
@@ -24,12 +28,21 @@ namespace HCUBE
 
         vector<shared_ptr<Experiment> > experiments;
 
+        shared_ptr<EvaluationPool> evaluationPool;
+
+        shared_ptr<FitnessCache> fitnessCache;
+
         mutex* populationMutex;
 
         MainFrame *frame;
 
         string outputFileName;
 
+        //The last generation in each checkpoint log the population was loaded
+        //from or appended to
+        map<string,int> checkpointLogGenerations;
+        unsigned int lastCheckpointChecksum;
+
     public:
         ExperimentRun();
 
@@ -138,8 +151,9 @@ namespace HCUBE
         * to create the initial population for the run.
         */
         void createPopulationFromCondorRun(string populationFile, string fitnessFunctionPrefix,
-                                           string evaluationFile, string rom_file);
-        void createPopulation(string populationString="");
+                                           string evaluationFile, string rom_file,
+                                           int checkpointGeneration=-1);
+        void createPopulation(string populationString="",int generation=-1);
         void convertPopulation(string rom_file);
 
         /**
@@ -155,6 +169,26 @@ namespace HCUBE
         virtual float evaluateIndividual(unsigned int individualId);
         virtual void evaluatePopulation();
 
+        /**
+        * Moves the individuals whose genome is already in the fitness cache (or
+        * repeats an earlier genome of this generation) to the end of the
+        * generation and returns how many remain to be evaluated
+        */
+        int skipCachedIndividuals(
+            vector<unsigned long long> &genomeHashes,
+            vector<shared_ptr<NEAT::GeneticIndividual> > &twins
+        );
+
+        /**
+        * Caches the fitness of the evaluated individuals and hands it to the
+        * skipped ones
+        */
+        void finishCachedIndividuals(
+            int evaluationCount,
+            const vector<unsigned long long> &genomeHashes,
+            const vector<shared_ptr<NEAT::GeneticIndividual> > &twins
+        );
+
         /**
         * This function performs speciation and sorts the invidiuals by fitness
         */
@@ -175,6 +209,37 @@ namespace HCUBE
         void loadPopulationBoost(string filename);
         void savePopulationBoost(string filename);
 
+        /**
+        * Saves to a checkpoint log when the file name ends in .ckpt, otherwise
+        * writes the whole population with savePopulationBoost
+        */
+        void savePopulation(string filename);
+
+        /**
+        * Appends the generations that changed since the last record to a checkpoint
+        * log.  The first record a run writes to a log contains every generation.
+        */
+        void appendCheckpoint(string filename);
+
+        /**
+        * Replaces a checkpoint log with a new log that holds every generation
+        * in one record.  The old log is only replaced once the new record has
+        * been verified.
+        */
+        void compactCheckpoint(string filename);
+
+        /**
+        * Throws unless the newest record of the log is the current generation and
+        * matches the checksum of the last appendCheckpoint
+        */
+        void verifyCheckpoint(string filename);
+
+        /**
+        * Loads the population as it was when the given generation (or the newest
+        * one, for -1) was checkpointed
+        */
+        void loadCheckpoint(string filename,int generation=-1);
+
     protected:
         /**
         * This class cannot be copied
@@ -0,0 +1,65 @@
+#ifndef HCUBE_FITNESSCACHE_H_INCLUDED
+#define HCUBE_FITNESSCACHE_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+namespace HCUBE
+{
+    /**
+    * FitnessCache remembers the fitness (and user data) of recently evaluated
+    * genomes by GeneticIndividual::getGenomeHash().  It holds at most
+    * capacity genomes and forgets the least recently used one first.
+    */
+    class FitnessCache
+    {
+    public:
+        struct Entry
+        {
+            double fitness;
+            string userData;
+        };
+
+    protected:
+        int capacity;
+
+        //Most recently used first
+        list<unsigned long long> recentHashes;
+
+        map<unsigned long long,pair<Entry,list<unsigned long long>::iterator> > entries;
+
+        int lookups;
+        int hits;
+
+    public:
+        FitnessCache(int _capacity);
+
+        inline int getCapacity()
+        {
+            return capacity;
+        }
+
+        inline int getSize()
+        {
+            return int(entries.size());
+        }
+
+        /**
+        * Returns true and fills in entry if the genome is cached
+        */
+        bool lookup(unsigned long long genomeHash,Entry &entry);
+
+        void insert(unsigned long long genomeHash,const Entry &entry);
+
+        inline int getLookups()
+        {
+            return lookups;
+        }
+
+        inline int getHits()
+        {
+            return hits;
+        }
+    };
+}
+
+#endif // HCUBE_FITNESSCACHE_H_INCLUDED
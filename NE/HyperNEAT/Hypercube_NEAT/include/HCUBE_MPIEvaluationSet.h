@@ -1,51 +1,96 @@
 #ifndef HCUBE_MPIEVALUATIONSET_H_INCLUDED
 #define HCUBE_MPIEVALUATIONSET_H_INCLUDED
 
+#include "mpi.h"
+
 #include "HCUBE_Defines.h"
 
 #include "HCUBE_EvaluationSet.h"
 
 #include "Experiments/HCUBE_Experiment.h"
 
-#define INDIVIDUAL_GENOMES_TAG 1000
-//#define NEW_FITNESSES_TAG 1001
 #define DIE_TAG 1002
-#define NEW_INDIVIDUALS_TAG 1003
+#define GENERATION_TAG 1004
+#define TASK_TAG 1005
+#define RESULT_TAG 1006
+
+//The number of tasks each worker holds at once
+#define MPI_TASKS_PER_WORKER (2)
 
 namespace HCUBE
 {
+    /**
+    * MPIEvaluationSet evaluates a generation over every MPI process.
+    *
+    * Individuals travel in the binary genome format.  Each worker first gets
+    * the generation number, the random seed and the tests (for coevolution),
+    * then tasks of one group of individuals each.  A worker sends back only
+    * the fitness and user data of the group.  Tasks are handed out on demand: every worker
+    * holds MPI_TASKS_PER_WORKER tasks, and it gets the next one as soon as it
+    * returns a result, so it never waits for work between groups.  The master
+    * only hands out tasks and collects results; it evaluates groups itself
+    * only when there are no workers.
+    *
+    * Each group uses the same random stream as it does in EvaluationSet, and
+    * the workers take the master's seed, so the fitness doesn't depend on
+    * which process evaluates it.
+    */
     class MPIEvaluationSet : public EvaluationSet
     {
     public:
     protected:
-        int targetProcessor;
+        int processCount;
+
+        int groupCapacity;
+
+        int taskCount;
+
+        int nextTask;
+
+        //The task in each send slot of each worker, or -1 if the slot is free
+        vector<int> slotTasks;
+
+        vector<vector<char> > slotBuffers;
+
+        vector<MPI_Request> slotRequests;
+
+        vector<char> generationBuffer;
+
+        vector<char> receiveBuffer;
 
     public:
         MPIEvaluationSet(
             shared_ptr<Experiment> _experiment,
             shared_ptr<NEAT::GeneticGeneration> _generation,
             vector<shared_ptr<NEAT::GeneticIndividual> >::iterator _individualIterator,
-            int _individualCount,
-            int _targetProcessor
-        )
-                :
-                EvaluationSet(
-                    _experiment,
-                    _generation,
-                    _individualIterator,
-                    _individualCount
-                ),
-                targetProcessor(_targetProcessor)
-        {}
+            int _individualCount
+        );
 
         virtual ~MPIEvaluationSet()
         {}
 
         virtual void run();
 
-        void collectData();
+        /**
+        * runWorker: the loop of every process except the master.  Evaluates
+        * the tasks it receives until the master sends DIE_TAG.
+        */
+        static void runWorker(shared_ptr<Experiment> experiment);
+
+    protected:
+        int getOutstandingTaskCount();
+
+        void sendGeneration();
+
+        void sendTask(int worker,int slot);
+
+        void receiveResult(const MPI_Status &probeStatus);
 
-	protected:
+        /**
+        * evaluateTask: evaluates a task on the master, which is only done when
+        * there are no workers
+        */
+        void evaluateTask(int task);
     };
 }
 
@@ -16,6 +16,7 @@
 #include <map>
 #include <stack>
 #include <queue>
+#include <deque>
 #include <iomanip>
 
 using namespace std;
@@ -10,7 +10,7 @@ namespace HCUBE
 {
     AtariExperiment::AtariExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), substrate_width(8), substrate_height(10), visProc(NULL),
-        rom_file(""), numActions(0), numObjClasses(0), display_active(false), outputLayerIndx(-1)
+        rom_file(""), numActions(0), numObjClasses(0), display_active(false), outputLayerIndx(-1), frameSkip(1)
     {
     }
 
@@ -36,6 +36,8 @@ namespace HCUBE
         }
         numActions = ale.legal_actions.size();
 
+        frameSkip = NEAT::Globals::getSingleton()->getFrameSkip();
+
         if (processScreen) {
             // Load the visual processing framework
             visProc = ale.visProc;
@@ -137,18 +139,16 @@ namespace HCUBE
     {
         shared_ptr<NEAT::GeneticIndividual> individual = group.front();
         individual->setFitness(0);
-        clock_t start = clock();
         substrate.populateSubstrate(individual);
-        clock_t end = clock();
-        cout << "Populated Substrate Size (" << substrate_width << "x" << substrate_height <<") in "
-             << float(end-start)/CLOCKS_PER_SEC << " seconds." << endl;
         float score = runAtariEpisode(&substrate);
         individual->reward(score);
     }
 
     float AtariExperiment::runAtariEpisode(NEAT::LayeredSubstrate<float>* substrate) {
         ale.reset_game();
-        
+        unsigned long startMicroseconds = NEAT::Profiler::getMicroseconds();
+        int decisions = 0;
+
         while (!ale.game_over()) {
             // Set value of all nodes to zero
             substrate->getNetwork()->reinitialize(); 
@@ -164,9 +164,18 @@ namespace HCUBE
 
             // Choose which action to take
             Action action = selectAction(substrate, outputLayerIndx);
-            ale.act(action);
+            decisions++;
+            {
+                NEAT_PROFILE_SCOPE("environmentStep");
+                // Hold the action without looking at the screen in between
+                for (int frame=0; frame<frameSkip && !ale.game_over(); frame++) {
+                    ale.act(action);
+                }
+            }
         }
-        cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        double seconds = (NEAT::Profiler::getMicroseconds()-startMicroseconds)/1000000.0;
+        cout << "Game ended in " << ale.frame << " frames (" << decisions << " decisions, "
+             << seconds << " seconds) with score " << ale.game_score << endl;
  
         return ale.game_score;
     }
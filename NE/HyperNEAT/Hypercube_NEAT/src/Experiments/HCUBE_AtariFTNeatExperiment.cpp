@@ -11,7 +11,7 @@ namespace HCUBE
 {
     AtariFTNeatExperiment::AtariFTNeatExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), visProc(NULL), rom_file(""),
-        numActions(0), numObjClasses(0), display_active(false)
+        numActions(0), numObjClasses(0), display_active(false), frameSkip(1), numInputGenes(0)
     {
     }
 
@@ -35,6 +35,8 @@ namespace HCUBE
         }
         numActions = ale.legal_actions.size();
 
+        frameSkip = NEAT::Globals::getSingleton()->getFrameSkip();
+
         // Load the visual processing framework
         visProc = ale.visProc;
         numObjClasses = visProc->manual_obj_classes.size();
@@ -43,6 +45,10 @@ namespace HCUBE
             exit(-1);
         }
 
+        geneNames.clear();
+        geneSubstrateNodes.clear();
+        geneLinks.clear();
+
         // One input layer for each object class, plus an extra one for the self object
         for (int i=0; i<=numObjClasses; ++i) {
             for (int y=0; y<substrate_height; y++) {
@@ -50,22 +56,42 @@ namespace HCUBE
                     int xmod = substrate_width*i+x; 
                     Node node(xmod, y, 0);
                     nameLookup[node] = (toString(xmod) + string("/") + toString(y) + string("/") + toString("0"));
+                    geneNames.push_back(nameLookup[node]);
+                    geneSubstrateNodes.push_back(Node(x, y, i));
                 }
             }
         }
+        numInputGenes = int(geneNames.size());
 
         // Processing Layer
         for (int y=0; y<substrate_height; y++) {
             for (int x=0; x<substrate_width; x++) {
                 Node node(x, y, 1);
                 nameLookup[node] = (toString(x) + string("/") + toString(y) + string("/") + toString("1"));
+                geneNames.push_back(nameLookup[node]);
+                geneSubstrateNodes.push_back(Node(x, y, numObjClasses+1));
             }
         }
+        int numHiddenGenes = int(geneNames.size()) - numInputGenes;
         
         // Output Layer - One node for each action
         for (int i=0; i<numActions; i++) {
             Node node(i,0,2);
             nameLookup[node] = (toString(i) + string("/") + toString("0") + string("/") + toString("2"));
+            geneNames.push_back(nameLookup[node]);
+            geneSubstrateNodes.push_back(Node(i, 0, numObjClasses+2));
+        }
+
+        // Input --> Processing, then Processing --> Output
+        for (int from=0; from<numInputGenes; from++) {
+            for (int to=numInputGenes; to<numInputGenes+numHiddenGenes; to++) {
+                geneLinks.push_back(pair<int,int>(from, to));
+            }
+        }
+        for (int from=numInputGenes; from<numInputGenes+numHiddenGenes; from++) {
+            for (int to=numInputGenes+numHiddenGenes; to<int(geneNames.size()); to++) {
+                geneLinks.push_back(pair<int,int>(from, to));
+            }
         }
     }
 
@@ -75,68 +101,24 @@ namespace HCUBE
         vector<GeneticLinkGene> links;
 
         clock_t start = clock();
-        vector<int> inputNodeIndexes;
-        vector<int> hiddenNodeIndexes;
-        vector<int> outputNodeIndexes;
-        int nodeCounter = 0;
-        // One input layer for each object class and an extra for the self object
-        for (int i=0; i<=numObjClasses; ++i) {
-            for (int y=0; y<substrate_height; y++) {
-                for (int x=0; x<substrate_width; x++) {
-                    int xmod = substrate_width*i+x; 
-                    Node node(xmod, y, 0);
-                    genes.push_back(GeneticNodeGene(nameLookup[node],"NetworkSensor",0,false));
-                    inputNodeIndexes.push_back(nodeCounter);
-                    nodeCounter++;
-                }
-            }
-        }
-
-        // Processing Layer
-        for (int y=0; y<substrate_height; y++) {
-            for (int x=0; x<substrate_width; x++) {
-                Node node(x, y, 1);
-                genes.push_back(GeneticNodeGene(nameLookup[node],"NetworkOutputNode",1,false,
-                                            ACTIVATION_FUNCTION_SIGMOID));
-                hiddenNodeIndexes.push_back(nodeCounter);
-                nodeCounter++;
+        // Input layers (one for each object class and an extra for the self
+        // object), then the processing layer, then the output layer
+        for (int a=0; a<int(geneNames.size()); a++) {
+            if (a<numInputGenes) {
+                genes.push_back(GeneticNodeGene(geneNames[a],"NetworkSensor",0,false));
+            } else {
+                genes.push_back(GeneticNodeGene(geneNames[a],"NetworkOutputNode",1,false,
+                                                ACTIVATION_FUNCTION_SIGMOID));
             }
         }
 
-        // Output Layer
-        for (int i=0; i<numActions; i++) {
-            Node node(i, 0, 2);
-            genes.push_back(GeneticNodeGene(nameLookup[node],"NetworkOutputNode",1,false,
-                                            ACTIVATION_FUNCTION_SIGMOID));
-            outputNodeIndexes.push_back(nodeCounter);
-            nodeCounter++;
-        }
-
-        // Bias node
-        // genes.push_back(GeneticNodeGene("Bias","NetworkSensor",0,false));
-        // inputNodeIndexes.push_back(nodeCounter);
-        // nodeCounter++;
-
         clock_t end = clock();
-        cout << "Created " << nodeCounter << " nodes in " << float(end-start)/CLOCKS_PER_SEC << " seconds." << endl;
+        cout << "Created " << genes.size() << " nodes in " << float(end-start)/CLOCKS_PER_SEC << " seconds." << endl;
 
         start = clock();
-        // [Links] Input --> Processing 
-        for (int z=0; z<inputNodeIndexes.size(); z++) {
-            for (int q=0; q<hiddenNodeIndexes.size(); q++) {
-                int fromNodeIndex = inputNodeIndexes[z];
-                int toNodeIndex   = hiddenNodeIndexes[q];
-                links.push_back(GeneticLinkGene(genes[fromNodeIndex].getID(),genes[toNodeIndex].getID()));
-            }
-        }
-
-        // [Links] Processing --> Output 
-        for (int z=0; z<hiddenNodeIndexes.size(); z++) {
-            for (int q=0; q<outputNodeIndexes.size(); q++) {
-                int fromNodeIndex = hiddenNodeIndexes[z];
-                int toNodeIndex   = outputNodeIndexes[q];
-                links.push_back(GeneticLinkGene(genes[fromNodeIndex].getID(),genes[toNodeIndex].getID()));
-            }
+        // [Links] Input --> Processing and Processing --> Output
+        for (int a=0; a<int(geneLinks.size()); a++) {
+            links.push_back(GeneticLinkGene(genes[geneLinks[a].first].getID(),genes[geneLinks[a].second].getID()));
         }
         end = clock();
         cout << "Created " << links.size() << " links in " << float(end-start)/CLOCKS_PER_SEC << " seconds." << endl;
@@ -187,9 +169,50 @@ namespace HCUBE
         return FTNEAT_population;
     }
 
+    bool AtariFTNeatExperiment::hasInitialGeneOrder(shared_ptr<GeneticIndividual> individual) {
+        if (individual->getNodesCount() < int(geneNames.size()) ||
+            individual->getLinksCount() < int(geneLinks.size())) {
+            return false;
+        }
+
+        for (int a=0; a<int(geneNames.size()); a++) {
+            if (individual->getNode(a)->getName() != geneNames[a]) {
+                return false;
+            }
+        }
+
+        for (int a=0; a<int(geneLinks.size()); a++) {
+            const GeneticLinkGene* link = individual->getLink(a);
+            if (link->getFromNodeID() != individual->getNode(geneLinks[a].first)->getID() ||
+                link->getToNodeID() != individual->getNode(geneLinks[a].second)->getID()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     void AtariFTNeatExperiment::convertIndividual(shared_ptr<GeneticIndividual> FTNEAT_individual,
                                                   NEAT::LayeredSubstrate<float>* HyperNEAT_substrate)
-                                                  
+    {
+        // Genes are only added after the initial ones, so this holds for
+        // every individual of a population made by createInitialPopulation()
+        if (!hasInitialGeneOrder(FTNEAT_individual)) {
+            convertIndividualByName(FTNEAT_individual, HyperNEAT_substrate);
+            return;
+        }
+
+        NEAT::FastLayeredNetwork<float>* HyperNEAT_network = HyperNEAT_substrate->getNetwork();
+
+        for (int a=0; a<int(geneLinks.size()); a++) {
+            float linkWeight = HyperNEAT_network->getLink(geneSubstrateNodes[geneLinks[a].first],
+                                                          geneSubstrateNodes[geneLinks[a].second]);
+            FTNEAT_individual->getLink(a)->setWeight(double(linkWeight));
+        }
+    }
+
+    void AtariFTNeatExperiment::convertIndividualByName(shared_ptr<GeneticIndividual> FTNEAT_individual,
+                                                        NEAT::LayeredSubstrate<float>* HyperNEAT_substrate)
     {
         NEAT::FastLayeredNetwork<float>* HyperNEAT_network = HyperNEAT_substrate->getNetwork();
 
@@ -254,13 +277,33 @@ namespace HCUBE
     {
         individual->setFitness(0);
         substrate = individual->spawnFastPhenotypeStack<float>();
+        resolveNodeIndices();
         runAtariEpisode(individual);
     }
 
+    void AtariFTNeatExperiment::resolveNodeIndices() {
+        inputNodeIndices.resize((numObjClasses+1)*substrate_height*substrate_width);
+        for (int i=0; i<=numObjClasses; ++i) {
+            for (int y=0; y<substrate_height; y++) {
+                for (int x=0; x<substrate_width; x++) {
+                    inputNodeIndices[(i*substrate_height+y)*substrate_width+x] =
+                        substrate.getNodeIndex(nameLookup[Node(substrate_width*i+x,y,0)]);
+                }
+            }
+        }
+
+        outputNodeIndices.resize(numActions);
+        for (int i=0; i<numActions; i++) {
+            outputNodeIndices[i] = substrate.getNodeIndex(nameLookup[Node(i,0,2)]);
+        }
+    }
+
     void AtariFTNeatExperiment::runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual) {
         // Reset the game
         ale.reset_game();
-        
+        unsigned long startMicroseconds = NEAT::Profiler::getMicroseconds();
+        int decisions = 0;
+
         while (!ale.game_over()) {
             // Set value of all nodes to zero
             substrate.reinitialize(); 
@@ -280,9 +323,18 @@ namespace HCUBE
 
             // Choose which action to take
             Action action = selectAction(*visProc);
-            ale.act(action);
+            decisions++;
+            {
+                NEAT_PROFILE_SCOPE("environmentStep");
+                // Hold the action without looking at the screen in between
+                for (int frame=0; frame<frameSkip && !ale.game_over(); frame++) {
+                    ale.act(action);
+                }
+            }
         }
-        cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        double seconds = (NEAT::Profiler::getMicroseconds()-startMicroseconds)/1000000.0;
+        cout << "Game ended in " << ale.frame << " frames (" << decisions << " decisions, "
+             << seconds << " seconds) with score " << ale.game_score << endl;
  
         // Give the reward to the agent
         individual->reward(ale.game_score);
@@ -304,7 +356,8 @@ namespace HCUBE
             point obj_centroid = visProc.composite_objs[obj_id].get_centroid();
             int adj_x = obj_centroid.x * substrate_width / visProc.screen_width;
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
-            substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
+            substrate.setValue(inputNodeIndices[(substrateIndx*substrate_height+adj_y)*substrate_width+adj_x],
+                               assigned_value);
         }
     }
 
@@ -318,7 +371,7 @@ namespace HCUBE
         vector<int> max_inds;
         float max_val = -1e37;
         for (int i=0; i < numActions; i++) {
-            float output = substrate.getValue(nameLookup[Node(i,0,2)]);
+            float output = substrate.getValue(outputNodeIndices[i]);
             if (output == max_val)
                 max_inds.push_back(i);
             else if (output > max_val) {
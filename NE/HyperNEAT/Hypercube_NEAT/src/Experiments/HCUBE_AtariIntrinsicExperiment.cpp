@@ -65,8 +65,8 @@ namespace HCUBE
     }
 
     int SarsaLambda::selectAction(vector<double>& qVals) {
-        if (double(rand())/RAND_MAX < epsilon) {
-            return rand() % numActions;
+        if (NEAT::Globals::getSingleton()->getRandom().getRandomDouble() < epsilon) {
+            return NEAT::Globals::getSingleton()->getRandom().getRandomInt(numActions);
         } else {
             vector<int> max_inds;
             double max_val = -1e37;
@@ -79,7 +79,7 @@ namespace HCUBE
                     max_val = qVals[i];
                 }
             }
-            return max_inds[rand() % max_inds.size()];
+            return max_inds[NEAT::Globals::getSingleton()->getRandom().getRandomInt(max_inds.size())];
         }
     }
 
@@ -97,7 +97,7 @@ namespace HCUBE
 
     AtariIntrinsicExperiment::AtariIntrinsicExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), visProc(NULL), rom_file(""),
-        numActions(0), numObjClasses(0), display_active(false), agent(NULL)
+        numActions(0), numObjClasses(0), display_active(false), frameSkip(1), agent(NULL)
     {
     }
 
@@ -122,6 +122,8 @@ namespace HCUBE
         numActions = ale.legal_actions.size();
         numFeatures = substrate_width * substrate_height * (numObjClasses + 1);
 
+        frameSkip = NEAT::Globals::getSingleton()->getFrameSkip();
+
         for (int i=0; i<numFeatures; i++)
             phi.push_back(0);
 
@@ -192,10 +194,23 @@ namespace HCUBE
         individual->setFitness(0);
 
         substrate = individual->spawnFastPhenotypeStack<double>();
+        resolveNodeIndices();
 
         runAtariEpisode(individual);
     }
 
+    void AtariIntrinsicExperiment::resolveNodeIndices() {
+        inputNodeIndices.resize((numObjClasses+1)*substrate_height*substrate_width);
+        for (int i=0; i<=numObjClasses; ++i) {
+            for (int y=0; y<substrate_height; y++) {
+                for (int x=0; x<substrate_width; x++) {
+                    inputNodeIndices[(i*substrate_height+y)*substrate_width+x] =
+                        substrate.getNodeIndex(nameLookup[Node(substrate_width*i+x,y,0)]);
+                }
+            }
+        }
+    }
+
     void AtariIntrinsicExperiment::runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual) {
         agent->printinfo();
         int numEpisodes = 10000;
@@ -204,6 +219,8 @@ namespace HCUBE
             double reward = 0;
             ale.reset_game();
             agent->reset();
+            unsigned long startMicroseconds = NEAT::Profiler::getMicroseconds();
+            int decisions = 0;
         
             while (!ale.game_over()) {
                 for (int i=0; i<numFeatures; i++)
@@ -230,9 +247,21 @@ namespace HCUBE
 
                 int action_indx = agent->act(phi, reward);
                 Action action = ale.legal_actions[action_indx];
-                reward = ale.act(action);
+                decisions++;
+
+                // The agent's reward is the sum over the frames the action is held
+                reward = 0;
+                {
+                    NEAT_PROFILE_SCOPE("environmentStep");
+                    // Hold the action without looking at the screen in between
+                    for (int frame=0; frame<frameSkip && !ale.game_over(); frame++) {
+                        reward += ale.act(action);
+                    }
+                }
             }
-            cout << "Episode " << episode << " ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+            double seconds = (NEAT::Profiler::getMicroseconds()-startMicroseconds)/1000000.0;
+            cout << "Episode " << episode << " ended in " << ale.frame << " frames (" << decisions
+                 << " decisions, " << seconds << " seconds) with score " << ale.game_score << endl;
             totalScore += ale.game_score;
         }
 
@@ -257,7 +286,8 @@ namespace HCUBE
             point obj_centroid = visProc.composite_objs[obj_id].get_centroid();
             int adj_x = obj_centroid.x * substrate_width / visProc.screen_width;
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
-            substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
+            substrate.setValue(inputNodeIndices[(substrateIndx*substrate_height+adj_y)*substrate_width+adj_x],
+                               assigned_value);
             // Set the phi-feature to true
             phi[(substrate_width*substrate_height*substrateIndx) + (substrate_width*adj_y) + adj_x] = true;
         }
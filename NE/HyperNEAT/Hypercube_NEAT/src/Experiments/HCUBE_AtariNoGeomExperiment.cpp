@@ -10,7 +10,7 @@ namespace HCUBE
 {
     AtariNoGeomExperiment::AtariNoGeomExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), visProc(NULL), rom_file(""),
-        numActions(0), numObjClasses(0), display_active(false)
+        numActions(0), numObjClasses(0), display_active(false), frameSkip(1)
     {
     }
 
@@ -34,6 +34,8 @@ namespace HCUBE
         }
         numActions = ale.legal_actions.size();
 
+        frameSkip = NEAT::Globals::getSingleton()->getFrameSkip();
+
         // Load the visual processing framework
         visProc = ale.visProc;
         numObjClasses = visProc->manual_obj_classes.size();
@@ -103,14 +105,34 @@ namespace HCUBE
         individual->setFitness(0);
 
         substrate = individual->spawnFastPhenotypeStack<double>();
+        resolveNodeIndices();
 
         runAtariEpisode(individual);
     }
 
+    void AtariNoGeomExperiment::resolveNodeIndices() {
+        inputNodeIndices.resize((numObjClasses+1)*substrate_height*substrate_width);
+        for (int i=0; i<=numObjClasses; ++i) {
+            for (int y=0; y<substrate_height; y++) {
+                for (int x=0; x<substrate_width; x++) {
+                    inputNodeIndices[(i*substrate_height+y)*substrate_width+x] =
+                        substrate.getNodeIndex(nameLookup[Node(substrate_width*i+x,y,0)]);
+                }
+            }
+        }
+
+        outputNodeIndices.resize(numActions);
+        for (int i=0; i<numActions; i++) {
+            outputNodeIndices[i] = substrate.getNodeIndex(nameLookup[Node(i,0,2)]);
+        }
+    }
+
     void AtariNoGeomExperiment::runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual) {
         // Reset the game
         ale.reset_game();
-        
+        unsigned long startMicroseconds = NEAT::Profiler::getMicroseconds();
+        int decisions = 0;
+
         while (!ale.game_over()) {
             // Set value of all nodes to zero
             substrate.reinitialize(); 
@@ -129,9 +151,18 @@ namespace HCUBE
 
             // Choose which action to take
             Action action = selectAction(*visProc);
-            ale.act(action);
+            decisions++;
+            {
+                NEAT_PROFILE_SCOPE("environmentStep");
+                // Hold the action without looking at the screen in between
+                for (int frame=0; frame<frameSkip && !ale.game_over(); frame++) {
+                    ale.act(action);
+                }
+            }
         }
-        cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        double seconds = (NEAT::Profiler::getMicroseconds()-startMicroseconds)/1000000.0;
+        cout << "Game ended in " << ale.frame << " frames (" << decisions << " decisions, "
+             << seconds << " seconds) with score " << ale.game_score << endl;
  
         // Give the reward to the agent
         individual->reward(ale.game_score);
@@ -153,7 +184,8 @@ namespace HCUBE
             point obj_centroid = visProc.composite_objs[obj_id].get_centroid();
             int adj_x = obj_centroid.x * substrate_width / visProc.screen_width;
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
-            substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
+            substrate.setValue(inputNodeIndices[(substrateIndx*substrate_height+adj_y)*substrate_width+adj_x],
+                               assigned_value);
         }
     }
 
@@ -167,7 +199,7 @@ namespace HCUBE
         vector<int> max_inds;
         float max_val = -1e37;
         for (int i=0; i < numActions; i++) {
-            float output = substrate.getValue(nameLookup[Node(i,0,2)]);
+            float output = substrate.getValue(outputNodeIndices[i]);
             if (output == max_val)
                 max_inds.push_back(i);
             else if (output > max_val) {
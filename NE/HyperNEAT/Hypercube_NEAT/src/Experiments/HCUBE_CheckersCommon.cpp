@@ -6,6 +6,274 @@
 
 namespace HCUBE
 {
+    namespace
+    {
+        //Directions in the order generateMoveList tries them: the two +y
+        //directions (black men and kings), then the two -y directions
+        const int directionDeltaX[4] = {1,-1,1,-1};
+        const int directionDeltaY[4] = {1,1,-1,-1};
+
+        //tryMoreJumps tries the continuations of a multi-jump in a different order
+        const int continuationDirections[4] = {1,0,3,2};
+
+        //The square next to each square in each direction, and the square a
+        //jump in that direction lands on, or -1 off the board
+        int neighborSquares[32][4];
+        int jumpSquares[32][4];
+
+        //Rows where black and white men are crowned
+        unsigned int blackKingRow;
+        unsigned int whiteKingRow;
+
+        //One key per square and piece (black man, black king, white man,
+        //white king) and one per color to move.
+        unsigned long long zobristSquareKeys[32][4];
+        unsigned long long zobristColorKeys[3];
+
+        //splitmix64, so the keys are the same on every run and platform
+        unsigned long long nextZobristKey(unsigned long long &state)
+        {
+            unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        class BitboardTableInitializer
+        {
+        public:
+            BitboardTableInitializer()
+            {
+                blackKingRow = whiteKingRow = 0;
+
+                for (int square=0;square<32;square++)
+                {
+                    int x = CheckersBitboard::getX(square);
+                    int y = CheckersBitboard::getY(square);
+
+                    for (int direction=0;direction<4;direction++)
+                    {
+                        int nx = x+directionDeltaX[direction];
+                        int ny = y+directionDeltaY[direction];
+                        int jx = x+directionDeltaX[direction]*2;
+                        int jy = y+directionDeltaY[direction]*2;
+
+                        neighborSquares[square][direction] =
+                            (nx>=0 && ny>=0 && nx<8 && ny<8) ? CheckersBitboard::getSquare(nx,ny) : -1;
+                        jumpSquares[square][direction] =
+                            (jx>=0 && jy>=0 && jx<8 && jy<8) ? CheckersBitboard::getSquare(jx,jy) : -1;
+                    }
+
+                    if (y==7)
+                    {
+                        blackKingRow |= (1U<<square);
+                    }
+                    else if (y==0)
+                    {
+                        whiteKingRow |= (1U<<square);
+                    }
+                }
+
+                unsigned long long state=0;
+
+                for (int square=0;square<32;square++)
+                {
+                    for (int piece=0;piece<4;piece++)
+                    {
+                        zobristSquareKeys[square][piece] = nextZobristKey(state);
+                    }
+                }
+
+                for (int color=0;color<3;color++)
+                {
+                    zobristColorKeys[color] = nextZobristKey(state);
+                }
+            }
+        };
+
+        BitboardTableInitializer bitboardTableInitializer;
+
+        inline unsigned long long getSquareKey(int square,int color,bool king)
+        {
+            return zobristSquareKeys[square][(color==BLACK ? 0 : 2) + (king ? 1 : 0)];
+        }
+    }
+
+    CheckersBitboard::CheckersBitboard(uchar b[8][8])
+        :
+    black(0),
+        white(0),
+        kings(0)
+    {
+        for (int square=0;square<32;square++)
+        {
+            uchar piece = b[getX(square)][getY(square)];
+
+            if (piece&BLACK)
+            {
+                black |= (1U<<square);
+            }
+            else if (piece&WHITE)
+            {
+                white |= (1U<<square);
+            }
+
+            if ((piece&(BLACK|WHITE)) && (piece&KING))
+            {
+                kings |= (1U<<square);
+            }
+        }
+    }
+
+    void CheckersBitboard::toBoard(uchar b[8][8]) const
+    {
+        int blackPieces=0,whitePieces=0;
+
+        for (int y=0;y<8;y++)
+        {
+            for (int x=0;x<8;x++)
+            {
+                b[x][y] = ((x+y)%2==0) ? 0 : FREE;
+            }
+        }
+
+        for (int square=0;square<32;square++)
+        {
+            unsigned int mask = (1U<<square);
+            uchar &piece = b[getX(square)][getY(square)];
+
+            if (black&mask)
+            {
+                piece = BLACK | ((kings&mask) ? KING : MAN);
+                blackPieces++;
+            }
+            else if (white&mask)
+            {
+                piece = WHITE | ((kings&mask) ? KING : MAN);
+                whitePieces++;
+            }
+        }
+
+        NUM_BLACK_PIECES(b) = blackPieces;
+        NUM_WHITE_PIECES(b) = whitePieces;
+    }
+
+    CheckersTranspositionTable::CheckersTranspositionTable(int _bucketCount)
+        :
+    storage(NULL),
+        buckets(NULL),
+        bucketCount(_bucketCount)
+    {
+        if (bucketCount<=0 || (bucketCount&(bucketCount-1)))
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: The transposition table size must be a power of two!");
+        }
+
+        allocate();
+    }
+
+    CheckersTranspositionTable::CheckersTranspositionTable(const CheckersTranspositionTable &other)
+        :
+    storage(NULL),
+        buckets(NULL),
+        bucketCount(other.bucketCount)
+    {
+        allocate();
+    }
+
+    const CheckersTranspositionTable &CheckersTranspositionTable::operator=(const CheckersTranspositionTable &other)
+    {
+        if (this != &other)
+        {
+            if (bucketCount != other.bucketCount)
+            {
+                delete[] storage;
+                bucketCount = other.bucketCount;
+                allocate();
+            }
+            else
+            {
+                clear();
+            }
+        }
+
+        return *this;
+    }
+
+    CheckersTranspositionTable::~CheckersTranspositionTable()
+    {
+        delete[] storage;
+    }
+
+    void CheckersTranspositionTable::allocate()
+    {
+        storage = new char[size_t(bucketCount)*BUCKET_BYTES + BUCKET_BYTES];
+
+        //Align the buckets to cache lines
+        size_t offset = size_t(storage)%BUCKET_BYTES;
+        buckets = storage + (offset ? (BUCKET_BYTES-offset) : 0);
+
+        clear();
+    }
+
+    void CheckersTranspositionTable::clear()
+    {
+        memset(buckets,0,size_t(bucketCount)*BUCKET_BYTES);
+    }
+
+    const CheckersTranspositionTable::Entry *CheckersTranspositionTable::probe(unsigned long long key) const
+    {
+        const Entry *bucket = getBucket(key);
+
+        for (int a=0;a<getEntriesPerBucket();a++)
+        {
+            if (bucket[a].bound!=BOUND_NONE && bucket[a].key==key)
+            {
+                return &bucket[a];
+            }
+        }
+
+        return NULL;
+    }
+
+    void CheckersTranspositionTable::store(
+        unsigned long long key,
+        CheckersNEATDatatype value,
+        int depth,
+        BoundType bound,
+        int bestMove
+    )
+    {
+        Entry *bucket = getBucket(key);
+        Entry *replace = &bucket[0];
+
+        for (int a=0;a<getEntriesPerBucket();a++)
+        {
+            if (bucket[a].bound==BOUND_NONE || bucket[a].key==key)
+            {
+                replace = &bucket[a];
+                break;
+            }
+
+            if (bucket[a].depth < replace->depth)
+            {
+                replace = &bucket[a];
+            }
+        }
+
+        if (bestMove<0 || bestMove>=NO_MOVE)
+        {
+            //Keep the old best move for move ordering
+            bestMove = (replace->bound!=BOUND_NONE && replace->key==key) ? replace->bestMove : NO_MOVE;
+        }
+
+        replace->key = key;
+        replace->value = value;
+        replace->depth = (signed char)max(-128,min(127,depth));
+        replace->bound = (uchar)bound;
+        replace->bestMove = (uchar)bestMove;
+    }
+
     CheckersMove::CheckersMove()
         :
     from(255,255),
@@ -858,6 +1126,329 @@ namespace HCUBE
         return numMoves;
     }
 
+    namespace
+    {
+        inline bool canMoveInDirection(bool king,int color,int direction)
+        {
+            return king || ((color==BLACK) == (direction<2));
+        }
+
+        inline unsigned int getKingRow(int color)
+        {
+            return (color==BLACK) ? blackKingRow : whiteKingRow;
+        }
+
+        inline void addBitboardMove(
+            CheckersBitboardMove *moveList,
+            int &numMoves,
+            const CheckersBitboardMove &move
+        )
+        {
+            if (numMoves==CHECKERS_MAX_BITBOARD_MOVES)
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Too many possible moves for a given board state! Oh shiz!");
+            }
+
+            moveList[numMoves++] = move;
+        }
+
+        /*
+        * Follows a jump in progress the same way tryMoreJumps does.  Captured
+        * pieces are off the board as soon as they are jumped, and a jump can't
+        * land on the square the move started from.
+        */
+        bool addMoreBitboardJumps(
+            CheckersBitboardMove *moveList,
+            int &numMoves,
+            const CheckersBitboardMove &moveInProgress,
+            bool king,
+            int color,
+            unsigned int opponents,
+            unsigned int empty
+        )
+        {
+            bool hasMoreJumps=false;
+
+            for (int a=0;a<4;a++)
+            {
+                int direction = continuationDirections[a];
+                int jumped = neighborSquares[moveInProgress.to][direction];
+                int landing = jumpSquares[moveInProgress.to][direction];
+
+                if (
+                    !canMoveInDirection(king,color,direction) ||
+                    landing==-1 ||
+                    landing==moveInProgress.from ||
+                    !(opponents & ~moveInProgress.captured & (1U<<jumped)) ||
+                    !((empty|moveInProgress.captured) & (1U<<landing))
+                    )
+                {
+                    continue;
+                }
+
+                hasMoreJumps=true;
+
+                CheckersBitboardMove jump = moveInProgress;
+                jump.to = landing;
+                jump.captured |= (1U<<jumped);
+                jump.promoted = !king && (getKingRow(color)&(1U<<landing));
+
+                bool moreJumps=false;
+                if (!jump.promoted)
+                {
+                    //"A piece that has just kinged, cannot continue jumping pieces, until the next move."
+                    moreJumps = addMoreBitboardJumps(moveList,numMoves,jump,king,color,opponents,empty);
+                }
+
+                if (!moreJumps)
+                {
+                    addBitboardMove(moveList,numMoves,jump);
+                }
+            }
+
+            return hasMoreJumps;
+        }
+    }
+
+    int CheckersCommon::generateMoves(
+        const CheckersBitboard &position,
+        int color,
+        CheckersBitboardMove *moveList,
+        bool &foundJump
+        )
+    {
+        int numMoves=0;
+
+        foundJump=false;
+
+        unsigned int pieces = position.getPieces(color);
+        unsigned int opponents = position.getPieces(color==BLACK ? WHITE : BLACK);
+        unsigned int empty = position.getEmpty();
+
+        for (int square=0;square<32;square++)
+        {
+            if (!(pieces&(1U<<square)))
+            {
+                continue;
+            }
+
+            bool king = (position.kings&(1U<<square))!=0;
+
+            for (int direction=0;direction<4;direction++)
+            {
+                int neighbor = neighborSquares[square][direction];
+
+                if (!canMoveInDirection(king,color,direction) || neighbor==-1)
+                {
+                    continue;
+                }
+
+                CheckersBitboardMove move;
+                move.from = square;
+
+                if (empty&(1U<<neighbor))
+                {
+                    //Only slide if you haven't yet found a possible capture
+                    if (!foundJump)
+                    {
+                        move.to = neighbor;
+                        move.promoted = !king && (getKingRow(color)&(1U<<neighbor));
+                        move.captured = 0;
+                        addBitboardMove(moveList,numMoves,move);
+                    }
+                    continue;
+                }
+
+                int landing = jumpSquares[square][direction];
+
+                if (
+                    landing==-1 ||
+                    !(opponents&(1U<<neighbor)) ||
+                    !(empty&(1U<<landing))
+                    )
+                {
+                    continue;
+                }
+
+                if (!foundJump)
+                {
+                    //The first jump erases the slides
+                    numMoves=0;
+                    foundJump=true;
+                }
+
+                move.to = landing;
+                move.promoted = !king && (getKingRow(color)&(1U<<landing));
+                move.captured = (1U<<neighbor);
+
+                bool foundMoreJumps=false;
+                if (!move.promoted)
+                {
+                    foundMoreJumps = addMoreBitboardJumps(moveList,numMoves,move,king,color,opponents,empty);
+                }
+
+                if (!foundMoreJumps)
+                {
+                    addBitboardMove(moveList,numMoves,move);
+                }
+            }
+        }
+
+        return numMoves;
+    }
+
+    void CheckersCommon::makeMove(const CheckersBitboardMove &move,CheckersBitboard &position,int color)
+    {
+        unsigned int fromMask = (1U<<move.from);
+        unsigned int toMask = (1U<<move.to);
+        bool king = (position.kings&fromMask) || move.promoted;
+
+        if (color==BLACK)
+        {
+            position.black = (position.black&~fromMask)|toMask;
+            position.white &= ~move.captured;
+        }
+        else
+        {
+            position.white = (position.white&~fromMask)|toMask;
+            position.black &= ~move.captured;
+        }
+
+        position.kings &= ~(fromMask|move.captured);
+        if (king)
+        {
+            position.kings |= toMask;
+        }
+    }
+
+    unsigned long long CheckersCommon::computeHash(const CheckersBitboard &position)
+    {
+        unsigned long long hash=0;
+
+        for (int square=0;square<32;square++)
+        {
+            unsigned int mask = (1U<<square);
+
+            if (position.black&mask)
+            {
+                hash ^= getSquareKey(square,BLACK,(position.kings&mask)!=0);
+            }
+            else if (position.white&mask)
+            {
+                hash ^= getSquareKey(square,WHITE,(position.kings&mask)!=0);
+            }
+        }
+
+        return hash;
+    }
+
+    unsigned long long CheckersCommon::getMoveHash(const CheckersBitboardMove &move,const CheckersBitboard &position,int color)
+    {
+        bool king = (position.kings&(1U<<move.from))!=0;
+        int otherColor = (color==BLACK) ? WHITE : BLACK;
+
+        unsigned long long hash =
+            getSquareKey(move.from,color,king) ^
+            getSquareKey(move.to,color,king||move.promoted);
+
+        for (unsigned int captured=move.captured;captured;captured&=(captured-1))
+        {
+            int square=0;
+            while (!(captured&(1U<<square)))
+            {
+                square++;
+            }
+
+            hash ^= getSquareKey(square,otherColor,(position.kings&(1U<<square))!=0);
+        }
+
+        return hash;
+    }
+
+    unsigned long long CheckersCommon::getColorHash(int colorToMove)
+    {
+        return zobristColorKeys[colorToMove];
+    }
+
+    CheckersMove CheckersCommon::findMove(uchar b[8][8],int color,const CheckersBitboardMove &move)
+    {
+        CheckersBitboard target(b);
+        makeMove(move,target,color);
+
+        vector<CheckersMove> moveList;
+        bool foundJump;
+        int numMoves = generateMoveList(moveList,0,b,color,foundJump);
+
+        for (int a=0;a<numMoves;a++)
+        {
+            makeMove(moveList[a],b);
+            bool matches = (CheckersBitboard(b)==target);
+            reverseMove(moveList[a],b);
+
+            if (matches)
+            {
+                return moveList[a];
+            }
+        }
+
+        printBoard(b);
+        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: the bitboard move isn't in the move list!");
+    }
+
+    unsigned long long CheckersCommon::perft(const CheckersBitboard &position,int color,int depth)
+    {
+        if (depth==0)
+        {
+            return 1;
+        }
+
+        CheckersBitboardMove moveList[CHECKERS_MAX_BITBOARD_MOVES];
+        bool foundJump;
+        int numMoves = generateMoves(position,color,moveList,foundJump);
+
+        if (depth==1)
+        {
+            return numMoves;
+        }
+
+        unsigned long long leaves=0;
+        for (int a=0;a<numMoves;a++)
+        {
+            CheckersBitboard child = position;
+            makeMove(moveList[a],child,color);
+            leaves += perft(child,(color==BLACK) ? WHITE : BLACK,depth-1);
+        }
+
+        return leaves;
+    }
+
+    unsigned long long CheckersCommon::perft(uchar b[8][8],int color,int depth)
+    {
+        if (depth==0)
+        {
+            return 1;
+        }
+
+        vector<CheckersMove> moveList;
+        bool foundJump;
+        int numMoves = generateMoveList(moveList,0,b,color,foundJump);
+
+        if (depth==1)
+        {
+            return numMoves;
+        }
+
+        unsigned long long leaves=0;
+        for (int a=0;a<numMoves;a++)
+        {
+            makeMove(moveList[a],b);
+            leaves += perft(b,(color==BLACK) ? WHITE : BLACK,depth-1);
+            reverseMove(moveList[a],b);
+        }
+
+        return leaves;
+    }
+
     bool CheckersCommon::hasMove(
         uchar b[8][8],
         int color,
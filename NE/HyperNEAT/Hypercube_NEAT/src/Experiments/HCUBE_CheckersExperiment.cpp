@@ -6,7 +6,7 @@
 
 #define DEBUG_CHECK_HAND_CODED_HEURISTIC (0)
 
-#define DEBUG_USE_BOARD_EVALUATION_CACHE (1)
+#define DEBUG_USE_TRANSPOSITION_TABLE (1)
 
 #define DEBUG_DUMP_BOARD_LEAF_EVALUATIONS (0)
 
@@ -16,7 +16,7 @@
 
 #define DEBUG_USE_DELTAS (1)
 
-#define DEBUG_DO_ITERATIVE_DEEPENING (0)
+#define DEBUG_DO_ITERATIVE_DEEPENING (1)
 
 #define BASE_EVOLUTION_SEARCH_DEPTH (4)
 
@@ -93,23 +93,22 @@ namespace HCUBE
 
     using namespace NEAT;
 
-    mutex cakeMutex;
+    //cliche keeps its search in globals, so only one game at a time may use it.
+    //Cake searches with the context of each experiment and needs no lock.
+    mutex clicheMutex;
 
     CheckersExperiment::CheckersExperiment(string _experimentName,int _threadID)
         :
     Experiment(_experimentName,_threadID),
         currentSubstrateIndex(0),
+        chanceToMakeSecondBestMove(0.0),
+        transpositionTableEvaluator(-1),
         from(255,255),
         DEBUG_USE_HANDCODED_EVALUATION(0),
         DEBUG_USE_HYPERNEAT_EVALUATION(0),
-        chanceToMakeSecondBestMove(0.0),
 		dumpEvaluationImages(false),
 		cakeRandomSeed(1000)
     {
-        searchInfo.repcheck = NULL;
-        //boardEvaluationCaches[0].resize(10000);
-        //boardEvaluationCaches[1].resize(10000);
-
         numNodesX[0] = numNodesY[0] = 8;
         numNodesX[1] = numNodesY[1] = 8;
         numNodesX[2] = numNodesY[2] = 1;
@@ -149,8 +148,6 @@ namespace HCUBE
 
     CheckersExperiment::~CheckersExperiment()
     {
-        if(searchInfo.repcheck)
-            free(searchInfo.repcheck);
     }
 
     GeneticPopulation* CheckersExperiment::createInitialPopulation(int populationSize)
@@ -216,26 +213,32 @@ namespace HCUBE
 
         substrate = &substrates[substrateNum];
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
-        {
-            boardEvaluationCaches[substrateNum][a].clear();
-            boardEvaluationCaches[substrateNum][a].reserve(0);
-        }
+        clearTranspositionTable();
+
+        substrate->populateSubstrate(individual);
+    }
+
+    void CheckersExperiment::clearTranspositionTable()
+    {
+        transpositionTable.clear();
+        transpositionTableEvaluator = -1;
+    }
 
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
+    void CheckersExperiment::prepareTranspositionTable()
+    {
+        //Stored values come from the leaf evaluations, so they are only valid
+        //for the substrate (or hand-coded player) that produced them
+        int evaluator = currentSubstrateIndex;
+        if (currentSubstrateIndex==handCodedAISubstrateIndex)
         {
-            boardStateLists[substrateNum][BLACK][a].clear();
-            boardStateLists[substrateNum][BLACK][a].reserve(0);
+            evaluator += handCodedType;
         }
-        for (int a=0;a<65536;a++)
+
+        if (evaluator != transpositionTableEvaluator)
         {
-            boardStateLists[substrateNum][WHITE][a].clear();
-            boardStateLists[substrateNum][WHITE][a].reserve(0);
+            transpositionTable.clear();
+            transpositionTableEvaluator = evaluator;
         }
-
-        substrate->populateSubstrate(individual);
     }
 
     CheckersNEATDatatype CheckersExperiment::processEvaluation(
@@ -1115,30 +1118,7 @@ namespace HCUBE
         }
         CheckersNEATDatatype output;
 
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-        tmpboard.loadBoard(b);
-        ushort hashVal = tmpboard.getShortHash();
-
-        BoardCacheList::iterator bIterator =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].begin();
-        BoardCacheList::iterator bEnd =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].end();
-
-        for (;bIterator != bEnd;bIterator++)
-        {
-            if (bIterator->first == tmpboard)
-            {
-                //We have a match!
-                break;
-            }
-        }
-
-        if (bIterator != bEnd)
-        {
-            output = bIterator->second;
-        }
-        else
-#endif
+        //Leaf values are cached by the transposition table in evaluatemax
         {
 
             substrate->getNetwork()->reinitialize();
@@ -1210,15 +1190,6 @@ namespace HCUBE
                 CREATE_PAUSE("");
             }
 #endif
-
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-            if (boardEvaluationCaches[currentSubstrateIndex][hashVal].size()<10000)
-            {
-                boardEvaluationCaches[currentSubstrateIndex][hashVal].push_back(
-                    BoardCachePair(tmpboard,output)
-                    );
-            }
-#endif
         }
 
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
@@ -1327,11 +1298,35 @@ namespace HCUBE
         {}
     };
 
+#if DEBUG_USE_TRANSPOSITION_TABLE
+    //Maps the position of a move in the search order back to its index in
+    //generation order, which is what the transposition table stores
+    static inline int generatedMoveIndex(int searchIndex,int hashMoveIndex)
+    {
+        if (hashMoveIndex<=0)
+        {
+            return searchIndex;
+        }
+        else if (searchIndex==0)
+        {
+            return hashMoveIndex;
+        }
+        else if (searchIndex<=hashMoveIndex)
+        {
+            return searchIndex-1;
+        }
+
+        return searchIndex;
+    }
+#endif
+
     pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemax(uchar b[8][8],  CheckersNEATDatatype parentBeta, int depth,int maxDepth)
     {
         if (depth==0)
         {
-            totalMoveList.clear();
+#if DEBUG_USE_TRANSPOSITION_TABLE
+            prepareTranspositionTable();
+#endif
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
             cout << "Creating new outfile\n";
             if (outfile) delete outfile;
@@ -1340,180 +1335,113 @@ namespace HCUBE
 
         }
 
-        int moveListCount;
-
-        pair<CheckersNEATDatatype,int> alpha=pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN),-1);
+        CheckersBitboard position(b);
 
-        bool foundJump;
-        int bestMoveSoFarIndex=-1;
+        bitboardMoveToMake.from = secondBestBitboardMoveToMake.from = CHECKERS_NO_BITBOARD_MOVE;
 
-		int oldMoveListSize = (int)totalMoveList.size();
+        pair<CheckersNEATDatatype,int> retval = searchmax(position,computeHash(position),parentBeta,depth,maxDepth);
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        bool useCachedTable=false;
+        if (bitboardMoveToMake.from != CHECKERS_NO_BITBOARD_MOVE)
+        {
+            moveToMake = findMove(b,BLACK,bitboardMoveToMake);
+            secondBestMoveToMake = findMove(b,BLACK,secondBestBitboardMoveToMake);
+        }
 
-        CheckersBoardState bState(b,BLACK);
+        return retval;
+    }
 
+    pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemin(uchar b[8][8],  CheckersNEATDatatype parentAlpha, int depth,int maxDepth)
+    {
         if (depth==0)
         {
+#if DEBUG_USE_TRANSPOSITION_TABLE
+            prepareTranspositionTable();
+#endif
+#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
+            cout << "Creating new outfile\n";
+            if (outfile) delete outfile;
+            outfile = new ofstream("BoardEvaluations.txt");
+#endif
+
         }
-        else
-        {
-            vector<BoardStatePair> &bsVector = boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()];
-            vector<BoardStatePair>::iterator stateIterator = bsVector.begin();
-            vector<BoardStatePair>::iterator stateEnd = bsVector.end();
 
-            for (;stateIterator != stateEnd;stateIterator++)
-            {
-                if (stateIterator->first==bState)
-                {
-                    //We have a match
-                    int depthSearched =
-                        stateIterator->second.maxDepth - stateIterator->second.depth;
+        CheckersBitboard position(b);
 
-                    int depthToSearch = maxDepth - depth;
+        bitboardMoveToMake.from = secondBestBitboardMoveToMake.from = CHECKERS_NO_BITBOARD_MOVE;
 
-                    if (depthSearched >= depthToSearch)
-                    {
-                        //We've been down this path before (or we are currently
-                        //going down it in another branch of the tree),
-                        //just return the best score
-                        if (stateIterator->second.getNumMoves()==0)
-                        {
-                            //No moves possible, return the min score
-                            return INT_MIN/2;
-                        }
+        pair<CheckersNEATDatatype,int> retval = searchmin(position,computeHash(position),parentAlpha,depth,maxDepth);
 
-                        return stateIterator->second.getHighestScore();
-                    }
-                    else
-                    {
-                        //We've been down this path before, but not to this level of detail.
-                        //Use the previous alpha values, but continue
-                        useCachedTable=true;
+        if (bitboardMoveToMake.from != CHECKERS_NO_BITBOARD_MOVE)
+        {
+            moveToMake = findMove(b,WHITE,bitboardMoveToMake);
+            secondBestMoveToMake = findMove(b,WHITE,secondBestBitboardMoveToMake);
+        }
 
-                        moveListCount = stateIterator->second.getNumMoves();
+        return retval;
+    }
 
-                        /* FOR evaluatemin() FUNCTION!
-                        int index=0;
-                        for(int a=(moveListCount-1);a>=0;a--)
-                        {
-                        //We have to iterate backwards because they are sorted lowest
-                        //to highest score
-                        moveList[index] = stateIterator->second.moves.getIndexData[a];
-                        index++;
-                        }
-                        */
+    pair<CheckersNEATDatatype,int> CheckersExperiment::searchmax(
+        const CheckersBitboard &position,
+        unsigned long long positionHash,
+        CheckersNEATDatatype parentBeta,
+        int depth,
+        int maxDepth
+        )
+    {
+        int moveListCount;
 
-                        for (int a=0;a<moveListCount;a++)
-                        {
-                            totalMoveList.push_back(stateIterator->second.getMove(a));
-                        }
+        pair<CheckersNEATDatatype,int> alpha=pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN),-1);
 
-                        foundJump = stateIterator->second.foundJump;
+        bool foundJump;
+        int bestMoveSoFarIndex=-1;
 
-                        //Erase this, because it will get replaced.
-                        bsVector.erase(stateIterator);
+        CheckersBitboardMove moveList[CHECKERS_MAX_BITBOARD_MOVES];
 
-                        //Break out of the loop so we do not keep searching
-                        //(especially because the vector has now been invalidated with
-                        //the erase)
-                        break;
-                    }
-                }
-            }
-        }
-#endif
+#if DEBUG_USE_TRANSPOSITION_TABLE
+        //Evaluation dumps number every leaf, so they always search the whole tree
+        bool useTranspositionTable = !dumpEvaluationImages;
+        unsigned long long positionKey = positionHash^getColorHash(BLACK);
+        int hashMoveIndex=-1;
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        if (!useCachedTable)
-#endif
-        {
-            moveListCount = generateMoveList(totalMoveList,int(totalMoveList.size()),b,BLACK,foundJump);
-        }
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        else
+        if (useTranspositionTable)
         {
-#if CHECKERS_DEBUG
-            //Run a test to cross-verify moves
-            HCUBE::CheckersMove tmpMoves[128];
-            bool tmpFoundJump;
-
-            int tmpMoveListCount = generateMoveList(b,tmpMoves,BLACK,tmpFoundJump);
+            const CheckersTranspositionTable::Entry *entry = transpositionTable.probe(positionKey);
 
-            if (moveListCount != tmpMoveListCount)
+            if (entry)
             {
-                for (int b=0;b<moveListCount;b++)
-                {
-                    cout << (int)moveList[b].from.x << ',' << (int)moveList[b].from.y << " -> ";
-                    cout << (int)moveList[b].to.x << ',' << (int)moveList[b].to.y << endl;
-                }
-
-                cout << "***" << endl;
-
-                for (int a=0;a<tmpMoveListCount;a++)
+                if (
+                    depth>0 &&
+                    entry->depth >= maxDepth-depth &&
+                    (
+                        entry->bound==CheckersTranspositionTable::BOUND_EXACT ||
+                        (entry->bound==CheckersTranspositionTable::BOUND_LOWER && entry->value >= parentBeta)
+                    )
+                )
                 {
-                    cout << (int)tmpMoves[a].from.x << ',' << (int)tmpMoves[a].from.y << " -> ";
-                    cout << (int)tmpMoves[a].to.x << ',' << (int)tmpMoves[a].to.y << endl;
+                    //This position was already searched at least this deep
+                    return pair<CheckersNEATDatatype,int>(entry->value,-1);
                 }
 
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING NUMBER OF MOVES!");
-            }
-
-            if (foundJump != tmpFoundJump)
-            {
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING JUMP VALUE!");
-            }
-
-            for (int a=0;a<moveListCount;a++)
-            {
-                for (int b=0;b<=moveListCount;b++)
+                if (entry->bestMove != CheckersTranspositionTable::NO_MOVE)
                 {
-                    if (b==moveListCount)
-                    {
-                        cout << tmpMoves[a].from.x << ',' << tmpMoves[a].from.y << endl;
-                        cout << tmpMoves[a].to.x << ',' << tmpMoves[a].to.y << endl;
-
-                        cout << "***" << endl;
-
-                        for (int b=0;b<moveListCount;b++)
-                        {
-                            cout << moveList[b].from.x << ',' << moveList[b].from.y << endl;
-                            cout << moveList[b].to.x << ',' << moveList[b].to.y << endl;
-
-                        }
-
-                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR! MISSING A MOVE!");
-                    }
-
-                    if (moveList[b]==tmpMoves[a])
-                    {
-                        break;
-                    }
+                    hashMoveIndex = entry->bestMove;
                 }
             }
-#endif
         }
 #endif
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        //We have a movelist, let's cache it.
-        CheckersBoardStateData bStateData;
-
-        bStateData.depth = depth;
-        bStateData.maxDepth = maxDepth;
-        bStateData.foundJump = foundJump;
+        moveListCount = generateMoves(position,BLACK,moveList,foundJump);
 
-        /*
-        for(int a=0;a<moveListCount;a++)
+#if DEBUG_USE_TRANSPOSITION_TABLE
+        if (hashMoveIndex>0 && hashMoveIndex<moveListCount)
         {
-        bStateData.moves.insert(CheckersNEATDatatype(INT_MIN/2.0),moveList[a]);
+            //Search the best move from the previous search first
+            std::rotate(moveList,moveList+hashMoveIndex,moveList+hashMoveIndex+1);
+        }
+        else
+        {
+            hashMoveIndex=-1;
         }
-
-        boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()].push_back(
-        BoardStatePair(bState,bStateData)
-        );
-        */
 #endif
 
         if (!moveListCount)
@@ -1525,36 +1453,15 @@ namespace HCUBE
         if (depth==0 && moveListCount==1)
         {
             //Forced move, don't bother doing any evaluations
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            secondBestBitboardMoveToMake = bitboardMoveToMake = moveList[0];
             return pair<CheckersNEATDatatype,int>(0,-1);
         }
 
-#if 0
-        //Check for duplicate moves
-        for (int a=0;a<moveListCount;a++)
-        {
-            for (int b=0;b<moveListCount;b++)
-            {
-                if (a==b)
-                    continue;
-
-                if (moveList[a]==moveList[b])
-                {
-                    throw CREATE_LOCATEDEXCEPTION_INFO("OOPS!");
-                }
-            }
-        }
-#endif
-
-
 #if CHECKERS_EXPERIMENT_DEBUG
-        printBoard(b);
         cout << "Moves for black: " << endl;
         for (int a=0;a<moveListCount;a++)
         {
-            cout << "MOVE: (" << ((int)moveList[a].from.x) << ',' << ((int)moveList[a].from.y) << ") -> "
-                << "(" << ((int)moveList[a].to.x) << ',' << ((int)moveList[a].to.y) << ")" << endl;
+            cout << "MOVE: " << ((int)moveList[a].from) << " -> " << ((int)moveList[a].to) << endl;
         }
         CREATE_PAUSE("Done listing moves");
 #endif
@@ -1562,10 +1469,21 @@ namespace HCUBE
         if (depth >= maxDepth && DEBUG_USE_HYPERNEAT_EVALUATION && foundJump == false)
         {
             //This is a leaf node, return the neural network's evaluation
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            uchar b[8][8];
+            position.toBoard(b);
 
 			pair<CheckersNEATDatatype,int> retval = evaluateLeafHyperNEAT(b);
 
+#if DEBUG_USE_TRANSPOSITION_TABLE
+            if (useTranspositionTable)
+            {
+                transpositionTable.store(
+                    positionKey,retval.first,maxDepth-depth,
+                    CheckersTranspositionTable::BOUND_EXACT,CheckersTranspositionTable::NO_MOVE
+                    );
+            }
+#endif
+
 			if(dumpEvaluationImages)
 			{
 				for(int a=0;a<depth;a++)
@@ -1583,7 +1501,7 @@ namespace HCUBE
 
         if (depth==0)
         {
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
+            secondBestBitboardMoveToMake = bitboardMoveToMake = moveList[0];
             childBetaForSecondBestMove = (CheckersNEATDatatype)(INT_MIN/2.0);
         }
 
@@ -1599,19 +1517,26 @@ namespace HCUBE
 
         for (int a=0;a<moveListCount;a++)
         {
-            CheckersMove currentMove = totalMoveList.at(oldMoveListSize+a);
+            const CheckersBitboardMove &currentMove = moveList[a];
 
-            makeMove(currentMove,b);
+            CheckersBitboard child = position;
+            makeMove(currentMove,child,BLACK);
 
-            int winner = getWinner(b);
-
-            if (winner==BLACK)
+            if (!child.white)
             {
                 //CREATE_PAUSE("FOUND WIN FOR BLACK!");
-                reverseMove(currentMove,b);
-
                 if (depth==0)
-                    secondBestMoveToMake = moveToMake = currentMove;
+                    secondBestBitboardMoveToMake = bitboardMoveToMake = currentMove;
+
+#if DEBUG_USE_TRANSPOSITION_TABLE
+                if (useTranspositionTable)
+                {
+                    transpositionTable.store(
+                        positionKey,CheckersNEATDatatype(INT_MAX/2),maxDepth-depth,
+                        CheckersTranspositionTable::BOUND_EXACT,generatedMoveIndex(a,hashMoveIndex)
+                        );
+                }
+#endif
 
 				if(dumpEvaluationImages)
 				{
@@ -1623,23 +1548,20 @@ namespace HCUBE
 					handCodedTreeStream << "[FOUND WIN] " << (INT_MAX/2) << endl;
 				}
 
-				totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
                 return pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MAX/2),-1);
             }
 
-            childBeta = evaluatemin(b,alpha.first,depth+1,maxDepth);
-            reverseMove(currentMove,b);
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-            bStateData.insertMove(childBeta,currentMove);
-#endif
+            childBeta = searchmin(
+                child,positionHash^getMoveHash(currentMove,position,BLACK),
+                alpha.first,depth+1,maxDepth
+                );
 
 #if CHECKERS_EXPERIMENT_DEBUG
             for (int dd=0;dd<depth;dd++)
             {
                 cout << "*";
             }
-            cout << childBeta << endl;
+            cout << childBeta.first << endl;
 #endif
 
             if (childBeta.first > alpha.first)
@@ -1649,7 +1571,7 @@ namespace HCUBE
 #endif
                 if (depth==0)
                 {
-                    secondBestMoveToMake = moveToMake;
+                    secondBestBitboardMoveToMake = bitboardMoveToMake;
                     childBetaForSecondBestMove = alpha.first;
                 }
 
@@ -1659,12 +1581,11 @@ namespace HCUBE
                 {
                     //This means that this is the root max, so store the best move.
 #if CHECKERS_EXPERIMENT_DEBUG
-                    cout << "BLACK: MOVE_TO_MAKE: (" << moveList[a].from.x << ',' << moveList[a].from.y << ") -> "
-                        << "(" << moveList[a].to.x << ',' << moveList[a].to.y << ")" << endl;
+                    cout << "BLACK: MOVE_TO_MAKE: " << ((int)currentMove.from) << " -> " << ((int)currentMove.to) << endl;
                     CREATE_PAUSE("SETTING MOVE_TO_MAKE");
 #endif
 
-                    moveToMake = currentMove;
+                    bitboardMoveToMake = currentMove;
                 }
                 else
                 {
@@ -1676,23 +1597,14 @@ namespace HCUBE
 #endif
                         //parent will never choose this alpha
 
-                        //because we are ending prematurely, we have to fill the rest of the cached
-                        //data
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-                        for (int restOfList=(a+1);restOfList<moveListCount;restOfList++)
-                        {
-                            bStateData.insertMove(CheckersNEATDatatype(INT_MIN/2.0),totalMoveList.at(oldMoveListSize+restOfList));
-                        }
-
-                        if (memcmp(bState.b,b,sizeof(uchar)*8*8))
+#if DEBUG_USE_TRANSPOSITION_TABLE
+                        if (useTranspositionTable)
                         {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("BOARD STATE CHANGED SOMEHOW!");
+                            transpositionTable.store(
+                                positionKey,childBeta.first,maxDepth-depth,
+                                CheckersTranspositionTable::BOUND_LOWER,generatedMoveIndex(a,hashMoveIndex)
+                                );
                         }
-
-                        boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()].push_back(
-                            BoardStatePair(bState,bStateData)
-                            );
 #endif
 
 						if(dumpEvaluationImages)
@@ -1705,7 +1617,6 @@ namespace HCUBE
 							handCodedTreeStream << "PRUNED BECAUSE OF VALUE: " << parentBeta << endl;
 						}
 
-						totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
                         return childBeta;
                     }
                 }
@@ -1714,17 +1625,21 @@ namespace HCUBE
             {
                 if (depth==0 && childBeta.first>childBetaForSecondBestMove)
                 {
-                    secondBestMoveToMake = currentMove;
+                    secondBestBitboardMoveToMake = currentMove;
                     childBetaForSecondBestMove = childBeta.first;
                 }
             }
         }
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        ushort shortHash = bState.getShortHash();
-        boardStateLists[currentSubstrateIndex][BLACK][shortHash].push_back(
-            BoardStatePair(bState,bStateData)
-            );
+#if DEBUG_USE_TRANSPOSITION_TABLE
+        if (useTranspositionTable)
+        {
+            transpositionTable.store(
+                positionKey,alpha.first,maxDepth-depth,
+                CheckersTranspositionTable::BOUND_EXACT,
+                (bestMoveSoFarIndex>=0) ? generatedMoveIndex(bestMoveSoFarIndex,hashMoveIndex) : int(CheckersTranspositionTable::NO_MOVE)
+                );
+        }
 #endif
 
 		if(dumpEvaluationImages)
@@ -1737,23 +1652,17 @@ namespace HCUBE
 			handCodedTreeStream << "RETURNING VALUE: " << alpha.first << "/" << alpha.second << endl;
 		}
 
-        totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
         return alpha;
     }
 
-    pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemin(uchar b[8][8],  CheckersNEATDatatype parentAlpha, int depth,int maxDepth)
+    pair<CheckersNEATDatatype,int> CheckersExperiment::searchmin(
+        const CheckersBitboard &position,
+        unsigned long long positionHash,
+        CheckersNEATDatatype parentAlpha,
+        int depth,
+        int maxDepth
+        )
     {
-        if (depth==0)
-        {
-            totalMoveList.clear();
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-            cout << "Creating new outfile\n";
-            if (outfile) delete outfile;
-            outfile = new ofstream("BoardEvaluations.txt");
-#endif
-
-        }
-
         int moveListCount;
 
         pair<CheckersNEATDatatype,int> beta(CheckersNEATDatatype(INT_MAX),-1);
@@ -1761,173 +1670,53 @@ namespace HCUBE
         bool foundJump;
         int bestMoveSoFarIndex=-1;
 
-		int oldMoveListSize = (int)totalMoveList.size();
+        CheckersBitboardMove moveList[CHECKERS_MAX_BITBOARD_MOVES];
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        bool useCachedTable=false;
+#if DEBUG_USE_TRANSPOSITION_TABLE
+        //Evaluation dumps number every leaf, so they always search the whole tree
+        bool useTranspositionTable = !dumpEvaluationImages;
+        unsigned long long positionKey = positionHash^getColorHash(WHITE);
+        int hashMoveIndex=-1;
 
-        CheckersBoardState bState(b,WHITE);
-
-        if (depth==0)
-        {
-        }
-        else
-        {
-            vector<BoardStatePair> &bsVector = boardStateLists[currentSubstrateIndex][WHITE][bState.getShortHash()];
-            vector<BoardStatePair>::iterator stateIterator = bsVector.begin();
-            vector<BoardStatePair>::iterator stateEnd = bsVector.end();
-
-            for (;stateIterator != stateEnd;stateIterator++)
-            {
-                if (stateIterator->first==bState)
-                {
-                    //We have a match
-                    int depthSearched =
-                        stateIterator->second.maxDepth - stateIterator->second.depth;
-
-                    int depthToSearch = maxDepth - depth;
-
-                    if (depthSearched >= depthToSearch)
-                    {
-                        //We've been down this path before (or we are currently
-                        //going down it in another branch of the tree),
-                        //just return the best score
-                        if (stateIterator->second.getNumMoves()==0)
-                        {
-                            //No moves possible, return the worst score
-                            return CheckersNEATDatatype(INT_MAX/2.0);
-                        }
-
-                        return stateIterator->second.getLowestScore();
-                    }
-                    else
-                    {
-                        //We've been down this path before, but not to this level of detail.
-                        //Use the previous alpha values, but continue
-                        useCachedTable=true;
-
-                        moveListCount = stateIterator->second.getNumMoves();
-
-                        /* FOR evaluatemin() FUNCTION!
-                        int index=0;
-                        for(int a=(moveListCount-1);a>=0;a--)
-                        {
-                        //We have to iterate backwards because they are sorted lowest
-                        //to highest score
-                        moveList[index] = stateIterator->second.moves.getIndexData[a];
-                        index++;
-                        }
-                        */
-
-                        for (int a=0;a<moveListCount;a++)
-                        {
-                            totalMoveList.push_back(stateIterator->second.getMove(a));
-                        }
-
-                        foundJump = stateIterator->second.foundJump;
-
-                        //Erase this, because it will get replaced.
-                        bsVector.erase(stateIterator);
-
-                        //Break out of the loop so we do not keep searching
-                        //(especially because the vector has now been invalidated with
-                        //the erase)
-                        break;
-                    }
-                }
-            }
-        }
-#endif
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        if (!useCachedTable)
-#endif
-        {
-            moveListCount = generateMoveList(totalMoveList,int(totalMoveList.size()),b,WHITE,foundJump);
-        }
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        else
+        if (useTranspositionTable)
         {
-#if CHECKERS_DEBUG
-            //Run a test to cross-verify moves
-            HCUBE::CheckersMove tmpMoves[128];
-            bool tmpFoundJump;
+            const CheckersTranspositionTable::Entry *entry = transpositionTable.probe(positionKey);
 
-            int tmpMoveListCount = generateMoveList(b,tmpMoves,WHITE,tmpFoundJump);
-
-            if (moveListCount != tmpMoveListCount)
+            if (entry)
             {
-                for (int b=0;b<moveListCount;b++)
-                {
-                    cout << (int)moveList[b].from.x << ',' << (int)moveList[b].from.y << " -> ";
-                    cout << (int)moveList[b].to.x << ',' << (int)moveList[b].to.y << endl;
-                }
-
-                cout << "***" << endl;
-
-                for (int a=0;a<tmpMoveListCount;a++)
+                if (
+                    depth>0 &&
+                    entry->depth >= maxDepth-depth &&
+                    (
+                        entry->bound==CheckersTranspositionTable::BOUND_EXACT ||
+                        (entry->bound==CheckersTranspositionTable::BOUND_UPPER && entry->value <= parentAlpha)
+                    )
+                )
                 {
-                    cout << (int)tmpMoves[a].from.x << ',' << (int)tmpMoves[a].from.y << " -> ";
-                    cout << (int)tmpMoves[a].to.x << ',' << (int)tmpMoves[a].to.y << endl;
+                    //This position was already searched at least this deep
+                    return pair<CheckersNEATDatatype,int>(entry->value,-1);
                 }
 
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING NUMBER OF MOVES!");
-            }
-
-            if (foundJump != tmpFoundJump)
-            {
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING JUMP VALUE!");
-            }
-
-            for (int a=0;a<moveListCount;a++)
-            {
-                for (int b=0;b<=moveListCount;b++)
+                if (entry->bestMove != CheckersTranspositionTable::NO_MOVE)
                 {
-                    if (b==moveListCount)
-                    {
-                        cout << tmpMoves[a].from.x << ',' << tmpMoves[a].from.y << endl;
-                        cout << tmpMoves[a].to.x << ',' << tmpMoves[a].to.y << endl;
-
-                        cout << "***" << endl;
-
-                        for (int b=0;b<moveListCount;b++)
-                        {
-                            cout << moveList[b].from.x << ',' << moveList[b].from.y << endl;
-                            cout << moveList[b].to.x << ',' << moveList[b].to.y << endl;
-
-                        }
-
-                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR! MISSING A MOVE!");
-                    }
-
-                    if (moveList[b]==tmpMoves[a])
-                    {
-                        break;
-                    }
+                    hashMoveIndex = entry->bestMove;
                 }
             }
-#endif
         }
 #endif
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        //We have a movelist, let's cache it.
-        CheckersBoardStateData bStateData;
-
-        bStateData.depth = depth;
-        bStateData.maxDepth = maxDepth;
-        bStateData.foundJump = foundJump;
+        moveListCount = generateMoves(position,WHITE,moveList,foundJump);
 
-        /*
-        for(int a=0;a<moveListCount;a++)
+#if DEBUG_USE_TRANSPOSITION_TABLE
+        if (hashMoveIndex>0 && hashMoveIndex<moveListCount)
         {
-        bStateData.moves.insert(CheckersNEATDatatype(INT_MIN/2.0),moveList[a]);
+            //Search the best move from the previous search first
+            std::rotate(moveList,moveList+hashMoveIndex,moveList+hashMoveIndex+1);
+        }
+        else
+        {
+            hashMoveIndex=-1;
         }
-
-        boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()].push_back(
-        BoardStatePair(bState,bStateData)
-        );
-        */
 #endif
 
         if (!moveListCount)
@@ -1939,35 +1728,15 @@ namespace HCUBE
         if (depth==0 && moveListCount==1)
         {
             //Forced move, don't bother doing any evaluations
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            secondBestBitboardMoveToMake = bitboardMoveToMake = moveList[0];
             return pair<CheckersNEATDatatype,int>(0,-1);
         }
 
-#if 0
-        //Check for duplicate moves
-        for (int a=0;a<moveListCount;a++)
-        {
-            for (int b=0;b<moveListCount;b++)
-            {
-                if (a==b)
-                    continue;
-
-                if (moveList[a]==moveList[b])
-                {
-                    throw CREATE_LOCATEDEXCEPTION_INFO("OOPS!");
-                }
-            }
-        }
-#endif
-
 #if CHECKERS_EXPERIMENT_DEBUG
-        printBoard(b);
-        cout << "Moves for black: " << endl;
+        cout << "Moves for white: " << endl;
         for (int a=0;a<moveListCount;a++)
         {
-            cout << "MOVE: (" << ((int)moveList[a].from.x) << ',' << ((int)moveList[a].from.y) << ") -> "
-                << "(" << ((int)moveList[a].to.x) << ',' << ((int)moveList[a].to.y) << ")" << endl;
+            cout << "MOVE: " << ((int)moveList[a].from) << " -> " << ((int)moveList[a].to) << endl;
         }
         CREATE_PAUSE("Done listing moves");
 #endif
@@ -1975,9 +1744,21 @@ namespace HCUBE
         if (depth>=maxDepth && DEBUG_USE_HANDCODED_EVALUATION && foundJump==false)
         {
             //This is a leaf node, return the hand-coded evaluation
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            uchar b[8][8];
+            position.toBoard(b);
+
             pair<CheckersNEATDatatype,int> retval = evaluateLeafWhite(b);
 
+#if DEBUG_USE_TRANSPOSITION_TABLE
+            if (useTranspositionTable)
+            {
+                transpositionTable.store(
+                    positionKey,retval.first,maxDepth-depth,
+                    CheckersTranspositionTable::BOUND_EXACT,CheckersTranspositionTable::NO_MOVE
+                    );
+            }
+#endif
+
 			if(dumpEvaluationImages)
 			{
 				for(int a=0;a<depth;a++)
@@ -1995,7 +1776,7 @@ namespace HCUBE
 
         if (depth==0)
         {
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
+            secondBestBitboardMoveToMake = bitboardMoveToMake = moveList[0];
             childAlphaForSecondBestMove = (CheckersNEATDatatype)(INT_MAX/2.0);
         }
 
@@ -2011,21 +1792,26 @@ namespace HCUBE
 
         for (int a=0;a<moveListCount;a++)
         {
-            CheckersMove currentMove = totalMoveList.at(oldMoveListSize+a);
-
-            makeMove(currentMove,b);
+            const CheckersBitboardMove &currentMove = moveList[a];
 
-            int winner = getWinner(b);
+            CheckersBitboard child = position;
+            makeMove(currentMove,child,WHITE);
 
-            if (winner==WHITE)
+            if (!child.black)
             {
                 //CREATE_PAUSE("FOUND WIN FOR WHITE!");
-                reverseMove(currentMove,b);
-
                 if (depth==0)
-                    secondBestMoveToMake = moveToMake = currentMove;
+                    secondBestBitboardMoveToMake = bitboardMoveToMake = currentMove;
 
-				totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+#if DEBUG_USE_TRANSPOSITION_TABLE
+                if (useTranspositionTable)
+                {
+                    transpositionTable.store(
+                        positionKey,CheckersNEATDatatype(INT_MIN/2),maxDepth-depth,
+                        CheckersTranspositionTable::BOUND_EXACT,generatedMoveIndex(a,hashMoveIndex)
+                        );
+                }
+#endif
 
 				if(dumpEvaluationImages)
 				{
@@ -2040,19 +1826,17 @@ namespace HCUBE
 				return pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN/2),-1);
             }
 
-            childAlpha = evaluatemax(b,beta.first,depth+1,maxDepth);
-            reverseMove(currentMove,b);
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-            bStateData.insertMove(childAlpha,currentMove);
-#endif
+            childAlpha = searchmax(
+                child,positionHash^getMoveHash(currentMove,position,WHITE),
+                beta.first,depth+1,maxDepth
+                );
 
 #if CHECKERS_EXPERIMENT_DEBUG
             for (int dd=0;dd<depth;dd++)
             {
                 cout << "*";
             }
-            cout << childAlpha << endl;
+            cout << childAlpha.first << endl;
 #endif
 
             if (childAlpha.first < beta.first)
@@ -2063,7 +1847,7 @@ namespace HCUBE
                 if (depth==0)
                 {
                     //Set the second best move to the old best move
-                    secondBestMoveToMake = moveToMake;
+                    secondBestBitboardMoveToMake = bitboardMoveToMake;
                     childAlphaForSecondBestMove = beta.first;
                 }
 
@@ -2073,12 +1857,11 @@ namespace HCUBE
                 {
                     //This means that this is the root max, so store the best move.
 #if CHECKERS_EXPERIMENT_DEBUG
-                    cout << "WHITE: MOVE_TO_MAKE: (" << moveList[a].from.x << ',' << moveList[a].from.y << ") -> "
-                        << "(" << moveList[a].to.x << ',' << moveList[a].to.y << ")" << endl;
+                    cout << "WHITE: MOVE_TO_MAKE: " << ((int)currentMove.from) << " -> " << ((int)currentMove.to) << endl;
                     CREATE_PAUSE("SETTING MOVE_TO_MAKE");
 #endif
 
-                    moveToMake = currentMove;
+                    bitboardMoveToMake = currentMove;
                 }
                 else
                 {
@@ -2090,23 +1873,14 @@ namespace HCUBE
 #endif
                         //parent will never choose this alpha
 
-                        //because we are ending prematurely, we have to fill the rest of the cached
-                        //data
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-                        for (int restOfList=(a+1);restOfList<moveListCount;restOfList++)
-                        {
-                            bStateData.insertMove(CheckersNEATDatatype(INT_MAX/2.0),totalMoveList.at(oldMoveListSize+restOfList));
-                        }
-
-                        if (memcmp(bState.b,b,sizeof(uchar)*8*8))
+#if DEBUG_USE_TRANSPOSITION_TABLE
+                        if (useTranspositionTable)
                         {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("BOARD STATE CHANGED SOMEHOW!");
+                            transpositionTable.store(
+                                positionKey,childAlpha.first,maxDepth-depth,
+                                CheckersTranspositionTable::BOUND_UPPER,generatedMoveIndex(a,hashMoveIndex)
+                                );
                         }
-
-                        boardStateLists[currentSubstrateIndex][WHITE][bState.getShortHash()].push_back(
-                            BoardStatePair(bState,bStateData)
-                            );
 #endif
 
 						if(dumpEvaluationImages)
@@ -2119,7 +1893,6 @@ namespace HCUBE
 							handCodedTreeStream << "PRUNED BECAUSE OF VALUE: " << parentAlpha << endl;
 						}
 
-						totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
                         return beta;
                     }
                 }
@@ -2128,17 +1901,21 @@ namespace HCUBE
             {
                 if (depth==0 && childAlpha.first<childAlphaForSecondBestMove)
                 {
-                    secondBestMoveToMake = currentMove;
+                    secondBestBitboardMoveToMake = currentMove;
                     childAlphaForSecondBestMove = childAlpha.first;
                 }
             }
         }
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        ushort shortHash = bState.getShortHash();
-        boardStateLists[currentSubstrateIndex][WHITE][shortHash].push_back(
-            BoardStatePair(bState,bStateData)
-            );
+#if DEBUG_USE_TRANSPOSITION_TABLE
+        if (useTranspositionTable)
+        {
+            transpositionTable.store(
+                positionKey,beta.first,maxDepth-depth,
+                CheckersTranspositionTable::BOUND_EXACT,
+                (bestMoveSoFarIndex>=0) ? generatedMoveIndex(bestMoveSoFarIndex,hashMoveIndex) : int(CheckersTranspositionTable::NO_MOVE)
+                );
+        }
 #endif
 
 		if(dumpEvaluationImages)
@@ -2151,7 +1928,6 @@ namespace HCUBE
 			handCodedTreeStream << "RETURNING VALUE: " << beta.first << "/" << beta.second << endl;
 		}
 
-        totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
         return beta;
     }
 
@@ -2161,32 +1937,6 @@ namespace HCUBE
         double timeLimit
         )
     {
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        /*
-        for(int a=0;a<65536;a++)
-        {
-        boardStateLists[currentSubstrateIndex][BLACK][a].clear();
-        }
-        for(int a=0;a<65536;a++)
-        {
-        boardStateLists[currentSubstrateIndex][WHITE][a].clear();
-        }
-        */
-
-        int useOdd = maxDepth%2;
-        CheckersNEATDatatype retval;
-        timer t;
-        for (int a=2-useOdd;;a+=2)
-        {
-            retval = evaluatemax(b,CheckersNEATDatatype(INT_MAX/2.0),0,a);
-
-            if (a+2>maxDepth || t.elapsed()>timeLimit)
-            {
-                //cout << "Ran to depth " << a << " (" << t.elapsed() << " sec.)" << endl;
-                return retval;
-            }
-        }
-#else
         numHyperNEATEvaluations=0;
 		if(dumpEvaluationImages)
 		{
@@ -2196,7 +1946,26 @@ namespace HCUBE
 			hyperNEATTreeStream.open(filename2.c_str());
 		}
 
-		pair<CheckersNEATDatatype,int> retval = evaluatemax(b,CheckersNEATDatatype(INT_MAX/2),0,maxDepth);
+		pair<CheckersNEATDatatype,int> retval;
+
+#if DEBUG_DO_ITERATIVE_DEEPENING
+        //Each pass leaves its best moves in the transposition table, so the next
+        //(deeper) pass searches them first.  The depth keeps the parity of
+        //maxDepth so the leaves are always evaluated for the same player.
+        int searchDepth = dumpEvaluationImages ? maxDepth : (2-(maxDepth%2));
+        timer t;
+        for (;;searchDepth+=2)
+        {
+            retval = evaluatemax(b,CheckersNEATDatatype(INT_MAX/2),0,searchDepth);
+
+            if (searchDepth+2>maxDepth || t.elapsed()>timeLimit)
+            {
+                break;
+            }
+        }
+#else
+		retval = evaluatemax(b,CheckersNEATDatatype(INT_MAX/2),0,maxDepth);
+#endif
 
 		if(dumpEvaluationImages)
 		{
@@ -2205,7 +1974,6 @@ namespace HCUBE
 		}
 
         return retval;
-#endif
     }
 
     CheckersNEATDatatype CheckersExperiment::firstevaluatemin(
@@ -2214,32 +1982,6 @@ namespace HCUBE
         double timeLimit
         )
     {
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        /*
-        for(int a=0;a<65536;a++)
-        {
-        boardStateLists[currentSubstrateIndex][BLACK][a].clear();
-        }
-        for(int a=0;a<65536;a++)
-        {
-        boardStateLists[currentSubstrateIndex][WHITE][a].clear();
-        }
-        */
-
-        int useOdd = ((maxDepth)%2);
-        CheckersNEATDatatype retval;
-        timer t;
-        for (int a=2-useOdd;;a+=2)
-        {
-            retval = evaluatemin(b,CheckersNEATDatatype(INT_MIN/2.0),0,a);
-
-            if (a+2>maxDepth || t.elapsed()>timeLimit)
-            {
-                //cout << "Ran to depth " << a << " (" << t.elapsed() << " sec.)" << endl;
-                return retval;
-            }
-        }
-#else
 		if(dumpEvaluationImages)
 		{
 			numHandCodedEvaluations=0;
@@ -2249,7 +1991,23 @@ namespace HCUBE
 			handCodedTreeStream.open(filename2.c_str());
 		}
 
-        CheckersNEATDatatype retval = evaluatemin(b,INT_MIN/2,0,maxDepth).first;
+        CheckersNEATDatatype retval;
+
+#if DEBUG_DO_ITERATIVE_DEEPENING
+        int searchDepth = dumpEvaluationImages ? maxDepth : (2-(maxDepth%2));
+        timer t;
+        for (;;searchDepth+=2)
+        {
+            retval = evaluatemin(b,CheckersNEATDatatype(INT_MIN/2),0,searchDepth).first;
+
+            if (searchDepth+2>maxDepth || t.elapsed()>timeLimit)
+            {
+                break;
+            }
+        }
+#else
+        retval = evaluatemin(b,INT_MIN/2,0,maxDepth).first;
+#endif
 
 		if(dumpEvaluationImages)
 		{
@@ -2259,7 +2017,6 @@ namespace HCUBE
 		}
 
 		return retval;
-#endif
     }
 
     void CheckersExperiment::makeMoveCliche(uchar b[8][8],int colorToMove,int* retval)
@@ -2272,7 +2029,7 @@ namespace HCUBE
         DEBUG_USE_HYPERNEAT_EVALUATION = 0;
         currentSubstrateIndex=handCodedAISubstrateIndex;
 
-	    boost::mutex::scoped_lock lock(cakeMutex);
+	    boost::mutex::scoped_lock lock(clicheMutex);
 
         cout << "CLICHE BEFORE\n";
 	    printBoard(b);
@@ -2358,8 +2115,8 @@ namespace HCUBE
 		currentSubstrateIndex=handCodedAISubstrateIndex;
 
 
-		boost::mutex::scoped_lock lock(cakeMutex);
-		srand(cakeRandomSeed);
+		searchInfo.context = cakeContext.get();
+		searchInfo.context->randomseed = cakeRandomSeed;
 
         //cout << "CAKE BEFORE\n";
 		//printBoard(b);
@@ -2454,41 +2211,8 @@ namespace HCUBE
             for (currentRound=0;currentRound<CHECKERS_MAX_ROUNDS&&retval==-1;currentRound++)
             {
 #if 1
-				//Clear the evaluation cache
-				for (int a=0;a<65536;a++)
-				{
-					boardEvaluationCaches[0][a].clear();
-					boardEvaluationCaches[0][a].reserve(0);
-				}
-				//Clear the state list caches
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[0][BLACK][a].clear();
-					boardStateLists[0][BLACK][a].reserve(0);
-				}
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[0][WHITE][a].clear();
-					boardStateLists[0][WHITE][a].reserve(0);
-				}
-
-				//Clear the evaluation cache
-				for (int a=0;a<65536;a++)
-				{
-					boardEvaluationCaches[1][a].clear();
-					boardEvaluationCaches[1][a].reserve(0);
-				}
-				//Clear the state list caches
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[1][BLACK][a].clear();
-					boardStateLists[1][BLACK][a].reserve(0);
-				}
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[1][WHITE][a].clear();
-					boardStateLists[1][WHITE][a].reserve(0);
-				}
+				//The transposition table is kept between rounds, the positions
+				//searched for the last move are mostly still reachable
 
                 //cout << "Round: " << currentRound << endl;
                 moveToMake = CheckersMove();
@@ -2578,7 +2302,7 @@ namespace HCUBE
                         DEBUG_USE_HYPERNEAT_EVALUATION = 0;
                         currentSubstrateIndex=handCodedAISubstrateIndex;
 
-						boost::mutex::scoped_lock lock(cakeMutex);
+						boost::mutex::scoped_lock lock(clicheMutex);
 						//printBoard(b);
 						//Play with cake
 						char output[255];
@@ -79,38 +79,15 @@ namespace HCUBE
         }
         CheckersNEATDatatype output;
 
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-        tmpboard.loadBoard(b);
-        ushort hashVal = tmpboard.getShortHash();
-
-        BoardCacheList::iterator bIterator =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].begin();
-        BoardCacheList::iterator bEnd =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].end();
-
-        for (;bIterator != bEnd;bIterator++)
-        {
-            if (bIterator->first == tmpboard)
-            {
-                //We have a match!
-                break;
-            }
-        }
-
-        if (bIterator != bEnd)
-        {
-            output = bIterator->second;
-        }
-        else
-#endif
+        //Leaf values are cached by the transposition table in evaluatemax
         {
 
             network->reinitialize();
             network->dummyActivation();
 
-            if (network->hasNode("Bias"))
+            if (biasNodeIndex[currentSubstrateIndex]>=0)
             {
-                network->setValue("Bias",(CheckersNEATDatatype)0.3);
+                network->setValue(biasNodeIndex[currentSubstrateIndex],(CheckersNEATDatatype)0.3);
             }
 
             for (int y=0;y<numNodesY[0];y++)
@@ -130,11 +107,11 @@ namespace HCUBE
                         //cout << "FOUND WHITE\n";
                         if ( (b[boardx][boardy]&KING) )
                         {
-                            network->setValue( getNameFromNode(Node(x,y,0)) , -0.75 );
+                            network->setValue( boardNodeIndex[currentSubstrateIndex][x][y] , -0.75 );
                         }
                         else if ( (b[boardx][boardy]&MAN) )
                         {
-                            network->setValue( getNameFromNode(Node(x,y,0)) , -0.5 );
+                            network->setValue( boardNodeIndex[currentSubstrateIndex][x][y] , -0.5 );
                         }
                         else
                         {
@@ -146,11 +123,11 @@ namespace HCUBE
                         //cout << "FOUND BLACK\n";
                         if ( (b[boardx][boardy]&KING) )
                         {
-							network->setValue( getNameFromNode(Node(x,y,0)) , 0.75 );
+							network->setValue( boardNodeIndex[currentSubstrateIndex][x][y] , 0.75 );
                         }
                         else if ( (b[boardx][boardy]&MAN) )
                         {
-                            network->setValue( getNameFromNode(Node(x,y,0)) , 0.5 );
+                            network->setValue( boardNodeIndex[currentSubstrateIndex][x][y] , 0.5 );
                         }
                         else
                         {
@@ -160,14 +137,14 @@ namespace HCUBE
                     else
                     {
                         //cout << "FOUND NOTHING\n";
-                        network->setValue( getNameFromNode(Node(x,y,0)) , 0.0 );
+                        network->setValue( boardNodeIndex[currentSubstrateIndex][x][y] , 0.0 );
                     }
 
                 }
             }
 
             network->updateFixedIterations(2);
-            output = network->getValue(getNameFromNode(Node(0,0,2)));
+            output = network->getValue(outputNodeIndex[currentSubstrateIndex]);
 
 #if CHECKERS_EXPERIMENT_DEBUG
             static CheckersNEATDatatype prevOutput;
@@ -179,15 +156,6 @@ namespace HCUBE
                 CREATE_PAUSE("");
             }
 #endif
-
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-            if (boardEvaluationCaches[currentSubstrateIndex][hashVal].size()<10000)
-            {
-                boardEvaluationCaches[currentSubstrateIndex][hashVal].push_back(
-                    BoardCachePair(tmpboard,output)
-                    );
-            }
-#endif
         }
 
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
@@ -279,6 +247,8 @@ namespace HCUBE
         int substrateNum
     )
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         if (substrateIndividuals[substrateNum]==individual)
         {
             //Don't bother remaking the same substrate
@@ -287,23 +257,35 @@ namespace HCUBE
 
         substrateIndividuals[substrateNum]=individual;
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
+        clearTranspositionTable();
+
+        networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
+
+        if (networks[substrateNum].hasNode("Bias"))
         {
-            boardEvaluationCaches[substrateNum][a].clear();
+            biasNodeIndex[substrateNum] = networks[substrateNum].getNodeIndex("Bias");
         }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
+        else
         {
-            boardStateLists[substrateNum][BLACK][a].clear();
+            biasNodeIndex[substrateNum] = -1;
         }
-        for (int a=0;a<65536;a++)
+
+        for (int y=0;y<numNodesY[0];y++)
         {
-            boardStateLists[substrateNum][WHITE][a].clear();
+            for (int x=0;x<numNodesX[0];x++)
+            {
+                if ( (x+y)%2==1 ) //ignore empty squares.
+                {
+                    boardNodeIndex[substrateNum][x][y] = -1;
+                    continue;
+                }
+
+                boardNodeIndex[substrateNum][x][y] =
+                    networks[substrateNum].getNodeIndex( getNameFromNode(Node(x,y,0)) );
+            }
         }
 
-        networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
+        outputNodeIndex[substrateNum] = networks[substrateNum].getNodeIndex( getNameFromNode(Node(0,0,2)) );
     }
 
     Experiment* CheckersExperimentNoGeom::clone()
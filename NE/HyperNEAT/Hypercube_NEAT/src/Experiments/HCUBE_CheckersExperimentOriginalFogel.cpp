@@ -167,6 +167,8 @@ namespace HCUBE
         int substrateNum
     )
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         if (substrateIndividuals[substrateNum]==individual)
         {
             //Don't bother remaking the same substrate
@@ -175,23 +177,33 @@ namespace HCUBE
 
         substrateIndividuals[substrateNum]=individual;
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
+        clearTranspositionTable();
+
+        networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
+
+        if (networks[substrateNum].hasNode("Bias"))
         {
-            boardEvaluationCaches[substrateNum][a].clear();
+            biasNodeIndex[substrateNum] = networks[substrateNum].getNodeIndex("Bias");
         }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
+        else
         {
-            boardStateLists[substrateNum][BLACK][a].clear();
+            biasNodeIndex[substrateNum] = -1;
         }
-        for (int a=0;a<65536;a++)
+
+        for (int size=3;size<=8;size++)
         {
-            boardStateLists[substrateNum][WHITE][a].clear();
+            for (int x=0;x<=8-size;x++)
+            {
+                for (int y=0;y<=8-size;y++)
+                {
+                    string nodeName = string("Input_") + toString(size) + string("x") + toString(size)
+                                      + string("_") + toString(x) + string("_") + toString(y);
+                    inputNodeIndex[substrateNum][size-3][x][y] = networks[substrateNum].getNodeIndex(nodeName);
+                }
+            }
         }
 
-        networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
+        outputNodeIndex[substrateNum] = networks[substrateNum].getNodeIndex(getNameFromNode(Node(0,0,2)));
     }
 
     pair<CheckersNEATDatatype,int> CheckersExperimentOriginalFogel::evaluateLeafHyperNEAT(uchar b[8][8])
@@ -208,9 +220,9 @@ namespace HCUBE
 
         substrate->reinitialize();
 
-        if (substrate->hasNode("Bias"))
+        if (biasNodeIndex[currentSubstrateIndex]>=0)
         {
-            substrate->setValue("Bias",(CheckersNEATDatatype)0.3);
+            substrate->setValue(biasNodeIndex[currentSubstrateIndex],(CheckersNEATDatatype)0.3);
         }
 
         for (int x=0;x<8;x++)
@@ -219,44 +231,38 @@ namespace HCUBE
             {
                 if (x<6&&y<6)
                 {
-                    string nodeName = string("Input_3x3_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,3,3));
+                    substrate->setValue(inputNodeIndex[currentSubstrateIndex][0][x][y],getSpatialInput(b,x,y,3,3));
                 }
 
                 if (x<5&&y<5)
                 {
-                    string nodeName = string("Input_4x4_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,4,4));
+                    substrate->setValue(inputNodeIndex[currentSubstrateIndex][1][x][y],getSpatialInput(b,x,y,4,4));
                 }
 
                 if (x<4&&y<4)
                 {
-                    string nodeName = string("Input_5x5_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,5,5));
+                    substrate->setValue(inputNodeIndex[currentSubstrateIndex][2][x][y],getSpatialInput(b,x,y,5,5));
                 }
 
                 if (x<3&&y<3)
                 {
-                    string nodeName = string("Input_6x6_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,6,6));
+                    substrate->setValue(inputNodeIndex[currentSubstrateIndex][3][x][y],getSpatialInput(b,x,y,6,6));
                 }
 
                 if (x<2&&y<2)
                 {
-                    string nodeName = string("Input_7x7_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,7,7));
+                    substrate->setValue(inputNodeIndex[currentSubstrateIndex][4][x][y],getSpatialInput(b,x,y,7,7));
                 }
 
                 if (x<1&&y<1)
                 {
-                    string nodeName = string("Input_8x8_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,8,8));
+                    substrate->setValue(inputNodeIndex[currentSubstrateIndex][5][x][y],getSpatialInput(b,x,y,8,8));
                 }
             }
         }
 
         substrate->update();
-        double output = substrate->getValue(getNameFromNode(Node(0,0,2)));
+        double output = substrate->getValue(outputNodeIndex[currentSubstrateIndex]);
 
         static double prevOutput;
 
@@ -98,6 +98,8 @@ namespace HCUBE
         int substrateNum
     )
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         if (substrateIndividuals[substrateNum]==individual)
         {
             //Don't bother remaking the same substrate
@@ -106,21 +108,7 @@ namespace HCUBE
 
         substrateIndividuals[substrateNum]=individual;
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
-        {
-            boardEvaluationCaches[substrateNum][a].clear();
-        }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][BLACK][a].clear();
-        }
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][WHITE][a].clear();
-        }
+        clearTranspositionTable();
 
         networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
     }
@@ -37,8 +37,6 @@ namespace HCUBE
             substrateBaseX(0),
             substrateBaseY(0)
     {
-        //boardEvaluationCaches[0].reserve(10000);
-        //boardEvaluationCaches[1].reserve(10000);
 
         mininumNodesX[0] = mininumNodesY[0] = 3;
         mininumNodesX[1] = mininumNodesY[1] = 1;
@@ -329,8 +327,7 @@ namespace HCUBE
 
         minisubstrate = &minisubstrates[substrateNum];
 
-        //Clear the evaluation cache
-        //boardEvaluationCaches[substrateNum].clear();
+        clearTranspositionTable();
 
 
         NEAT::FastNetwork<CheckersNEATDatatype> network = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
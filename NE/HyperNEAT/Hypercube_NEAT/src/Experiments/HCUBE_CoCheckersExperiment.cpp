@@ -327,6 +327,13 @@ namespace HCUBE
         return experiment;
     }
 
+    NEAT::CoEvoExperiment* CoCheckersExperiment::cloneCoEvoExperiment()
+    {
+        CoCheckersExperiment* experiment = new CoCheckersExperiment(*this);
+
+        return experiment;
+    }
+
     void CoCheckersExperiment::addGenerationData(
         shared_ptr<NEAT::GeneticGeneration> generation,
         shared_ptr<NEAT::GeneticIndividual> individual
@@ -8,6 +8,9 @@
 
 #define FIND_CLUSTER_SHOW_EXPRESSED_LINK_COUNT (0)
 
+//Number of placements evaluated together by processQueuedEvaluations
+#define FIND_CLUSTER_EVALUATION_BATCH_SIZE (128)
+
 namespace HCUBE
 {
     using namespace NEAT;
@@ -183,6 +186,17 @@ namespace HCUBE
         */
         cout << "done!\n";
 
+        inputNodeIndices.resize(numNodesX*numNodesY);
+        outputNodeIndices.resize(numNodesX*numNodesY);
+        for (int y1=0;y1<numNodesY;y1++)
+        {
+            for (int x1=0;x1<numNodesX;x1++)
+            {
+                inputNodeIndices[y1*numNodesX+x1] = substrate.getNodeIndex(nameLookup[Node(y1,x1,0)]);
+                outputNodeIndices[y1*numNodesX+x1] = substrate.getNodeIndex(nameLookup[Node(y1,x1,1)]);
+            }
+        }
+
         for (int a=0;a<nodeCounter;a++)
         {
             nodes[a].~NetworkNode();
@@ -199,6 +213,8 @@ namespace HCUBE
 
     void FindClusterExperiment::populateSubstrate(shared_ptr<NEAT::GeneticIndividual> individual)
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
 #if FIND_CLUSTER_SHOW_EXPRESSED_LINK_COUNT
         cout << "Populating substrate...";
 #endif
@@ -351,34 +367,7 @@ namespace HCUBE
 
         double filledValue;
 
-        if (sizeMultiplier==1)
-        {
-            smallRadius=0;
-            bigRadius=1;
-            filledValue=1.0;
-        }
-        else if (sizeMultiplier==3)
-        {
-            smallRadius=1;
-            bigRadius=4;
-            filledValue= (11.0/33.0)*(11.0/33.0);
-        }
-        else if (sizeMultiplier==5)
-        {
-            smallRadius=2;
-            bigRadius=7;
-            filledValue= (11.0/55.0)*(11.0/55.0);
-        }
-        else if (sizeMultiplier==9)
-        {
-            smallRadius=4;
-            bigRadius=13;
-            filledValue= (11.0/66.0)*(11.0/66.0);
-        }
-        else
-        {
-            throw CREATE_LOCATEDEXCEPTION_INFO("Unsupported size multiplier!");
-        }
+        getObjectSizes(smallRadius,bigRadius,filledValue);
 
         for (int mody=-1*smallRadius;mody<=1*smallRadius;mody++)
             for (int modx=-1*smallRadius;modx<=1*smallRadius;modx++)
@@ -770,6 +759,179 @@ namespace HCUBE
         return max(0,30- ( (largestx-x1Big)*(largestx-x1Big) + (largesty-y1Big)*(largesty-y1Big) ) );
     }
 
+    void FindClusterExperiment::getObjectSizes(int &smallRadius,int &bigRadius,double &filledValue)
+    {
+        if (sizeMultiplier==1)
+        {
+            smallRadius=0;
+            bigRadius=1;
+            filledValue=1.0;
+        }
+        else if (sizeMultiplier==3)
+        {
+            smallRadius=1;
+            bigRadius=4;
+            filledValue= (11.0/33.0)*(11.0/33.0);
+        }
+        else if (sizeMultiplier==5)
+        {
+            smallRadius=2;
+            bigRadius=7;
+            filledValue= (11.0/55.0)*(11.0/55.0);
+        }
+        else if (sizeMultiplier==9)
+        {
+            smallRadius=4;
+            bigRadius=13;
+            filledValue= (11.0/66.0)*(11.0/66.0);
+        }
+        else
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Unsupported size multiplier!");
+        }
+    }
+
+    void FindClusterExperiment::setQueuedObject(
+        const Vector2<int> &position,
+        int radius,
+        double filledValue,
+        int pattern,
+        int batchSize
+    )
+    {
+        for (int mody=-1*radius;mody<=1*radius;mody++)
+            for (int modx=-1*radius;modx<=1*radius;modx++)
+            {
+                int tmpy = position.y+mody;
+                int tmpx = position.x+modx;
+
+                if (tmpy<0||tmpy>=numNodesY||tmpx<0||tmpx>=numNodesX)
+                {
+                    cout << "INVALID LOCATION: " << (tmpy-numNodesY/2) << ',' << (tmpx-numNodesX/2) << endl;
+                    continue;
+                }
+
+                batchValues[size_t(inputNodeIndices[tmpy*numNodesX+tmpx])*batchSize+pattern] = filledValue;
+            }
+    }
+
+    double FindClusterExperiment::queueEvaluation(
+        shared_ptr<NEAT::GeneticIndividual> individual,
+        int x1,
+        int y1,
+        int x1Big,
+        int y1Big
+    )
+    {
+        queuedSmallPositions.push_back(Vector2<int>(x1,y1));
+        queuedBigPositions.push_back(Vector2<int>(x1Big,y1Big));
+
+        if ((int)queuedSmallPositions.size()<FIND_CLUSTER_EVALUATION_BATCH_SIZE)
+        {
+            return 0;
+        }
+
+        return processQueuedEvaluations(individual);
+    }
+
+    double FindClusterExperiment::processQueuedEvaluations(shared_ptr<NEAT::GeneticIndividual> individual)
+    {
+        int batchSize = int(queuedSmallPositions.size());
+
+        if (!batchSize)
+        {
+            return 0;
+        }
+
+        int smallRadius;
+        int bigRadius;
+
+        double filledValue;
+
+        getObjectSizes(smallRadius,bigRadius,filledValue);
+
+        //The batched equivalent of reinitialize() and setValue() on each input
+        batchValues.assign(size_t(substrate.getNodeCount())*batchSize,0.0);
+
+        for (int b=0;b<batchSize;b++)
+        {
+            setQueuedObject(queuedSmallPositions[b],smallRadius,filledValue,b,batchSize);
+            setQueuedObject(queuedBigPositions[b],bigRadius,filledValue,b,batchSize);
+        }
+
+        //dummyActivation() and updateFixedIterations(1) for every placement
+        substrate.updateBatchFixedIterations(&batchValues[0],batchSize,1);
+
+        bool keepStats = individual->getUserData().length()>0;
+        FindClusterStats stats;
+        if (keepStats)
+        {
+            stats = FindClusterStats(individual->getUserData());
+        }
+
+        double fitness=0;
+
+        for (int b=0;b<batchSize;b++)
+        {
+            double largestValue = -INT_MAX;
+            int largesty,largestx;
+
+            for (int y2=0;y2<numNodesY;y2++)
+            {
+                for (int x2=0;x2<numNodesX;x2++)
+                {
+                    double value = batchValues[size_t(outputNodeIndices[y2*numNodesX+x2])*batchSize+b];
+
+                    if (value > largestValue)
+                    {
+                        largestValue = value;
+                        largestx = x2;
+                        largesty = y2;
+                    }
+                }
+            }
+
+            int x1 = queuedSmallPositions[b].x;
+            int y1 = queuedSmallPositions[b].y;
+            int x1Big = queuedBigPositions[b].x;
+            int y1Big = queuedBigPositions[b].y;
+
+            if (keepStats)
+            {
+                Vector2<double> baitVec(
+                    (x1-numNodesX/2)/double((numNodesX-1)/2),
+                    (y1-numNodesY/2)/double((numNodesY-1)/2)
+                );
+                Vector2<double> targetVec(
+                    (x1Big-numNodesX/2)/double((numNodesX-1)/2),
+                    (y1Big-numNodesY/2)/double((numNodesY-1)/2)
+                );
+                Vector2<double> actualVec(
+                    (largestx-numNodesX/2)/double((numNodesX-1)/2),
+                    (largesty-numNodesY/2)/double((numNodesY-1)/2)
+                );
+
+                stats.addStat(
+                    baitVec,
+                    targetVec,
+                    actualVec
+                );
+            }
+
+            fitness += max(0,30- ( (largestx-x1Big)*(largestx-x1Big) + (largesty-y1Big)*(largesty-y1Big) ) );
+        }
+
+        if (keepStats)
+        {
+            individual->setUserData(stats.toString());
+        }
+
+        queuedSmallPositions.clear();
+        queuedBigPositions.clear();
+
+        return fitness;
+    }
+
     void FindClusterExperiment::processGroup(shared_ptr<NEAT::GeneticGeneration> generation)
     {
         shared_ptr<NEAT::GeneticIndividual> individual = group.front();
@@ -809,7 +971,7 @@ namespace HCUBE
 
                 if (x1>0&&x1+1<numNodesX)
                 {
-                    fitness += processEvaluation(individual,NULL,x1,y1,x1,y1Big);
+                    fitness += queueEvaluation(individual,x1,y1,x1,y1Big);
                     maxFitness += 30;
 #if FIND_CLUSTER_EXPERIMENT_DEBUG
                     cout << "Testing " << x1 << ',' << y1 << " and big " << x1 << ',' << y1Big << "\n";
@@ -824,7 +986,7 @@ namespace HCUBE
 
                 if (y1>0&&y1+1<numNodesY)
                 {
-                    fitness += processEvaluation(individual,NULL,x1,y1,x1Big,y1);
+                    fitness += queueEvaluation(individual,x1,y1,x1Big,y1);
                     maxFitness += 30;
 #if FIND_CLUSTER_EXPERIMENT_DEBUG
                     cout << "Testing " << x1 << ',' << y1 << " and big " << x1Big << ',' << y1 << "\n";
@@ -837,7 +999,7 @@ namespace HCUBE
 #endif
                 }
 
-                fitness += processEvaluation(individual,NULL,x1,y1,x1Big,y1Big);
+                fitness += queueEvaluation(individual,x1,y1,x1Big,y1Big);
 #if FIND_CLUSTER_EXPERIMENT_DEBUG
                 cout << "Testing " << x1 << ',' << y1 << " and big " << x1Big << ',' << y1Big << "\n";
 #endif
@@ -849,6 +1011,8 @@ namespace HCUBE
             }
         }
 
+        fitness += processQueuedEvaluations(individual);
+
         //cout << "Individual Evaluation complete!\n";
 
         //cout << maxFitness << endl;
@@ -949,7 +1113,7 @@ namespace HCUBE
 
                         testCases++;
 
-                        fitness += processEvaluation(individual,NULL,x1,y1,x1Big,y1Big);
+                        fitness += queueEvaluation(individual,x1,y1,x1Big,y1Big);
 
                         maxFitness += 30;
 
@@ -958,6 +1122,8 @@ namespace HCUBE
             }
         }
 
+        fitness += processQueuedEvaluations(individual);
+
         cout << "TOTAL TEST CASES: " << testCases << endl;
 
         //cout << "Individual Evaluation complete!\n";
@@ -133,6 +133,8 @@ namespace HCUBE
     }
     void FindClusterNoGeomExperiment::populateSubstrate(shared_ptr<NEAT::GeneticIndividual> individual)
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         NEAT::FastNetwork<double> network = individual->spawnFastPhenotypeStack<double>();
         int counter=0;
         double x1Val,y1Val,x2Val,y2Val;
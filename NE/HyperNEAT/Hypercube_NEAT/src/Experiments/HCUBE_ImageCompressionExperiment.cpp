@@ -146,6 +146,8 @@ namespace HCUBE
 		shared_ptr<NEAT::GeneticIndividual> individual
 		)
 	{
+		NEAT_PROFILE_SCOPE("substratePopulation");
+
 		if (substrateIndividual==individual)
 		{
 			//Don't bother remaking the same substrate
@@ -161,12 +163,36 @@ namespace HCUBE
 		Pixel biggestSpread;
 		biggestSpread.r = biggestSpread.g = biggestSpread.b = 0;
 
+		int xIndex = network.getNodeIndex("X");
+		int yIndex = network.getNodeIndex("Y");
+		int biasIndex = network.hasNode("Bias") ? network.getNodeIndex("Bias") : -1;
+		int redIndex = network.getNodeIndex("Output_1R");
+		int greenIndex = network.getNodeIndex("Output_1G");
+		int blueIndex = network.getNodeIndex("Output_1B");
+
+		//Each row of pixels is one updateBatch call, laid out node-major
+		vector<float> batchValues;
+
 		for (int y=0;y<numNodesY;y++)
 		{
+			/*Remap the nodes to the [-1,1] domain*/
+			float ynormal;
+
+			if (numNodesY>1)
+			{
+				ynormal = -1.0 + (float(y)/(numNodesY-1))*2.0;
+			}
+			else
+			{
+				ynormal = 0.0;
+			}
+
+			//Zeroing the batch is the reinitialize() of every pixel
+			batchValues.assign(size_t(network.getNodeCount())*numNodesX,0.0f);
+
 			for (int x=0;x<numNodesX;x++)
 			{
-				/*Remap the nodes to the [-1,1] domain*/
-				float xnormal,ynormal;
+				float xnormal;
 
 				if (numNodesX>1)
 				{
@@ -177,36 +203,29 @@ namespace HCUBE
 					xnormal = 0.0;
 				}
 
-				if (numNodesY>1)
-				{
-					ynormal = -1.0 + (float(y)/(numNodesY-1))*2.0;
-				}
-				else
-				{
-					ynormal = 0.0;
-				}
+				batchValues[size_t(xIndex)*numNodesX+x] = xnormal;
+				batchValues[size_t(yIndex)*numNodesX+x] = ynormal;
 
-				network.reinitialize();
-				network.setValue("X",xnormal);
-				network.setValue("Y",ynormal);
-
-				if(network.hasNode("Bias"))
+				if(biasIndex>=0)
 				{
-					network.setValue("Bias",(float)0.3);
+					batchValues[size_t(biasIndex)*numNodesX+x] = (float)0.3;
 				}
+			}
 
-				network.update();
+			network.updateBatch(&batchValues[0],numNodesX);
 
+			for (int x=0;x<numNodesX;x++)
+			{
 				{
-					float unsignedVal = (network.getValue("Output_1R")+1.0)/2.0;
+					float unsignedVal = (batchValues[size_t(redIndex)*numNodesX+x]+1.0)/2.0;
 					tmpimage[y][x].r = smallest.r + unsignedVal*(spread.r);
 				}
 				{
-					float unsignedVal = (network.getValue("Output_1G")+1.0)/2.0;
+					float unsignedVal = (batchValues[size_t(greenIndex)*numNodesX+x]+1.0)/2.0;
 					tmpimage[y][x].g = smallest.g + unsignedVal*(spread.g);
 				}
 				{
-					float unsignedVal = (network.getValue("Output_1B")+1.0)/2.0;
+					float unsignedVal = (batchValues[size_t(blueIndex)*numNodesX+x]+1.0)/2.0;
 					tmpimage[y][x].b = smallest.b + unsignedVal*(spread.b);
 				}
 				//tmpimage[y][x].a = 128 + int(network.getValue("Output_1A")*128);
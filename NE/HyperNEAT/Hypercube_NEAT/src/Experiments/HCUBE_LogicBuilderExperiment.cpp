@@ -67,6 +67,8 @@ namespace HCUBE
 		shared_ptr<NEAT::GeneticIndividual> individual
 		)
 	{
+		NEAT_PROFILE_SCOPE("substratePopulation");
+
 		if (substrateIndividual==individual)
 		{
 			//Don't bother remaking the same substrate
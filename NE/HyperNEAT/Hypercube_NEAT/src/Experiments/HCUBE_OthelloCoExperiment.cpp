@@ -321,6 +321,13 @@ namespace HCUBE
 
         return experiment;
     }
+
+    NEAT::CoEvoExperiment* OthelloCoExperiment::cloneCoEvoExperiment()
+    {
+        OthelloCoExperiment* experiment = new OthelloCoExperiment(*this);
+
+        return experiment;
+    }
 }
 
 #endif
@@ -6,6 +6,93 @@
 
 namespace HCUBE
 {
+    namespace
+    {
+        //A square is x*8+y, so moving along y shifts by 1 and along x by 8
+        const int directionShifts[8] = {1,-1,8,-8,9,-9,7,-7};
+
+        //The squares a one step shift in each direction can land on without
+        //wrapping from one column to the next
+        const unsigned long long notFirstRow = 0xFEFEFEFEFEFEFEFEULL;
+        const unsigned long long notLastRow = 0x7F7F7F7F7F7F7F7FULL;
+        const unsigned long long directionMasks[8] =
+        {
+            notFirstRow,notLastRow,~0ULL,~0ULL,notFirstRow,notLastRow,notLastRow,notFirstRow
+        };
+
+        inline unsigned long long shiftSquares(unsigned long long squares,int shift)
+        {
+            return (shift>0) ? (squares<<shift) : (squares>>(-shift));
+        }
+
+        /*
+        * Kogge-Stone fill: extends generator along a direction through the
+        * propagator squares in three steps instead of one per square.
+        */
+        inline unsigned long long fillSquares(
+            unsigned long long generator,
+            unsigned long long propagator,
+            int direction
+        )
+        {
+            int shift = directionShifts[direction];
+
+            propagator &= directionMasks[direction];
+            generator |= propagator & shiftSquares(generator,shift);
+            propagator &= shiftSquares(propagator,shift);
+            generator |= propagator & shiftSquares(generator,shift*2);
+            propagator &= shiftSquares(propagator,shift*2);
+            generator |= propagator & shiftSquares(generator,shift*4);
+
+            return generator;
+        }
+    }
+
+    OthelloBitboard::OthelloBitboard(ushort b[8][8])
+            :
+            black(0),
+            white(0)
+    {
+        for (int square=0;square<64;square++)
+        {
+            int piece = OTHELLO_GET_PIECE(b[getX(square)][getY(square)]);
+
+            if (piece==OTHELLO_BLACK)
+            {
+                black |= (1ULL<<square);
+            }
+            else if (piece==OTHELLO_WHITE)
+            {
+                white |= (1ULL<<square);
+            }
+        }
+    }
+
+    void OthelloBitboard::toBoard(ushort b[8][8]) const
+    {
+        for (int square=0;square<64;square++)
+        {
+            unsigned long long mask = (1ULL<<square);
+            ushort &piece = b[getX(square)][getY(square)];
+
+            if (black&mask)
+            {
+                piece = OTHELLO_BLACK;
+            }
+            else if (white&mask)
+            {
+                piece = OTHELLO_WHITE;
+            }
+            else
+            {
+                piece = OTHELLO_EMPTY;
+            }
+        }
+
+        OTHELLO_SET_NUM_BLACK_PIECES(b,getSquareCount(black));
+        OTHELLO_SET_NUM_WHITE_PIECES(b,getSquareCount(white));
+    }
+
     OthelloMove::OthelloMove()
             :
             position(255,255)
@@ -493,4 +580,91 @@ namespace HCUBE
             return OTHELLO_END_TIE;
         }
     }
+
+    unsigned long long OthelloCommon::getMobility(const OthelloBitboard &position,int color)
+    {
+        unsigned long long pieces = position.getPieces(color);
+        unsigned long long opponents = position.getPieces(3-color);
+        unsigned long long empty = position.getEmpty();
+        unsigned long long moves=0;
+
+        for (int direction=0;direction<8;direction++)
+        {
+            //Runs of opponent pieces that start next to one of ours, the
+            //empty square past the end of a run is a move
+            unsigned long long runs = fillSquares(pieces,opponents,direction)&opponents;
+
+            moves |= shiftSquares(runs,directionShifts[direction]) & directionMasks[direction] & empty;
+        }
+
+        return moves;
+    }
+
+    unsigned long long OthelloCommon::getFlips(const OthelloBitboard &position,int color,int square)
+    {
+        unsigned long long pieces = position.getPieces(color);
+        unsigned long long opponents = position.getPieces(3-color);
+        unsigned long long flips=0;
+
+        for (int direction=0;direction<8;direction++)
+        {
+            unsigned long long run = fillSquares(1ULL<<square,opponents,direction)&opponents;
+
+            if (shiftSquares(run,directionShifts[direction]) & directionMasks[direction] & pieces)
+            {
+                //The run ends at one of our pieces, capture it
+                flips |= run;
+            }
+        }
+
+        return flips;
+    }
+
+    void OthelloCommon::makeMove(int square,OthelloBitboard &position,int color)
+    {
+        unsigned long long flips = getFlips(position,color,square);
+
+        if (color==OTHELLO_BLACK)
+        {
+            position.black |= flips|(1ULL<<square);
+            position.white &= ~flips;
+        }
+        else
+        {
+            position.white |= flips|(1ULL<<square);
+            position.black &= ~flips;
+        }
+    }
+
+    int OthelloCommon::getWinner(const OthelloBitboard &position)
+    {
+        int blackPieces = OthelloBitboard::getSquareCount(position.black);
+        int whitePieces = OthelloBitboard::getSquareCount(position.white);
+
+        if (!blackPieces)
+        {
+            return OTHELLO_WHITE;
+        }
+        else if (!whitePieces)
+        {
+            return OTHELLO_BLACK;
+        }
+        else if (getMobility(position,OTHELLO_BLACK) || getMobility(position,OTHELLO_WHITE))
+        {
+            //Game is still ongoing
+            return OTHELLO_END_UNKNOWN;
+        }
+        else if (blackPieces<whitePieces)
+        {
+            return OTHELLO_WHITE;
+        }
+        else if (blackPieces>whitePieces)
+        {
+            return OTHELLO_BLACK;
+        }
+        else
+        {
+            return OTHELLO_END_TIE;
+        }
+    }
 }
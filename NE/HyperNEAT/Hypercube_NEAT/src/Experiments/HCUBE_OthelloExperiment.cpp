@@ -6,8 +6,6 @@
 
 #define OTHELLO_EXPERIMENT_PRINT_GAMES (0)
 
-#define DEBUG_BOARD_CACHE (0)
-
 #define DEBUG_CHECK_HAND_CODED_HEURISTIC (0)
 
 #define DEBUG_USE_BOARD_EVALUATION_CACHE (1)
@@ -50,8 +48,6 @@ namespace HCUBE
 
 		resetBoard(userEvaluationBoard);
 		userEvaluationRound = (0);
-
-		//boardStateCache.reserve(10000);
 	}
 
 	GeneticPopulation* OthelloExperiment::createInitialPopulation(int populationSize)
@@ -272,6 +268,8 @@ namespace HCUBE
 		int substrateNum
 		)
 	{
+		NEAT_PROFILE_SCOPE("substratePopulation");
+
 #if OTHELLO_EXPERIMENT_ENABLE_BIASES
 		NEAT::FastBiasNetwork<OthelloNEATDatatype>* substrate;
 #else
@@ -724,12 +722,12 @@ namespace HCUBE
 		OthelloNEATDatatype output;
 
 #if DEBUG_USE_BOARD_EVALUATION_CACHE
-		tmpboard.loadBoard(b);
-		OthelloBoardCacheMap::iterator bIterator = boardEvaluationCache.find(tmpboard);
+		OthelloBitboard position(b);
+		const OthelloNEATDatatype *cachedOutput = boardEvaluationCache.probe(position,currentSubstrateIndex);
 
-		if (bIterator != boardEvaluationCache.end())
+		if (cachedOutput)
 		{
-			output = bIterator->second;
+			output = *cachedOutput;
 		}
 		else
 #endif
@@ -786,10 +784,7 @@ namespace HCUBE
 #endif
 
 #if DEBUG_USE_BOARD_EVALUATION_CACHE
-			if (boardEvaluationCache.size()<10000)
-			{
-				boardEvaluationCache[tmpboard] = output;
-			}
+			boardEvaluationCache.store(position,currentSubstrateIndex,output);
 #endif
 		}
 
@@ -914,54 +909,29 @@ namespace HCUBE
 
 	OthelloNEATDatatype OthelloExperiment::evaluatemax(ushort b[8][8],  OthelloNEATDatatype parentBeta, int depth,int maxDepth)
 	{
-		if (depth==0)
-		{
-			totalNumMoves=0;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-			cout << "Creating new outfile\n";
-			if (outfile) delete outfile;
-			outfile = new ofstream("BoardEvaluations.txt");
-#endif
-		}
-#if DEBUG_BOARD_CACHE
-		OthelloBoardState boardState(b,OTHELLO_BLACK,depth);
-		if (depth==0)
-		{
-			boardStateCache.clear();
-		}
-		else
-		{
-			OthelloBoardStateMap::iterator bsIterator = boardStateCache.find(boardState);
-
-			if (bsIterator!=boardStateCache.end())
-			{
-				//cout << "CACHE HIT, BAILING\n";
-				//This board has already been explored before, treat this as a loss
-				if (bsIterator->second>parentBeta)
-				{
-					//This will be worse than the last time this state was seen.  Don't bother.
-					return INT_MIN/2;
-				}
-			}
+		return searchmax(OthelloBitboard(b),parentBeta,depth,maxDepth);
+	}
 
-			if (boardStateCache.size()<10000)
-			{
-				boardStateCache.insert(boardState,parentBeta);
-			}
-		}
-#endif
+	OthelloNEATDatatype OthelloExperiment::evaluatemin(ushort b[8][8],  OthelloNEATDatatype parentAlpha, int depth,int maxDepth)
+	{
+		return searchmin(OthelloBitboard(b),parentAlpha,depth,maxDepth);
+	}
 
-		int newMoveStart = totalNumMoves;
+	void OthelloExperiment::setMoveToMake(int square,int color)
+	{
+		moveToMake.reset(
+			Vector2<uchar>(OthelloBitboard::getX(square),OthelloBitboard::getY(square)),
+			color
+			);
+	}
 
-		OthelloMove *moveList = &totalMoveList[newMoveStart];
-		int moveListCount;
+	OthelloNEATDatatype OthelloExperiment::searchmax(const OthelloBitboard &position,  OthelloNEATDatatype parentBeta, int depth,int maxDepth)
+	{
+		unsigned long long moves = getMobility(position,OTHELLO_BLACK);
+		int moveListCount = OthelloBitboard::getSquareCount(moves);
 
 		OthelloNEATDatatype alpha=OthelloNEATDatatype(INT_MIN);
 
-		int bestMoveSoFarIndex=-1;
-
-		moveListCount = generateMoveList(b,moveList,OTHELLO_BLACK);
-
 		if (!moveListCount)
 		{
 			//No possible moves, this is a loss!
@@ -971,7 +941,7 @@ namespace HCUBE
 		if (depth==0 && moveListCount==1)
 		{
 			//Forced move, don't bother doing any evaluations
-			moveToMake = moveList[0];
+			setMoveToMake(OthelloBitboard::getFirstSquare(moves),OTHELLO_BLACK);
 			return 0;
 		}
 
@@ -985,17 +955,23 @@ namespace HCUBE
 				int randomMove =
 					NEAT::Globals::getSingleton()->getRandom().getRandomWithinRange(0,moveListCount-1);
 
-				moveToMake = moveList[randomMove];
+				unsigned long long randomMoves = moves;
+				for (int a=0;a<randomMove;a++)
+				{
+					randomMoves &= (randomMoves-1);
+				}
+
+				setMoveToMake(OthelloBitboard::getFirstSquare(randomMoves),OTHELLO_BLACK);
 				return 0;
 			}
 		}
 
 #if OTHELLO_EXPERIMENT_DEBUG
-		printBoard(b);
 		cout << "Moves for black: " << endl;
-		for (int a=0;a<moveListCount;a++)
+		for (unsigned long long debugMoves=moves;debugMoves;debugMoves&=(debugMoves-1))
 		{
-			cout << "MOVE: (" << (int)moveList[a].position.x << ',' << (int)moveList[a].position.y << ")" << endl;
+			int square = OthelloBitboard::getFirstSquare(debugMoves);
+			cout << "MOVE: (" << OthelloBitboard::getX(square) << ',' << OthelloBitboard::getY(square) << ")" << endl;
 		}
 		CREATE_PAUSE("Done listing moves");
 #endif
@@ -1003,37 +979,32 @@ namespace HCUBE
 		if (depth==maxDepth)
 		{
 			//This is a leaf node, return the neural network's evaluation
+			ushort b[8][8];
+			position.toBoard(b);
 			return evaluateLeafBlack(b);
 		}
 
 		OthelloNEATDatatype childBeta;
 
-		totalNumMoves+=moveListCount;
-
-		if (totalNumMoves >= MAX_TOTAL_MOVES)
+		for (;moves;moves&=(moves-1))
 		{
-			CREATE_PAUSE("Shit! I blew my move stack!");
-		}
+			int square = OthelloBitboard::getFirstSquare(moves);
 
-		for (int a=0;a<moveListCount;a++)
-		{
-			makeMove(moveList[a],b);
+			OthelloBitboard child = position;
+			makeMove(square,child,OTHELLO_BLACK);
 
-			int winner = getWinner(b);
+			int winner = getWinner(child);
 
 			if (winner==OTHELLO_BLACK)
 			{
 				//CREATE_PAUSE("FOUND WIN FOR BLACK!");
-				reverseMove(moveList[a],b);
-
 				if (depth==0)
-					moveToMake = moveList[a];
+					setMoveToMake(square,OTHELLO_BLACK);
 
 				return OthelloNEATDatatype(INT_MAX/2);
 			}
 
-			childBeta = evaluatemin(b,alpha,depth+1,maxDepth);
-			reverseMove(moveList[a],b);
+			childBeta = searchmin(child,alpha,depth+1,maxDepth);
 
 #if OTHELLO_EXPERIMENT_DEBUG
 			for (int dd=0;dd<depth;dd++)
@@ -1049,16 +1020,15 @@ namespace HCUBE
 				cout << "Found new alpha\n";
 #endif
 				alpha = childBeta;
-				bestMoveSoFarIndex = a;
 				if (depth==0)
 				{
 					//This means that this is the root max, so store the best move.
 #if OTHELLO_EXPERIMENT_DEBUG
-					cout << "BLACK: MOVE_TO_MAKE: (" << moveList[a].position.x << ',' << moveList[a].position.y << ")" << endl;
+					cout << "BLACK: MOVE_TO_MAKE: (" << OthelloBitboard::getX(square) << ',' << OthelloBitboard::getY(square) << ")" << endl;
 					CREATE_PAUSE("SETTING MOVE_TO_MAKE");
 #endif
 
-					moveToMake = moveList[a];
+					setMoveToMake(square,OTHELLO_BLACK);
 				}
 				else
 				{
@@ -1069,186 +1039,22 @@ namespace HCUBE
 						CREATE_PAUSE("");
 #endif
 						//parent will never choose this alpha
-						totalNumMoves-=moveListCount;
-
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-						//cout << "Printing board leaf evaluations\n";
-						if (depth<=2)
-						{
-							*outfile << "Depth: " << depth << endl;
-							for (int y=0;y<8;y++)
-							{
-								for (int x=7;x>=0;x--)
-								{
-									if (b[x][y]&FREE)
-									{
-										*outfile << " ";
-									}
-									else if (b[x][y]&BLACK)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "b";
-										}
-										else
-										{
-											*outfile << "B";
-										}
-									}
-									else if (b[x][y]&WHITE)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "w";
-										}
-										else
-										{
-											*outfile << "W";
-										}
-									}
-									else
-									{
-										*outfile << "_";
-									}
-								}
-								*outfile << endl;
-							}
-							*outfile << "BEST MOVE FOR BLACK: " << (int)moveList[a].from.x << ',' << (int)moveList[a].from.y << " to "
-								<< (int)moveList[a].getFinalDestination().x << ',' << (int)moveList[a].getFinalDestination().y << endl;
-							*outfile << endl;
-						}
-#endif
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-						if (depth==0)
-						{
-							cout << __LINE__ << " Closing outfile handle\n";
-							if (outfile)
-							{
-								outfile->close();
-								delete outfile;
-							}
-							outfile = NULL;
-						}
-#endif
 						return alpha;
 					}
 				}
 			}
 		}
 
-		totalNumMoves-=moveListCount;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		//cout << "Printing board leaf evaluations\n";
-		if (depth<=2)
-		{
-			*outfile << "Depth: " << depth << endl;
-			for (int y=0;y<8;y++)
-			{
-				for (int x=7;x>=0;x--)
-				{
-					if (b[x][y]&FREE)
-					{
-						*outfile << " ";
-					}
-					else if (b[x][y]&BLACK)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "b";
-						}
-						else
-						{
-							*outfile << "B";
-						}
-					}
-					else if (b[x][y]&WHITE)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "w";
-						}
-						else
-						{
-							*outfile << "W";
-						}
-					}
-					else
-					{
-						*outfile << "_";
-					}
-				}
-				*outfile << endl;
-			}
-			if (bestMoveSoFarIndex!=-1)
-			{
-				*outfile << "BEST MOVE FOR BLACK: " << (int)moveList[bestMoveSoFarIndex].from.x << ',' << (int)moveList[bestMoveSoFarIndex].from.y << " to "
-					<< (int)moveList[bestMoveSoFarIndex].getFinalDestination().x << ',' << (int)moveList[bestMoveSoFarIndex].getFinalDestination().y << endl;
-				*outfile << endl;
-			}
-			else
-			{
-				*outfile << "NO MOVES FOUND (OR WILL NEVER GET TO THIS PART OF THE GAME TREE)\n";
-			}
-		}
-#endif
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		if (depth==0)
-		{
-			cout << __LINE__ << " Closing outfile handle\n";
-			if (outfile)
-			{
-				outfile->close();
-				delete outfile;
-			}
-			outfile = NULL;
-		}
-#endif
 		return alpha;
 	}
 
-	OthelloNEATDatatype OthelloExperiment::evaluatemin(ushort b[8][8],  OthelloNEATDatatype parentAlpha, int depth,int maxDepth)
+	OthelloNEATDatatype OthelloExperiment::searchmin(const OthelloBitboard &position,  OthelloNEATDatatype parentAlpha, int depth,int maxDepth)
 	{
-		if (depth==0)
-		{
-			totalNumMoves=0;
-		}
-#if DEBUG_BOARD_CACHE
-		OthelloBoardState boardState(b,OTHELLO_WHITE,depth);
-		if (depth==0)
-		{
-			boardStateCache.clear();
-		}
-		else
-		{
-			OthelloBoardStateMap::iterator bsIterator = boardStateCache.find(boardState);
-
-			if (bsIterator!=boardStateCache.end())
-			{
-				//cout << "CACHE HIT, BAILING\n";
-				//This board has already been explored before, treat this as a loss
-				if (bsIterator->second<parentAlpha)
-				{
-					//This will be a subset of the moves seen previously.  Ignore
-					return (OthelloNEATDatatype)INT_MAX/2;
-				}
-			}
-
-			boardStateCache.insert(boardState,parentAlpha);
-		}
-#endif
-
-
-		int newMoveStart = totalNumMoves;
-
-		OthelloMove *moveList = &totalMoveList[newMoveStart];
-		int moveListCount;
+		unsigned long long moves = getMobility(position,OTHELLO_WHITE);
+		int moveListCount = OthelloBitboard::getSquareCount(moves);
 
 		OthelloNEATDatatype beta=OthelloNEATDatatype(INT_MAX);
 
-		int bestMoveSoFarIndex=-1;
-
-		moveListCount = generateMoveList(b,moveList,OTHELLO_WHITE);
-
 		if (!moveListCount)
 		{
 			/*NOTE:
@@ -1264,7 +1070,7 @@ namespace HCUBE
 		if (depth==0 && moveListCount==1)
 		{
 			//Forced move, don't bother doing any evaluations
-			moveToMake = moveList[0];
+			setMoveToMake(OthelloBitboard::getFirstSquare(moves),OTHELLO_WHITE);
 			return 0;
 		}
 
@@ -1278,17 +1084,23 @@ namespace HCUBE
 				int randomMove =
 					NEAT::Globals::getSingleton()->getRandom().getRandomWithinRange(0,moveListCount-1);
 
-				moveToMake = moveList[randomMove];
+				unsigned long long randomMoves = moves;
+				for (int a=0;a<randomMove;a++)
+				{
+					randomMoves &= (randomMoves-1);
+				}
+
+				setMoveToMake(OthelloBitboard::getFirstSquare(randomMoves),OTHELLO_WHITE);
 				return 0;
 			}
 		}
 
 #if OTHELLO_EXPERIMENT_DEBUG
-		printBoard(b);
 		cout << "Moves for white: " << endl;
-		for (int a=0;a<moveListCount;a++)
+		for (unsigned long long debugMoves=moves;debugMoves;debugMoves&=(debugMoves-1))
 		{
-			cout << "MOVE: (" << (int)moveList[a].position.x << ',' << (int)moveList[a].position.y << ")\n";
+			int square = OthelloBitboard::getFirstSquare(debugMoves);
+			cout << "MOVE: (" << OthelloBitboard::getX(square) << ',' << OthelloBitboard::getY(square) << ")\n";
 		}
 		CREATE_PAUSE("Done listing moves");
 #endif
@@ -1296,37 +1108,32 @@ namespace HCUBE
 		if (depth==maxDepth)
 		{
 			//This is a leaf node, return the hand coded evaluation
+			ushort b[8][8];
+			position.toBoard(b);
 			return evaluateLeafWhite(b);
 		}
 
 		OthelloNEATDatatype childAlpha;
 
-		totalNumMoves+=moveListCount;
-
-		if (totalNumMoves >= MAX_TOTAL_MOVES)
+		for (;moves;moves&=(moves-1))
 		{
-			CREATE_PAUSE("Shit! I blew my move stack!");
-		}
+			int square = OthelloBitboard::getFirstSquare(moves);
 
-		for (int a=0;a<moveListCount;a++)
-		{
-			makeMove(moveList[a],b);
+			OthelloBitboard child = position;
+			makeMove(square,child,OTHELLO_WHITE);
 
-			int winner = getWinner(b);
+			int winner = getWinner(child);
 
 			if (winner==OTHELLO_WHITE)
 			{
 				//CREATE_PAUSE("FOUND WIN FOR WHITE!");
-				reverseMove(moveList[a],b);
-
 				if (depth==0)
-					moveToMake = moveList[a];
+					setMoveToMake(square,OTHELLO_WHITE);
 
 				return (OthelloNEATDatatype)INT_MIN/2;
 			}
 
-			childAlpha = evaluatemax(b,beta,depth+1,maxDepth);
-			reverseMove(moveList[a],b);
+			childAlpha = searchmax(child,beta,depth+1,maxDepth);
 
 			if (childAlpha < beta)
 			{
@@ -1334,144 +1141,28 @@ namespace HCUBE
 				cout << "Found new beta\n";
 #endif
 				beta = childAlpha;
-				bestMoveSoFarIndex = a;
 
 				if (depth==0)
 				{
 					//This means that this is the root max, so store the best move.
 #if OTHELLO_EXPERIMENT_DEBUG
-					cout << "WHITE: MOVE_TO_MAKE: (" << moveList[a].position.x << ',' << moveList[a].position.y << ")\n";
+					cout << "WHITE: MOVE_TO_MAKE: (" << OthelloBitboard::getX(square) << ',' << OthelloBitboard::getY(square) << ")\n";
 					CREATE_PAUSE("SETTING MOVE_TO_MAKE");
 #endif
 
-					moveToMake = moveList[a];
+					setMoveToMake(square,OTHELLO_WHITE);
 				}
 				else
 				{
 					if (parentAlpha >= beta)
 					{
 						//parent will never choose this beta
-						totalNumMoves-=moveListCount;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-						if (depth<=2)
-						{
-							*outfile << "Depth: " << depth << endl;
-							//cout << "Printing board leaf evaluations\n";
-							for (int y=0;y<8;y++)
-							{
-								for (int x=7;x>=0;x--)
-								{
-									if (b[x][y]&FREE)
-									{
-										*outfile << " ";
-									}
-									else if (b[x][y]&BLACK)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "b";
-										}
-										else
-										{
-											*outfile << "B";
-										}
-									}
-									else if (b[x][y]&WHITE)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "w";
-										}
-										else
-										{
-											*outfile << "W";
-										}
-									}
-									else
-									{
-										*outfile << "_";
-									}
-								}
-								*outfile << endl;
-							}
-							if (bestMoveSoFarIndex!=-1)
-							{
-								*outfile << "BEST MOVE FOR WHITE: " << (int)moveList[bestMoveSoFarIndex].from.x << ',' << (int)moveList[bestMoveSoFarIndex].from.y << " to "
-									<< (int)moveList[bestMoveSoFarIndex].getFinalDestination().x << ',' << (int)moveList[bestMoveSoFarIndex].getFinalDestination().y << endl;
-								*outfile << endl;
-							}
-							else
-							{
-								*outfile << "NO MOVES FOUND (OR WILL NEVER GET TO THIS PART OF THE GAME TREE)\n";
-							}
-						}
-#endif
 						return beta;
 					}
 				}
 			}
 		}
 
-		if (depth==0 && moveListCount==0)
-		{
-			cout << "NO MOVES TO MAKE!!!\n";
-		}
-
-		totalNumMoves-=moveListCount;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		//cout << "Printing board leaf evaluations\n";
-		if (depth<=2)
-		{
-			*outfile << "Depth: " << depth << endl;
-			for (int y=0;y<8;y++)
-			{
-				for (int x=7;x>=0;x--)
-				{
-					if (b[x][y]&FREE)
-					{
-						*outfile << " ";
-					}
-					else if (b[x][y]&BLACK)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "b";
-						}
-						else
-						{
-							*outfile << "B";
-						}
-					}
-					else if (b[x][y]&WHITE)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "w";
-						}
-						else
-						{
-							*outfile << "W";
-						}
-					}
-					else
-					{
-						*outfile << "_";
-					}
-				}
-				*outfile << endl;
-			}
-			if (bestMoveSoFarIndex!=-1)
-			{
-				*outfile << "BEST MOVE FOR WHITE: " << (int)moveList[bestMoveSoFarIndex].from.x << ',' << (int)moveList[bestMoveSoFarIndex].from.y << " to "
-					<< (int)moveList[bestMoveSoFarIndex].getFinalDestination().x << ',' << (int)moveList[bestMoveSoFarIndex].getFinalDestination().y << endl;
-				*outfile << endl;
-			}
-			else
-			{
-				*outfile << "NO MOVES FOUND (OR WILL NEVER GET TO THIS PART OF THE GAME TREE)\n";
-			}
-		}
-#endif
 		return beta;
 	}
 
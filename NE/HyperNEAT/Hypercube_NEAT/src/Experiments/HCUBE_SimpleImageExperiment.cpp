@@ -230,50 +230,42 @@ namespace HCUBE
 
         int maxFitness=0;
 
-        for (int inputString=0;inputString<32;inputString++)
-            //int inputString=18;
+        //Every input string goes through network2 in one batched update
+        const int numInputStrings=32;
+
+        vector<int> inputNodes(numNodesX),outputNodes(numNodesX);
+        for (int x1=0;x1<numNodesX;x1++)
         {
+            inputNodes[x1] = network2.getNodeIndex(toString(numNodesY/2)+"/"+toString(x1-numNodesX/2));
+            outputNodes[x1] = network2.getNodeIndex(toString(-(numNodesY/2))+"/"+toString(x1-numNodesX/2));
+        }
 
-            network2.reinitialize();
-            network2.dummyActivation();
+        //Node-major, see FastNetwork::updateBatch.  Zeroing it is the reinitialize().
+        vector<double> batchValues(size_t(network2.getNodeCount())*numInputStrings,0.0);
 
-            for (int y1=((numNodesY/2));y1<(numNodesY/2)+1;y1++)
+        for (int inputString=0;inputString<numInputStrings;inputString++)
+        {
+            for (int x1=0;x1<numNodesX;x1++)
             {
-                for (int x1=0;x1<numNodesX;x1++)
-                {
-                    int value = HASBIT(inputString,x1)*2-1;
-                    network2.setValue(toString(y1)+"/"+toString(x1-numNodesX/2) , value );
-                }
+                batchValues[size_t(inputNodes[x1])*numInputStrings+inputString] = HASBIT(inputString,x1)*2-1;
             }
+        }
 
-            for (int a=0;a<=1;a++)
-            {
-                if (a>0)
-                {
-                    //only run if we've had a chance to update at least once
-                    for (int y1=((numNodesY/2));y1<numNodesY/2+1;y1++)
-                    {
-                        for (int x1=0;x1<numNodesX;x1++)
-                        {
-                            answer = network2.getValue(toString(-y1)+"/"+toString(x1-numNodesX/2));
-
-                            double fitness = getFitness(answer,HASBIT(inputString,x1)*2-1);
+        //The outputs are scored after one update past dummyActivation()
+        network2.updateBatchFixedIterations(&batchValues[0],numInputStrings,1);
 
-                            individual->reward( fitness );
+        for (int inputString=0;inputString<numInputStrings;inputString++)
+        {
+            for (int x1=0;x1<numNodesX;x1++)
+            {
+                answer = batchValues[size_t(outputNodes[x1])*numInputStrings+inputString];
 
-                            maxFitness += 100;
+                double fitness = getFitness(answer,HASBIT(inputString,x1)*2-1);
 
-                            if (fitness<90.0)
-                            {
-                                //failed[0]=true;
-                            }
-                        }
-                    }
-                }
+                individual->reward( fitness );
 
-                network2.update();
+                maxFitness += 100;
             }
-
         }
 
         //individual->setFitness(individual->getFitness()*individual->getFitness());
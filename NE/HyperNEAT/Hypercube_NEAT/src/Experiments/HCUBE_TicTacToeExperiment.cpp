@@ -211,6 +211,8 @@ namespace HCUBE
 
     void TicTacToeExperiment::populateSubstrate(shared_ptr<const NEAT::GeneticIndividual> individual)
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         NEAT::FastNetwork<double> network = individual->spawnFastPhenotypeStack<double>();
 
         for (int y1=0;y1<numNodesY;y1++)
@@ -202,6 +202,8 @@ namespace HCUBE
 
     void TicTacToeGameExperiment::populateSubstrate(shared_ptr<NEAT::GeneticIndividual> individual)
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         NEAT::FastNetwork<double> network = individual->spawnFastPhenotypeStack<double>();
 
         int linkCounter=0;
@@ -217,6 +217,13 @@ namespace HCUBE
         return experiment;
     }
 
+    NEAT::CoEvoExperiment* XorCoExperiment::cloneCoEvoExperiment()
+    {
+        XorCoExperiment* experiment = new XorCoExperiment(*this);
+
+        return experiment;
+    }
+
     void XorCoExperiment::addGenerationData(shared_ptr<NEAT::GeneticGeneration> generation,shared_ptr<NEAT::GeneticIndividual> individual)
     {
     }
@@ -0,0 +1,183 @@
+#include "HCUBE_Defines.h"
+
+#include "HCUBE_CheckpointLog.h"
+
+#include <boost/crc.hpp>
+#include <boost/cstdint.hpp>
+
+namespace HCUBE
+{
+    namespace
+    {
+        const char recordMagic[4] = {'H','N','C','K'};
+
+        //magic, generation, payload size, checksum
+        const int recordHeaderSize = 16;
+
+        void writeHeaderField(char *buffer,int offset,boost::uint32_t value)
+        {
+            memcpy(buffer+offset,&value,sizeof(value));
+        }
+
+        boost::uint32_t readHeaderField(const char *buffer,int offset)
+        {
+            boost::uint32_t value;
+            memcpy(&value,buffer+offset,sizeof(value));
+            return value;
+        }
+    }
+
+    CheckpointLog::CheckpointLog(string _fileName)
+        :
+        fileName(_fileName),
+        validEnd(0)
+    {
+        readIndex();
+    }
+
+    bool CheckpointLog::isCheckpointLog(string fileName)
+    {
+        std::ifstream in(fileName.c_str(),std::ios::in|std::ios::binary);
+        char magic[4];
+        if (!in.read(magic,4))
+        {
+            return false;
+        }
+        return memcmp(magic,recordMagic,4)==0;
+    }
+
+    unsigned int CheckpointLog::computeChecksum(const string &payload)
+    {
+        boost::crc_32_type crc;
+        crc.process_bytes(payload.data(),payload.size());
+        return crc.checksum();
+    }
+
+    void CheckpointLog::readIndex()
+    {
+        records.clear();
+        validEnd=0;
+
+        std::ifstream in(fileName.c_str(),std::ios::in|std::ios::binary);
+        if (!in)
+        {
+            return;
+        }
+
+        in.seekg(0,std::ios::end);
+        long long fileSize = (long long)in.tellg();
+        in.seekg(0,std::ios::beg);
+
+        char header[recordHeaderSize];
+        while (validEnd+recordHeaderSize<=fileSize)
+        {
+            in.seekg(validEnd,std::ios::beg);
+            if (!in.read(header,recordHeaderSize) || memcmp(header,recordMagic,4)!=0)
+            {
+                break;
+            }
+
+            Record record;
+            record.generation = int(readHeaderField(header,4));
+            record.payloadSize = readHeaderField(header,8);
+            record.checksum = readHeaderField(header,12);
+            record.payloadOffset = validEnd+recordHeaderSize;
+
+            if (record.payloadOffset+record.payloadSize>fileSize)
+            {
+                //Torn write, the next append replaces it
+                break;
+            }
+
+            records.push_back(record);
+            validEnd = record.payloadOffset+record.payloadSize;
+        }
+    }
+
+    int CheckpointLog::findRecord(int generation)
+    {
+        for (int a=int(records.size())-1;a>=0;a--)
+        {
+            if (generation==-1 || records[a].generation==generation)
+            {
+                return a;
+            }
+        }
+
+        throw CREATE_LOCATEDEXCEPTION_INFO(
+            string("No checkpoint for generation ")+toString(generation)+string(" in ")+fileName
+            );
+    }
+
+    void CheckpointLog::append(int generation,const string &payload)
+    {
+        if (boost::filesystem::exists(fileName) &&
+            (long long)boost::filesystem::file_size(fileName)>validEnd)
+        {
+            boost::filesystem::resize_file(fileName,validEnd);
+        }
+
+        char header[recordHeaderSize];
+        memcpy(header,recordMagic,4);
+        writeHeaderField(header,4,boost::uint32_t(generation));
+        writeHeaderField(header,8,boost::uint32_t(payload.size()));
+        writeHeaderField(header,12,computeChecksum(payload));
+
+        std::ofstream out(fileName.c_str(),std::ios::out|std::ios::binary|std::ios::app);
+        out.write(header,recordHeaderSize);
+        out.write(payload.data(),payload.size());
+        out.flush();
+        if (!out)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Error appending to checkpoint log ")+fileName);
+        }
+
+        Record record;
+        record.generation = generation;
+        record.payloadSize = (unsigned int)payload.size();
+        record.checksum = computeChecksum(payload);
+        record.payloadOffset = validEnd+recordHeaderSize;
+        records.push_back(record);
+        validEnd = record.payloadOffset+record.payloadSize;
+    }
+
+    string CheckpointLog::readPayload(int index)
+    {
+        const Record &record = records[index];
+
+        string payload(record.payloadSize,'\0');
+        std::ifstream in(fileName.c_str(),std::ios::in|std::ios::binary);
+        in.seekg(record.payloadOffset,std::ios::beg);
+        if (record.payloadSize && !in.read(&payload[0],record.payloadSize))
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Error reading checkpoint log ")+fileName);
+        }
+
+        if (computeChecksum(payload)!=record.checksum)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(
+                string("Checkpoint for generation ")+toString(record.generation)+string(" is corrupt in ")+fileName
+                );
+        }
+
+        return payload;
+    }
+
+    bool CheckpointLog::verifyRecord(int index,unsigned int expectedChecksum)
+    {
+        if (index<0 || index>=getRecordCount() || records[index].checksum!=expectedChecksum)
+        {
+            return false;
+        }
+
+        try
+        {
+            readPayload(index);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+        return true;
+    }
+}
@@ -5,9 +5,8 @@ namespace HCUBE
 #if defined(_DEBUG) || defined(USE_GPU)
 	int NUM_THREADS = 1;
 #else
-    //Automatically sets to the # of threads.
+    //Set at runtime with -T (threads), -T 0 uses one thread per core
 	int NUM_THREADS = 1;
-	//int NUM_THREADS = boost::thread::hardware_concurrency();
 #endif
 
 	const int EXPERIMENT_BLOCKS_GUI  = 0;
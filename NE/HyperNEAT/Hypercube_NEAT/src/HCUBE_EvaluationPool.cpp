@@ -0,0 +1,236 @@
+#include "HCUBE_Defines.h"
+
+#include "HCUBE_EvaluationPool.h"
+
+#include "HCUBE_EvaluationSet.h"
+
+namespace HCUBE
+{
+    namespace
+    {
+        double secondsBetween(const boost::posix_time::ptime &start,const boost::posix_time::ptime &end)
+        {
+            return (end-start).total_microseconds()/1000000.0;
+        }
+    }
+
+    EvaluationPool::EvaluationPool(int numThreads)
+        :
+        batchNumber(0),
+        tasksRemaining(0),
+        stopping(false),
+        batchIndividualCount(0),
+        batchGroupCapacity(1)
+    {
+        if (numThreads<1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Tried to create an evaluation pool with no threads!");
+        }
+
+        for (int a=0;a<numThreads;a++)
+        {
+            workers.push_back(shared_ptr<Worker>(new Worker()));
+        }
+
+        for (int a=0;a<numThreads;a++)
+        {
+            threads.push_back(
+                shared_ptr<boost::thread>(
+                    new boost::thread(
+                        boost::bind(
+                            &EvaluationPool::runWorker,
+                            this,
+                            a
+                            )
+                        )
+                    )
+                );
+        }
+    }
+
+    EvaluationPool::~EvaluationPool()
+    {
+        {
+            mutex::scoped_lock lock(poolMutex);
+            stopping=true;
+        }
+        workAvailable.notify_all();
+
+        for (int a=0;a<(int)threads.size();a++)
+        {
+            threads[a]->join();
+        }
+    }
+
+    void EvaluationPool::evaluate(
+        const vector<shared_ptr<Experiment> > &experiments,
+        shared_ptr<NEAT::GeneticGeneration> generation,
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator individualIterator,
+        int individualCount
+    )
+    {
+        int numThreads = getThreadCount();
+
+        if ((int)experiments.size()<numThreads)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Error, the evaluation pool has more threads than experiments!");
+        }
+
+        boost::posix_time::ptime batchStart = boost::posix_time::microsec_clock::universal_time();
+
+        {
+            mutex::scoped_lock lock(poolMutex);
+
+            batchExperiments = experiments;
+            batchGeneration = generation;
+            batchIterator = individualIterator;
+            batchIndividualCount = individualCount;
+            batchGroupCapacity = max(1,experiments[0]->getGroupCapacity());
+
+            //Deal the groups out round robin.  The individual order is already
+            //randomized, so every queue starts with a similar amount of work.
+            tasksRemaining=0;
+            for (int start=0;start<individualCount;start+=batchGroupCapacity)
+            {
+                Worker &worker = *workers[tasksRemaining%numThreads];
+                mutex::scoped_lock taskLock(worker.taskMutex);
+                worker.tasks.push_back(start);
+                tasksRemaining++;
+            }
+
+            for (int a=0;a<numThreads;a++)
+            {
+                workers[a]->batchBusySeconds=0;
+            }
+
+            batchNumber++;
+            workAvailable.notify_all();
+
+            while (tasksRemaining>0)
+            {
+                workFinished.wait(lock);
+            }
+
+            batchGeneration.reset();
+            batchExperiments.clear();
+        }
+
+        double batchSeconds = secondsBetween(
+            batchStart,
+            boost::posix_time::microsec_clock::universal_time()
+            );
+
+        for (int a=0;a<numThreads;a++)
+        {
+            workers[a]->totalBusySeconds += workers[a]->batchBusySeconds;
+            workers[a]->totalIdleSeconds += max(0.0,batchSeconds-workers[a]->batchBusySeconds);
+        }
+
+        printThreadTimes(batchSeconds);
+    }
+
+    void EvaluationPool::printThreadTimes(double batchSeconds)
+    {
+        cout << "Evaluation took " << batchSeconds << " seconds on " << getThreadCount() << " threads\n";
+        for (int a=0;a<getThreadCount();a++)
+        {
+            const Worker &worker = *workers[a];
+            cout << "    Thread " << a
+                 << ": busy " << worker.batchBusySeconds
+                 << "s idle " << max(0.0,batchSeconds-worker.batchBusySeconds)
+                 << "s (total busy " << worker.totalBusySeconds
+                 << "s idle " << worker.totalIdleSeconds
+                 << "s, " << worker.tasksRun << " groups, "
+                 << worker.tasksStolen << " stolen)\n";
+        }
+    }
+
+    void EvaluationPool::runWorker(int workerIndex)
+    {
+        int lastBatch=0;
+
+        while (true)
+        {
+            {
+                mutex::scoped_lock lock(poolMutex);
+                while (!stopping && batchNumber==lastBatch)
+                {
+                    workAvailable.wait(lock);
+                }
+
+                if (stopping)
+                {
+                    return;
+                }
+
+                lastBatch=batchNumber;
+            }
+
+            int task;
+            while (takeTask(workerIndex,task))
+            {
+                runTask(workerIndex,task);
+
+                mutex::scoped_lock lock(poolMutex);
+                tasksRemaining--;
+                if (tasksRemaining==0)
+                {
+                    workFinished.notify_all();
+                }
+            }
+        }
+    }
+
+    bool EvaluationPool::takeTask(int workerIndex,int &task)
+    {
+        {
+            Worker &worker = *workers[workerIndex];
+            mutex::scoped_lock lock(worker.taskMutex);
+            if (!worker.tasks.empty())
+            {
+                task = worker.tasks.front();
+                worker.tasks.pop_front();
+                return true;
+            }
+        }
+
+        //Our queue is empty, steal from the back of another thread's queue
+        for (int a=1;a<getThreadCount();a++)
+        {
+            Worker &victim = *workers[(workerIndex+a)%getThreadCount()];
+            mutex::scoped_lock lock(victim.taskMutex);
+            if (!victim.tasks.empty())
+            {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                workers[workerIndex]->tasksStolen++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void EvaluationPool::runTask(int workerIndex,int task)
+    {
+        Worker &worker = *workers[workerIndex];
+
+        boost::posix_time::ptime taskStart = boost::posix_time::microsec_clock::universal_time();
+
+        //EvaluationSet handles grouping and reports evaluation errors
+        EvaluationSet evaluationSet(
+            batchExperiments[workerIndex],
+            batchGeneration,
+            batchIterator+task,
+            min(batchGroupCapacity,batchIndividualCount-task),
+            task
+            );
+        evaluationSet.run();
+
+        worker.batchBusySeconds += secondsBetween(
+            taskStart,
+            boost::posix_time::microsec_clock::universal_time()
+            );
+        worker.tasksRun++;
+    }
+}
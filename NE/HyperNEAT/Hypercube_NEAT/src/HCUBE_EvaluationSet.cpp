@@ -8,6 +8,27 @@
 
 namespace HCUBE
 {
+    namespace
+    {
+        /**
+        * ScopedRandomStream: points this thread's NEAT random numbers at a
+        * per group stream until it goes out of scope
+        */
+        class ScopedRandomStream
+        {
+        public:
+            ScopedRandomStream(int generation,int individual)
+            {
+                NEAT::Globals::getSingleton()->setRandomStream(generation,individual);
+            }
+
+            ~ScopedRandomStream()
+            {
+                NEAT::Globals::getSingleton()->clearRandomStream();
+            }
+        };
+    }
+
     void EvaluationSet::run()
     {
 #ifndef _DEBUG
@@ -34,6 +55,9 @@ namespace HCUBE
 
                 if (experiment->getGroupSize()==experiment->getGroupCapacity())
                 {
+                    int groupStart = firstIndividualIndex + a + 1 - experiment->getGroupSize();
+                    ScopedRandomStream randomStream(generation->getGenerationNumber(),groupStart);
+
                     //cout << "Processing group...\n";
                     experiment->processGroup(generation);
                     //cout << "Done Processing group\n";
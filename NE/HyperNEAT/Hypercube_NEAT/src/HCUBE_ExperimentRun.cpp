@@ -53,6 +53,9 @@
 #endif
 
 #include "HCUBE_EvaluationSet.h"
+#include "HCUBE_EvaluationPool.h"
+#include "HCUBE_CheckpointLog.h"
+#include "HCUBE_FitnessCache.h"
 
 #include <boost/lexical_cast.hpp>
 #include <boost/archive/binary_oarchive.hpp>
@@ -62,6 +65,8 @@
 #include <boost/iostreams/filtering_streambuf.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 
 namespace HCUBE
 {
@@ -71,7 +76,8 @@ namespace HCUBE
         started(false),
         cleanup(false),
         populationMutex(new mutex()),
-        frame(NULL)
+        frame(NULL),
+        lastCheckpointChecksum(0)
     {
         //cout << "Creating experiment run" << endl;
     }
@@ -231,8 +237,9 @@ namespace HCUBE
     void ExperimentRun::createPopulationFromCondorRun(string populationFile,
                                                       string fitnessFunctionPrefix,
                                                       string evaluationFile,
-                                                      string rom_file) {
-        createPopulation(populationFile);
+                                                      string rom_file,
+                                                      int checkpointGeneration) {
+        createPopulation(populationFile, checkpointGeneration);
 
         allowGenerationProduction = true;
 
@@ -276,7 +283,7 @@ namespace HCUBE
         // Save the eval file
         if (!iequals(evaluationFile,"")) {
             //population->dumpBest(evaluationFile, true, true);
-            savePopulationBoost(evaluationFile);
+            savePopulation(evaluationFile);
         }
 
         shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
@@ -288,7 +295,7 @@ namespace HCUBE
         }
     }
 
-    void ExperimentRun::createPopulation(string populationString)
+    void ExperimentRun::createPopulation(string populationString,int generation)
     {
         if (iequals(populationString,"")) {
             allowGenerationProduction = false;
@@ -308,7 +315,11 @@ namespace HCUBE
 #endif
             // Load the population
             //population = shared_ptr<NEAT::GeneticPopulation>(new NEAT::GeneticPopulation(populationString));
-            loadPopulationBoost(populationString);
+            if (CheckpointLog::isCheckpointLog(populationString)) {
+                loadCheckpoint(populationString, generation);
+            } else {
+                loadPopulationBoost(populationString);
+            }
         }
     }
 
@@ -360,6 +371,7 @@ namespace HCUBE
     }
 
     void ExperimentRun::savePopulationBoost(string filename) {
+        NEAT_PROFILE_SCOPE("serialization");
         std::ofstream ofs(filename.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
         boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
         out.push(boost::iostreams::gzip_compressor());
@@ -368,6 +380,84 @@ namespace HCUBE
         oa << *population;
     }
 
+    void ExperimentRun::savePopulation(string filename) {
+        if (iends_with(filename,".ckpt")) {
+            appendCheckpoint(filename);
+            verifyCheckpoint(filename);
+        } else {
+            savePopulationBoost(filename);
+        }
+    }
+
+    void ExperimentRun::appendCheckpoint(string filename) {
+        NEAT_PROFILE_SCOPE("serialization");
+        CheckpointLog log(filename);
+        int onGeneration = population->getGenerationCount()-1;
+
+        // The generation of the previous record has been evaluated (and maybe
+        // cleaned up) since, so it is written again along with the newer ones
+        int firstGeneration = 0;
+        map<string,int>::iterator lastGeneration = checkpointLogGenerations.find(filename);
+        if (lastGeneration != checkpointLogGenerations.end() && log.getRecordCount() > 0) {
+            firstGeneration = min(lastGeneration->second, max(0,onGeneration-1));
+        }
+
+        string payload;
+        {
+            boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
+            out.push(boost::iostreams::gzip_compressor());
+            out.push(boost::iostreams::back_inserter(payload));
+            boost::archive::binary_oarchive oa(out);
+            population->saveGenerations(oa, firstGeneration);
+        }
+
+        log.append(onGeneration, payload);
+        checkpointLogGenerations[filename] = onGeneration;
+        lastCheckpointChecksum = CheckpointLog::computeChecksum(payload);
+    }
+
+    void ExperimentRun::compactCheckpoint(string filename) {
+        string compactFileName = filename+string(".compact");
+        boost::filesystem::remove(compactFileName);
+        checkpointLogGenerations.erase(compactFileName);
+
+        // A log the run hasn't written to yet gets every generation
+        appendCheckpoint(compactFileName);
+        verifyCheckpoint(compactFileName);
+
+        boost::filesystem::rename(compactFileName,filename);
+        checkpointLogGenerations[filename] = checkpointLogGenerations[compactFileName];
+        checkpointLogGenerations.erase(compactFileName);
+    }
+
+    void ExperimentRun::verifyCheckpoint(string filename) {
+        CheckpointLog log(filename);
+        int lastRecord = log.getRecordCount()-1;
+        if (lastRecord < 0 ||
+            log.getRecord(lastRecord).generation != population->getGenerationCount()-1 ||
+            !log.verifyRecord(lastRecord, lastCheckpointChecksum)) {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Checkpoint verification failed for ")+filename);
+        }
+    }
+
+    void ExperimentRun::loadCheckpoint(string filename,int generation) {
+        CheckpointLog log(filename);
+        int lastRecord = log.findRecord(generation);
+
+        population = shared_ptr<NEAT::GeneticPopulation>(new NEAT::GeneticPopulation());
+        for (int a=0;a<=lastRecord;a++) {
+            string payload = log.readPayload(a);
+            boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+            in.push(boost::iostreams::gzip_decompressor());
+            in.push(boost::iostreams::array_source(payload.data(),payload.size()));
+            boost::archive::binary_iarchive ia(in);
+            population->loadGenerations(ia);
+        }
+        population->adjustFitness();
+
+        checkpointLogGenerations[filename] = log.getRecord(lastRecord).generation;
+    }
+
     void ExperimentRun::setupExperimentInProgress(
         string populationFileName,
         string _outputFileName
@@ -375,6 +465,15 @@ namespace HCUBE
     {
         outputFileName = _outputFileName;
 
+        bool fromCheckpoint = CheckpointLog::isCheckpointLog(populationFileName);
+
+        if (fromCheckpoint)
+        {
+            //The log carries the parameters along with the population
+            NEAT::Globals::init();
+            loadCheckpoint(populationFileName);
+        }
+        else
         {
             TiXmlDocument doc(populationFileName);
 
@@ -407,11 +506,14 @@ namespace HCUBE
 
         setupExperiment(experimentType,_outputFileName);
 
-        cout << "Experiment set up.  Creating population...\n";
+        if (!fromCheckpoint)
+        {
+            cout << "Experiment set up.  Creating population...\n";
 
-        createPopulation(populationFileName);
+            createPopulation(populationFileName);
 
-        cout << "Population Created\n";
+            cout << "Population Created\n";
+        }
     }
 
     void ExperimentRun::startCondor() {
@@ -425,6 +527,11 @@ namespace HCUBE
 
         // Save the population
         //population->dumpBest(outputFileName, true, true);
+        if (iends_with(outputFileName,".ckpt")) {
+            // savePopulation checks the record checksum, no need to reload the log
+            savePopulation(outputFileName);
+            return;
+        }
         savePopulationBoost(outputFileName);
 
         // Try to load the population to make sure it saved correctly
@@ -450,6 +557,8 @@ namespace HCUBE
             int firstGen = (population->getGenerationCount()-1);
             for (int generations=firstGen;generations<maxGenerations;generations++)
             {
+                NEAT::Profiler::beginGeneration();
+
                 if (generations>firstGen)
                 {
                     //Even if we are loading an existing population,
@@ -494,6 +603,8 @@ namespace HCUBE
                 cout << "Finishing evaluations\n";
                 finishEvaluations();
                 cout << "Evaluations Finished\n";
+
+                NEAT::Profiler::endGeneration(population->getGenerationCount()-1);
             }
             cout << "Experiment finished\n";
 
@@ -507,7 +618,7 @@ namespace HCUBE
             cout << "Done!\n";
 
             cout << "Deleting backup file...";
-            boost::filesystem::remove(outputFileName+string(".backup.xml.gz"));
+            boost::filesystem::remove(outputFileName+string(".backup.ckpt"));
             cout << "Done!\n";
 
 #ifndef _DEBUG
@@ -541,18 +652,42 @@ namespace HCUBE
         experiments[0]->preprocessIndividual(generation, generation->getIndividual(individualId));
         experiments[0]->clearGroup();
         experiments[0]->addIndividualToGroup(generation->getIndividual(individualId));
+        NEAT::Globals::getSingleton()->setRandomStream(generation->getGenerationNumber(),individualId);
         experiments[0]->processGroup(generation);
+        NEAT::Globals::getSingleton()->clearRandomStream();
         return generation->getIndividual(individualId)->getFitness();
     }
  
     void ExperimentRun::evaluatePopulation()
     {
+        NEAT_PROFILE_SCOPE("evaluation");
+
         shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
         //Randomize population order for evaluation
         generation->randomizeIndividualOrder();
 
         int populationSize = population->getIndividualCount();
 
+        //Individuals with a known genome are moved behind the ones that
+        //still need an evaluation
+        int evaluationCount = populationSize;
+        vector<unsigned long long> genomeHashes;
+        vector<shared_ptr<NEAT::GeneticIndividual> > twins;
+        int fitnessCacheSize = 0;
+        if (NEAT::Globals::getSingleton()->hasParameterValue("FitnessCacheSize"))
+        {
+            fitnessCacheSize = int(NEAT::Globals::getSingleton()->getParameterValue("FitnessCacheSize"));
+        }
+        bool useFitnessCache = (fitnessCacheSize>0 && experiments[0]->isFitnessCacheable());
+        if (useFitnessCache)
+        {
+            if (!fitnessCache || fitnessCache->getCapacity()!=fitnessCacheSize)
+            {
+                fitnessCache = shared_ptr<FitnessCache>(new FitnessCache(fitnessCacheSize));
+            }
+            evaluationCount = skipCachedIndividuals(genomeHashes,twins);
+        }
+
         if(NUM_THREADS==1)
         {
             //Bypass the threading logic for a single thread
@@ -561,76 +696,117 @@ namespace HCUBE
                 experiments[0],
                 generation,
                 population->getIndividualIterator(0),
-                populationSize
+                evaluationCount
                 );
             evalSet.run();
         }
         else
         {
-            int populationPerProcess = populationSize/NUM_THREADS;
+            //The pool threads outlive the generation, recreate them only
+            //if the thread count changed
+            if(!evaluationPool || evaluationPool->getThreadCount()!=NUM_THREADS)
+            {
+                evaluationPool.reset();
+                evaluationPool = shared_ptr<EvaluationPool>(new EvaluationPool(NUM_THREADS));
+            }
 
-            boost::thread** threads = new boost::thread*[NUM_THREADS];
-            EvaluationSet** evaluationSets = new EvaluationSet*[NUM_THREADS];
+            evaluationPool->evaluate(
+                experiments,
+                generation,
+                population->getIndividualIterator(0),
+                evaluationCount
+                );
+        }
 
-            for (int i = 0; i < NUM_THREADS; ++i)
-            {
-                if (i+1==NUM_THREADS)
-                {
-                    //Fix for uneven distribution
-                    int populationIteratorSize =
-                        populationSize
-                        - populationPerProcess*(NUM_THREADS-1);
-                    evaluationSets[i] =
-                        new EvaluationSet(
-                            experiments[i],
-                            generation,
-                            population->getIndividualIterator(populationPerProcess*i),
-                            populationIteratorSize
-                            );
-                }
-                else
-                {
+        if (useFitnessCache)
+        {
+            finishCachedIndividuals(evaluationCount,genomeHashes,twins);
+        }
+    }
 
-                    evaluationSets[i] =
-                        new EvaluationSet(
-                            experiments[i],
-                            generation,
-                            population->getIndividualIterator(populationPerProcess*i),
-                            populationPerProcess
-                            );
-                }
+    int ExperimentRun::skipCachedIndividuals(
+        vector<unsigned long long> &genomeHashes,
+        vector<shared_ptr<NEAT::GeneticIndividual> > &twins
+    )
+    {
+        int populationSize = population->getIndividualCount();
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator individuals = population->getIndividualIterator(0);
 
-                threads[i] =
-                    new boost::thread(
-                        boost::bind(
-                            &EvaluationSet::run,
-                            evaluationSets[i]
-                            )
-                        );
-            }
+        vector<shared_ptr<NEAT::GeneticIndividual> > evaluated;
+        vector<shared_ptr<NEAT::GeneticIndividual> > skipped;
+        map<unsigned long long,shared_ptr<NEAT::GeneticIndividual> > firstWithGenome;
+        int cacheHits=0;
+        int repeats=0;
+
+        for (int a=0;a<populationSize;a++)
+        {
+            shared_ptr<NEAT::GeneticIndividual> individual = individuals[a];
+            unsigned long long genomeHash = individual->getGenomeHash();
+
+            map<unsigned long long,shared_ptr<NEAT::GeneticIndividual> >::iterator first =
+                firstWithGenome.find(genomeHash);
+            FitnessCache::Entry entry;
 
-            //loop through each thread, making sure it is finished before we move on
-            for (int i=0;i<NUM_THREADS;++i)
+            if (first!=firstWithGenome.end())
             {
-                /*if (!evaluationSets[i]->isFinished())
-                  {
-                  --i;
-                  boost::xtime xt;
-                  boost::xtime_get(&xt, boost::TIME_UTC);
-                  xt.sec += 1;
-                  boost::thread::sleep(xt); // Sleep for 1/2 second
-                  }*/
-                threads[i]->join();
+                //Gets its fitness once the first copy has one
+                skipped.push_back(individual);
+                twins.push_back(first->second);
+                repeats++;
             }
-
-            for (int i = 0; i < NUM_THREADS; ++i)
+            else if (fitnessCache->lookup(genomeHash,entry))
+            {
+                individual->setFitness(entry.fitness);
+                individual->setUserData(entry.userData);
+                firstWithGenome[genomeHash] = individual;
+                skipped.push_back(individual);
+                twins.push_back(shared_ptr<NEAT::GeneticIndividual>());
+                cacheHits++;
+            }
+            else
             {
-                delete threads[i];
-                delete evaluationSets[i];
+                firstWithGenome[genomeHash] = individual;
+                evaluated.push_back(individual);
+                genomeHashes.push_back(genomeHash);
             }
+        }
+
+        copy(evaluated.begin(),evaluated.end(),individuals);
+        copy(skipped.begin(),skipped.end(),individuals+evaluated.size());
+
+        cout << "Fitness cache: " << cacheHits << " cached and " << repeats << " repeated genomes of "
+             << populationSize << " (" << (100.0*(cacheHits+repeats)/max(1,populationSize))
+             << "% skipped), " << evaluated.size() << " to evaluate.  Overall hit rate "
+             << (100.0*fitnessCache->getHits()/max(1,fitnessCache->getLookups())) << "%, "
+             << fitnessCache->getSize() << " genomes cached\n";
+
+        return int(evaluated.size());
+    }
 
-            delete[] threads;
-            delete[] evaluationSets;
+    void ExperimentRun::finishCachedIndividuals(
+        int evaluationCount,
+        const vector<unsigned long long> &genomeHashes,
+        const vector<shared_ptr<NEAT::GeneticIndividual> > &twins
+    )
+    {
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator individuals = population->getIndividualIterator(0);
+
+        for (int a=0;a<evaluationCount;a++)
+        {
+            FitnessCache::Entry entry;
+            entry.fitness = individuals[a]->getFitness();
+            entry.userData = individuals[a]->getUserData();
+            fitnessCache->insert(genomeHashes[a],entry);
+        }
+
+        for (int a=0;a<(int)twins.size();a++)
+        {
+            if (twins[a])
+            {
+                shared_ptr<NEAT::GeneticIndividual> individual = individuals[evaluationCount+a];
+                individual->setFitness(twins[a]->getFitness());
+                individual->setUserData(twins[a]->getUserData());
+            }
         }
     }
 
@@ -642,8 +818,14 @@ namespace HCUBE
         //int generationDumpModulo = int(NEAT::Globals::getSingleton()->getParameterValue("GenerationDumpModulo"));
         if (cleanup)
             population->cleanupOld(INT_MAX/2);
-        cout << "Dumping best individuals...\n";
-        population->dumpBest(outputFileName+string(".backup.xml"),true,true);
+        cout << "Checkpointing population...\n";
+        string backupFileName = outputFileName+string(".backup.ckpt");
+        if (CheckpointLog(backupFileName).getRecordCount() >= CHECKPOINT_BACKUP_MAX_RECORDS) {
+            // Keep the backup from growing with every generation of a long run
+            compactCheckpoint(backupFileName);
+        } else {
+            appendCheckpoint(backupFileName);
+        }
         //population->cleanupOld(25);
         //population->dumpBest("out/dumpBestWithGenes(backup).xml",true);
 
@@ -0,0 +1,56 @@
+#include "HCUBE_Defines.h"
+
+#include "HCUBE_FitnessCache.h"
+
+namespace HCUBE
+{
+    FitnessCache::FitnessCache(int _capacity)
+        :
+        capacity(_capacity),
+        lookups(0),
+        hits(0)
+    {
+        if (capacity<1)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Tried to create a fitness cache with no capacity!");
+        }
+    }
+
+    bool FitnessCache::lookup(unsigned long long genomeHash,Entry &entry)
+    {
+        lookups++;
+
+        map<unsigned long long,pair<Entry,list<unsigned long long>::iterator> >::iterator it =
+            entries.find(genomeHash);
+        if (it==entries.end())
+        {
+            return false;
+        }
+
+        recentHashes.splice(recentHashes.begin(),recentHashes,it->second.second);
+        entry = it->second.first;
+        hits++;
+        return true;
+    }
+
+    void FitnessCache::insert(unsigned long long genomeHash,const Entry &entry)
+    {
+        map<unsigned long long,pair<Entry,list<unsigned long long>::iterator> >::iterator it =
+            entries.find(genomeHash);
+        if (it!=entries.end())
+        {
+            it->second.first = entry;
+            recentHashes.splice(recentHashes.begin(),recentHashes,it->second.second);
+            return;
+        }
+
+        if ((int)entries.size()>=capacity)
+        {
+            entries.erase(recentHashes.back());
+            recentHashes.pop_back();
+        }
+
+        recentHashes.push_front(genomeHash);
+        entries.insert(make_pair(genomeHash,make_pair(entry,recentHashes.begin())));
+    }
+}
@@ -6,132 +6,146 @@
 
 namespace HCUBE
 {
-    boost::mutex mpiMutex;
-
-    void MPIEvaluationSet::run()
+    namespace
     {
-#if MPI_EVALUATION_SET_DEBUG
-        cout << targetProcessor << " MAIN) Starting EvaluationSet\n";
-#endif
-
-        try
+        /**
+        * Evaluates the group that was added to the experiment, drawing random
+        * numbers from the stream of its first individual
+        */
+        void processGroup(
+            shared_ptr<Experiment> experiment,
+            shared_ptr<NEAT::GeneticGeneration> generation,
+            int groupStart
+        )
         {
-            //Process individuals sequentially
-            running=true;
-
-            vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator;
+            NEAT::Globals::getSingleton()->setRandomStream(generation->getGenerationNumber(),groupStart);
+            try
+            {
+                experiment->processGroup(generation);
+            }
+            catch (...)
+            {
+                NEAT::Globals::getSingleton()->clearRandomStream();
+                throw;
+            }
+            NEAT::Globals::getSingleton()->clearRandomStream();
+        }
 
-            ostringstream ostr;
+        void receiveMessage(const MPI_Status &probeStatus,vector<char> &buffer,int &size)
+        {
+            MPI_Status status = probeStatus;
+            MPI_Get_count(&status,MPI_BYTE,&size);
 
-            if (targetProcessor!=0)
+            if ((int)buffer.size()<size)
             {
-                int testCount = 0;
+                buffer.resize(size);
+            }
 
-#ifdef EPLEX_INTERNAL
-                if (dynamic_cast<NEAT::CoEvoExperiment*>(experiment.get()))
-                {
-                    shared_ptr<NEAT::CoEvoGeneticGeneration> gen =
-                        static_pointer_cast<NEAT::CoEvoGeneticGeneration>(generation);
+            MPI_Recv(
+                size ? &buffer[0] : NULL,
+                size,
+                MPI_BYTE,
+                probeStatus.MPI_SOURCE,
+                probeStatus.MPI_TAG,
+                MPI_COMM_WORLD,
+                &status
+            );
+        }
+    }
 
-                    testCount = gen->getTestCount();
-                }
-#endif
+    MPIEvaluationSet::MPIEvaluationSet(
+        shared_ptr<Experiment> _experiment,
+        shared_ptr<NEAT::GeneticGeneration> _generation,
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator _individualIterator,
+        int _individualCount
+    )
+            :
+            EvaluationSet(
+                _experiment,
+                _generation,
+                _individualIterator,
+                _individualCount
+            ),
+            nextTask(0)
+    {
+        MPI_Comm_size(MPI_COMM_WORLD,&processCount);
 
-                ostr << testCount << " ";
+        groupCapacity = experiment->getGroupCapacity();
+        taskCount = individualCount/groupCapacity;
 
-#ifdef EPLEX_INTERNAL
-                if (dynamic_cast<NEAT::CoEvoExperiment*>(experiment.get()))
-                {
-#if MPI_EVALUATION_SET_DEBUG
-                    cout << targetProcessor << " MAIN) Sending tests...\n";
-#endif
-                    shared_ptr<NEAT::CoEvoGeneticGeneration> gen =
-                        static_pointer_cast<NEAT::CoEvoGeneticGeneration>(generation);
-
-                    int testCount = gen->getTestCount();
+        int slotCount = (processCount-1)*MPI_TASKS_PER_WORKER;
+        slotTasks.resize(slotCount,-1);
+        slotBuffers.resize(slotCount);
+        slotRequests.resize(slotCount,MPI_REQUEST_NULL);
+    }
 
-                    for (int a=0;a<testCount;a++)
-                    {
-                        shared_ptr<NEAT::GeneticIndividual> testInd =
-                            gen->getTest(a);
+    void MPIEvaluationSet::run()
+    {
+        try
+        {
+            running=true;
 
-                        testInd->dump(ostr);
-                    }
-                }
-#endif
+            if (individualCount%groupCapacity)
+            {
+                //Oops, maybe you specified a bad population size?
+                throw CREATE_LOCATEDEXCEPTION_INFO("Error, the population doesn't divide into groups!");
             }
 
-            ostr << individualCount << " ";
-
-#if MPI_EVALUATION_SET_DEBUG
-            cout << targetProcessor << " MAIN) Collecting individuals...\n";
-#endif
-
-            tmpIterator = individualIterator;
-            for (int a=0;a<individualCount;a++,tmpIterator++)
+            if (processCount==1)
             {
-                while (!running)
+                //No workers, so evaluate every group here
+                while (nextTask<taskCount)
                 {
-                    boost::xtime xt;
-                    boost::xtime_get(&xt, boost::TIME_UTC);
-                    xt.sec += 1;
-                    boost::thread::sleep(xt); // Sleep for 1 second
+                    evaluateTask(nextTask++);
                 }
+                finished=true;
+                return;
+            }
 
-                if (targetProcessor==0)
-                {
-                    //main processor, just perform the experiment
-                }
-                else
+            sendGeneration();
+
+            //Deal the first tasks round robin so every worker starts right away
+            for (int slot=0;slot<MPI_TASKS_PER_WORKER;slot++)
+            {
+                for (int worker=1;worker<processCount && nextTask<taskCount;worker++)
                 {
-                    //other processor, package the individuals for transfer
-                    (*tmpIterator)->dump(ostr);
+                    sendTask(worker,slot);
                 }
             }
 
-            if (targetProcessor==0)
+            //The master only hands out tasks, so it answers every result
+            //right away and no worker waits on it
+            while (getOutstandingTaskCount()>0)
             {
+                MPI_Status status;
+                MPI_Probe(MPI_ANY_SOURCE,RESULT_TAG,MPI_COMM_WORLD,&status);
+
+                //Also sends the worker its next task
+                receiveResult(status);
             }
-            else
+
+            if (slotRequests.size())
             {
+                MPI_Waitall((int)slotRequests.size(),&slotRequests[0],MPI_STATUSES_IGNORE);
+            }
 
 #if MPI_EVALUATION_SET_DEBUG
-                cout << targetProcessor << " MAIN) Sending individuals...\n";
+            cout << "MAIN) Done with EvaluationSet!\n";
 #endif
 
-                string str = ostr.str();
-
-                char *buffer = new char[str.length()+1];
-
-                memcpy(buffer,str.c_str(),str.length());
-
-                buffer[str.length()] = '\0'; //null terminate
-
-                int lengthInt = (int)str.length() + 1;
-
-                {
-                    boost::mutex::scoped_lock lock(mpiMutex);
-                    MPI_Send (&lengthInt,1,MPI_INT,targetProcessor,INDIVIDUAL_GENOMES_TAG,MPI_COMM_WORLD);
-                    MPI_Send (buffer,lengthInt,MPI_CHAR,targetProcessor,INDIVIDUAL_GENOMES_TAG,MPI_COMM_WORLD);
-                }
-
-                delete[] buffer;
-            }
+            finished=true;
         }
         catch (string s)
         {
             cout << "ERROR: " << s << endl;
-            //CREATE_PAUSE(s);
         }
         catch (const char *s)
         {
             cout << "ERROR: " << s << endl;
-            //CREATE_PAUSE(s);
         }
         catch (const std::exception &ex)
         {
             cout << "ERROR: " << ex.what() << endl;
-            //CREATE_PAUSE(ex.what());
         }
         catch (...)
         {
@@ -139,141 +153,286 @@ namespace HCUBE
         }
     }
 
-    void MPIEvaluationSet::collectData()
+    int MPIEvaluationSet::getOutstandingTaskCount()
     {
-#if MPI_EVALUATION_SET_DEBUG
-        cout << targetProcessor << " MAIN) Starting EvaluationSet\n";
+        int count=0;
+        for (int a=0;a<(int)slotTasks.size();a++)
+        {
+            if (slotTasks[a]!=-1)
+            {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void MPIEvaluationSet::sendGeneration()
+    {
+        generationBuffer.clear();
+        NEAT::BinaryWriter writer(generationBuffer);
+
+        writer.write<int>(generation->getGenerationNumber());
+
+        //Workers seeded from the clock have another seed, so they take the
+        //master's and derive the same random streams from it
+        writer.write<unsigned int>(NEAT::Globals::getSingleton()->getRandom().getSeed());
+
+        int testCount = 0;
+
+#ifdef EPLEX_INTERNAL
+        if (dynamic_cast<NEAT::CoEvoExperiment*>(experiment.get()))
+        {
+            shared_ptr<NEAT::CoEvoGeneticGeneration> gen =
+                static_pointer_cast<NEAT::CoEvoGeneticGeneration>(generation);
+
+            testCount = gen->getTestCount();
+        }
 #endif
 
-        try
+        writer.write<int>(testCount);
+
+#ifdef EPLEX_INTERNAL
+        for (int a=0;a<testCount;a++)
         {
-            //Process individuals sequentially
-            running=true;
+            static_pointer_cast<NEAT::CoEvoGeneticGeneration>(generation)->getTest(a)->dump(writer);
+        }
+#endif
 
-            vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator;
+#if MPI_EVALUATION_SET_DEBUG
+        cout << "MAIN) Sending generation of " << generationBuffer.size() << " bytes\n";
+#endif
 
-            ostringstream ostr;
+        for (int worker=1;worker<processCount;worker++)
+        {
+            MPI_Send(
+                &generationBuffer[0],
+                (int)generationBuffer.size(),
+                MPI_BYTE,
+                worker,
+                GENERATION_TAG,
+                MPI_COMM_WORLD
+            );
+        }
+    }
 
-            tmpIterator = individualIterator;
-            for (int a=0;a<individualCount;a++,tmpIterator++)
-            {
-                while (!running)
-                {
-                    boost::xtime xt;
-                    boost::xtime_get(&xt, boost::TIME_UTC);
-                    xt.sec += 1;
-                    boost::thread::sleep(xt); // Sleep for 1 second
-                }
+    void MPIEvaluationSet::sendTask(int worker,int slot)
+    {
+        int slotIndex = (worker-1)*MPI_TASKS_PER_WORKER+slot;
+        int task = nextTask++;
 
-                if (targetProcessor==0)
-                {
-                    //main processor, just perform the experiment
-                    experiment->addIndividualToGroup(*tmpIterator);
+        //The buffer may still be on its way from the last task in this slot
+        MPI_Wait(&slotRequests[slotIndex],MPI_STATUS_IGNORE);
 
-                    if (experiment->getGroupSize()==experiment->getGroupCapacity())
-                    {
-                        //cout << "Processing group...\n";
-                        experiment->processGroup(generation);
-                        //cout << "Done Processing group\n";
-                        experiment->clearGroup();
-                    }
+        vector<char> &buffer = slotBuffers[slotIndex];
+        buffer.clear();
+        NEAT::BinaryWriter writer(buffer);
 
-                    if ((*tmpIterator)->getFitness() <= 1e-6)
-                    {
-                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR, 0 Fitness");
-                    }
-                }
-            }
+        writer.write<int>(firstIndividualIndex+task*groupCapacity);
+        writer.write<int>(groupCapacity);
 
-            if (targetProcessor==0)
-            {
-                if (experiment->getGroupSize()>0)
-                {
-                    //Oops, maybe you specified a bad # of threads?
-                    throw CREATE_LOCATEDEXCEPTION_INFO("Error, individuals were left over after run finished!");
-                }
-            }
-            else
-            {
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator =
+            individualIterator+task*groupCapacity;
+        for (int a=0;a<groupCapacity;a++,tmpIterator++)
+        {
+            (*tmpIterator)->dump(writer);
+        }
+
+        slotTasks[slotIndex] = task;
 
 #if MPI_EVALUATION_SET_DEBUG
-                cout << targetProcessor << " MAIN) Waiting for results...\n";
+        cout << "MAIN) Sending task " << task << " to " << worker << endl;
 #endif
 
-				int msgSize = 0;
-				char *buffer = NULL;
+        MPI_Isend(
+            &buffer[0],
+            (int)buffer.size(),
+            MPI_BYTE,
+            worker,
+            TASK_TAG,
+            MPI_COMM_WORLD,
+            &slotRequests[slotIndex]
+        );
+    }
 
-                {
-                    boost::mutex::scoped_lock lock(mpiMutex);
-                    MPI_Status Stat;
-                    //MPI_Recv (newFitness,individualCount,MPI_DOUBLE,targetProcessor,NEW_FITNESSES_TAG,MPI_COMM_WORLD,&Stat);
-					MPI_Recv (&msgSize,1,MPI_INT,targetProcessor,NEW_INDIVIDUALS_TAG,MPI_COMM_WORLD,&Stat);
+    void MPIEvaluationSet::receiveResult(const MPI_Status &probeStatus)
+    {
+        int size;
+        receiveMessage(probeStatus,receiveBuffer,size);
+
+        NEAT::BinaryReader reader(size ? &receiveBuffer[0] : NULL,size);
+
+        int groupStart = reader.read<int>()-firstIndividualIndex;
+        int groupSize = reader.read<int>();
+
+        if (groupStart<0 || groupSize!=groupCapacity || groupStart+groupSize>individualCount)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Error, got a result for a group that wasn't sent!");
+        }
+
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator =
+            individualIterator+groupStart;
+        for (int a=0;a<groupSize;a++,tmpIterator++)
+        {
+            (*tmpIterator)->setFitness(reader.read<double>());
+            (*tmpIterator)->setUserData(reader.readString());
+        }
+
+        int worker = probeStatus.MPI_SOURCE;
+        int task = groupStart/groupCapacity;
 
 #if MPI_EVALUATION_SET_DEBUG
-					cout << targetProcessor << " MAIN) Got Message of size " << msgSize << "...\n";
+        cout << "MAIN) Got task " << task << " from " << worker << endl;
 #endif
 
-					buffer = new char[msgSize];
-					MPI_Recv (buffer,msgSize,MPI_CHAR,targetProcessor,NEW_INDIVIDUALS_TAG,MPI_COMM_WORLD,&Stat);
+        for (int slot=0;slot<MPI_TASKS_PER_WORKER;slot++)
+        {
+            int slotIndex = (worker-1)*MPI_TASKS_PER_WORKER+slot;
+
+            if (slotTasks[slotIndex]==task)
+            {
+                slotTasks[slotIndex] = -1;
+
+                if (nextTask<taskCount)
+                {
+                    sendTask(worker,slot);
                 }
-				istringstream istr(buffer);
+                return;
+            }
+        }
+
+        throw CREATE_LOCATEDEXCEPTION_INFO("Error, got a result for a group that wasn't sent!");
+    }
+
+    void MPIEvaluationSet::evaluateTask(int task)
+    {
+        vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator =
+            individualIterator+task*groupCapacity;
+        for (int a=0;a<groupCapacity;a++,tmpIterator++)
+        {
+            experiment->addIndividualToGroup(*tmpIterator);
+        }
+
+        processGroup(experiment,generation,firstIndividualIndex+task*groupCapacity);
+
+        experiment->clearGroup();
+    }
+
+    void MPIEvaluationSet::runWorker(shared_ptr<Experiment> experiment)
+    {
+        shared_ptr<NEAT::GeneticGeneration> generation;
+
+        vector<char> receiveBuffer;
+
+        //Double buffered so a result can be in flight while the next group runs
+        vector<char> resultBuffers[2];
+        MPI_Request resultRequests[2] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+        int nextResultBuffer=0;
+
+        for (;;)
+        {
+            MPI_Status status;
+            MPI_Probe(0,MPI_ANY_TAG,MPI_COMM_WORLD,&status);
+
+            int size;
+            receiveMessage(status,receiveBuffer,size);
+
+            if (status.MPI_TAG==DIE_TAG)
+            {
+                break;
+            }
 
-                tmpIterator = individualIterator;
-                for (int a=0;a<individualCount;a++,tmpIterator++)
+            NEAT::BinaryReader reader(size ? &receiveBuffer[0] : NULL,size);
+
+            if (status.MPI_TAG==GENERATION_TAG)
+            {
+                int generationNumber = reader.read<int>();
+                unsigned int seed = reader.read<unsigned int>();
+                int testCount = reader.read<int>();
+
+                if (NEAT::Globals::getSingleton()->getRandom().getSeed()!=seed)
                 {
-					(*tmpIterator) = shared_ptr<NEAT::GeneticIndividual>(
-										new NEAT::GeneticIndividual(istr)
-										);
-				}
+                    NEAT::Globals::getSingleton()->seedRandom(seed);
+                }
 
 #if MPI_EVALUATION_SET_DEBUG
-                cout << targetProcessor << " MAIN) Received new fitness values\n";
+                cout << "WORKER) Generation " << generationNumber << " with " << testCount << " tests\n";
 #endif
 
-				/*
-                tmpIterator = individualIterator;
-                for (int a=0;a<individualCount;a++,tmpIterator++)
+#ifdef EPLEX_INTERNAL
+                if (testCount)
                 {
-                    if (fabs(newFitness[a])<1e-6)
+                    shared_ptr<NEAT::CoEvoGeneticGeneration> coEvoGen(
+                        new NEAT::CoEvoGeneticGeneration(
+                            generationNumber,
+                            dynamic_pointer_cast<NEAT::CoEvoExperiment>(experiment)
+                        )
+                    );
+
+                    for (int a=0;a<testCount;a++)
                     {
-                        throw CREATE_LOCATEDEXCEPTION_INFO("Error, 0 fitness!");
+                        coEvoGen->addTestHack(shared_ptr<NEAT::GeneticIndividual>(new NEAT::GeneticIndividual(reader)));
                     }
-#if MPI_EVALUATION_SET_DEBUG
-                    cout << targetProcessor << " MAIN) fitness: " << newFitness[a] << "\n";
+
+                    generation = coEvoGen;
+                }
+                else
 #endif
-                    (*tmpIterator)->setFitness(newFitness[a]);
+                {
+                    generation = shared_ptr<NEAT::GeneticGeneration>(
+                        new NEAT::GeneticGeneration(generationNumber)
+                    );
+                }
+            }
+            else if (status.MPI_TAG==TASK_TAG)
+            {
+                if (!generation)
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO("Error, got a task before its generation!");
                 }
-				*/
 
+                int groupStart = reader.read<int>();
+                int groupSize = reader.read<int>();
 
-                delete[] buffer;
-                //delete[] newFitness;
-            }
+                for (int a=0;a<groupSize;a++)
+                {
+                    experiment->addIndividualToGroup(
+                        shared_ptr<NEAT::GeneticIndividual>(new NEAT::GeneticIndividual(reader))
+                    );
+                }
 
-#if MPI_EVALUATION_SET_DEBUG
-            cout << targetProcessor << " MAIN) Done with EvaluationSet!\n";
-#endif
+                processGroup(experiment,generation,groupStart);
 
-            finished=true;
-        }
-        catch (string s)
-        {
-            cout << "ERROR: " << s << endl;
-            //CREATE_PAUSE(s);
-        }
-        catch (const char *s)
-        {
-            cout << "ERROR: " << s << endl;
-            //CREATE_PAUSE(s);
-        }
-        catch (const std::exception &ex)
-        {
-            cout << "ERROR: " << ex.what() << endl;
-            //CREATE_PAUSE(ex.what());
-        }
-        catch (...)
-        {
-            cout << "An unknown exception has occured!" << endl;
+                MPI_Wait(&resultRequests[nextResultBuffer],MPI_STATUS_IGNORE);
+
+                vector<char> &buffer = resultBuffers[nextResultBuffer];
+                buffer.clear();
+                NEAT::BinaryWriter writer(buffer);
+
+                writer.write<int>(groupStart);
+                writer.write<int>(groupSize);
+
+                for (int a=0;a<groupSize;a++)
+                {
+                    writer.write<double>(experiment->getGroupMember(a)->getFitness());
+                    writer.writeString(experiment->getGroupMember(a)->getUserData());
+                }
+
+                experiment->clearGroup();
+
+                MPI_Isend(
+                    &buffer[0],
+                    (int)buffer.size(),
+                    MPI_BYTE,
+                    0,
+                    RESULT_TAG,
+                    MPI_COMM_WORLD,
+                    &resultRequests[nextResultBuffer]
+                );
+
+                nextResultBuffer = 1-nextResultBuffer;
+            }
         }
+
+        MPI_Waitall(2,resultRequests,MPI_STATUSES_IGNORE);
     }
 }
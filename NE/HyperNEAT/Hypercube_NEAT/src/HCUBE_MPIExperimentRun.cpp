@@ -25,6 +25,8 @@ namespace HCUBE
 
     void MPIExperimentRun::evaluatePopulation()
     {
+        NEAT_PROFILE_SCOPE("evaluation");
+
         try
         {
             shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
@@ -33,81 +35,14 @@ namespace HCUBE
 
             int populationSize = population->getIndividualCount();
 
-            int numThreads;
-
-            MPI_Comm_size(MPI_COMM_WORLD,&numThreads);
-
-            cout << "Number of threads: " << numThreads << endl;
-
-            //NOTE: YOU SHOULD NEVER HAVE MORE THREADS THAN INDIVIDUALS!
-            int populationPerProcess = populationSize/numThreads;
-
-            boost::thread** threads = new boost::thread*[numThreads];
-            MPIEvaluationSet** MPIEvaluationSets = new MPIEvaluationSet*[numThreads];
-
-            for (int i = 0; i < numThreads; ++i)
-            {
-                if (i+1==numThreads)
-                {
-                    //Fix for uneven distribution
-                    int populationIteratorSize =
-                        populationSize
-                        - populationPerProcess*(numThreads-1);
-                    MPIEvaluationSets[i] =
-                        new MPIEvaluationSet(
-                        experiments[0],
-                        generation,
-                        population->getIndividualIterator(populationPerProcess*i),
-                        populationIteratorSize,
-                        i
-                    );
-
-                    //MPIEvaluationSets[i]->run();
-                }
-                else
-                {
-
-                    MPIEvaluationSets[i] =
-                        new MPIEvaluationSet(
-                        experiments[0],
-                        generation,
-                        population->getIndividualIterator(populationPerProcess*i),
-                        populationPerProcess,
-                        i
-                    );
-
-                    //MPIEvaluationSets[i]->run();
-                }
+            MPIEvaluationSet evaluationSet(
+                experiments[0],
+                generation,
+                population->getIndividualIterator(0),
+                populationSize
+            );
 
-                threads[i] =
-                    new boost::thread(
-                    boost::bind(
-                        &MPIEvaluationSet::run,
-                        MPIEvaluationSets[i]
-                    )
-                );
-            }
-
-            //loop through each thread, making sure it is finished before we move on
-            for (int i=0;i<numThreads;++i)
-            {
-                threads[i]->join();
-                delete threads[i];
-                threads[i] =
-                    new boost::thread(
-                    boost::bind(
-                        &MPIEvaluationSet::collectData,
-                        MPIEvaluationSets[i]
-                    )
-                );
-            }
-
-            for (int i = 0; i < numThreads; ++i)
-            {
-                threads[i]->join();
-                delete threads[i];
-                delete MPIEvaluationSets[i];
-            }
+            evaluationSet.run();
 
             for (int a=0;a<populationSize;a++)
             {
@@ -118,9 +53,6 @@ namespace HCUBE
                     throw CREATE_LOCATEDEXCEPTION_INFO(string("ERROR: 0 fitness for individual: ")+toString(a));
                 }
             }
-
-            delete threads;
-            delete MPIEvaluationSets;
         }
         catch (const std::exception &ex)
         {
@@ -11,6 +11,12 @@
 #include "Experiments/HCUBE_AtariFTNeatExperiment.h"
 #include "Experiments/HCUBE_AtariIntrinsicExperiment.h"
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <csignal>
+
 #ifndef HCUBE_NOGUI
 namespace HCUBE
 {
@@ -22,15 +28,261 @@ using namespace boost;
 using namespace HCUBE;
 using namespace NEAT;
 
+namespace {
+    /**
+     * AtariEvaluator evaluates individuals of the population loaded into an
+     * ExperimentRun.  The experiments load the rom the first time they are
+     * needed and keep it, so a server can evaluate any number of individuals
+     * and generations with a single rom load.
+     */
+    class AtariEvaluator {
+    protected:
+        HCUBE::ExperimentRun &experimentRun;
+        int experimentType;
+        string romFile;
+
+        bool experimentInitialized;
+        bool hybridExperimentsInitialized;
+        bool ftNeatActive;
+
+    public:
+        AtariEvaluator(HCUBE::ExperimentRun &_experimentRun, int _experimentType, string _romFile)
+            :
+            experimentRun(_experimentRun),
+            experimentType(_experimentType),
+            romFile(_romFile),
+            experimentInitialized(false),
+            hybridExperimentsInitialized(false),
+            ftNeatActive(false)
+        {}
+
+        float evaluate(unsigned int individualId) {
+            if (experimentType == 33) {
+                return evaluateHybrid(individualId);
+            }
+
+            if (!experimentInitialized) {
+                // Cast the experiment into the correct subclass and initialize with rom file
+                shared_ptr<Experiment> e = experimentRun.getExperiment();
+                if (experimentType == 30 || experimentType == 35 || experimentType == 36) {
+                    shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
+                    exp->initializeExperiment(romFile.c_str());
+                } else if (experimentType == 31) {
+                    shared_ptr<AtariNoGeomExperiment> exp = static_pointer_cast<AtariNoGeomExperiment>(e);
+                    exp->initializeExperiment(romFile.c_str());
+                } else if (experimentType == 32) {
+                    shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
+                    exp->initializeExperiment(romFile.c_str());
+                } else if (experimentType == 34) {
+                    shared_ptr<AtariIntrinsicExperiment> exp = static_pointer_cast<AtariIntrinsicExperiment>(e);
+                    exp->initializeExperiment(romFile.c_str());
+                }
+                experimentInitialized = true;
+            }
+
+            return experimentRun.evaluateIndividual(individualId);
+        }
+
+    protected:
+        // The Hybrid experiment can be either HyperNEAT or FT-NEAT
+        float evaluateHybrid(unsigned int individualId) {
+            Globals* globals = Globals::getSingleton();
+
+            // Experiment 0 is HyperNEAT, experiment 1 is FT-NEAT until they are swapped
+            if (!hybridExperimentsInitialized) {
+                static_pointer_cast<AtariExperiment>(experimentRun.getExperiment())->initializeExperiment(romFile.c_str());
+                experimentRun.setActiveExperiment(1);
+                static_pointer_cast<AtariFTNeatExperiment>(experimentRun.getExperiment())->initializeExperiment(romFile.c_str());
+                experimentRun.setActiveExperiment(1);
+                hybridExperimentsInitialized = true;
+            }
+
+            bool conversionFinished =
+                globals->hasParameterValue("HybridConversionFinished") &&
+                globals->getParameterValue("HybridConversionFinished") == 1.0;
+
+            if (conversionFinished) {
+                // Make the FT-NEAT experiment active
+                if (!ftNeatActive) {
+                    experimentRun.setActiveExperiment(1);
+                    ftNeatActive = true;
+                }
+                return experimentRun.evaluateIndividual(individualId);
+            }
+
+            if (ftNeatActive) {
+                experimentRun.setActiveExperiment(1);
+                ftNeatActive = false;
+            }
+
+            // This is a nasty-hack like short circuit of the
+            // normal evaluation procedure. It is used for
+            // HyperNEAT evaluation in Hybrid experiments. The
+            // crux of this method is to convert the hyperneat
+            // indvidual to be evaluated into a FT-individual and
+            // then perform the eval using FT methods. This should
+            // ensure that when the swap is done, fitness does not
+            // drop off as a result of using different types of
+            // networks to evaluate individuals.
+            // This is the early generational case before the swap has happened
+            shared_ptr<AtariExperiment> atariExp = static_pointer_cast<AtariExperiment>(experimentRun.getExperiment());
+            experimentRun.setActiveExperiment(1);
+            shared_ptr<AtariFTNeatExperiment> ftExp = static_pointer_cast<AtariFTNeatExperiment>(experimentRun.getExperiment());
+            experimentRun.setActiveExperiment(1);
+
+            // Get the individual to evaluate
+            shared_ptr<NEAT::GeneticPopulation> population = experimentRun.getPopulation();
+            shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
+            shared_ptr<NEAT::GeneticIndividual> HyperNEAT_individual = generation->getIndividual(individualId);
+            atariExp->substrate.populateSubstrate(HyperNEAT_individual);
+            NEAT::LayeredSubstrate<float>* HyperNEAT_substrate = &atariExp->substrate;
+            GeneticPopulation* FTNEAT_population = ftExp->createInitialPopulation(1);
+            shared_ptr<GeneticIndividual> FTNEAT_individual = FTNEAT_population->getGeneration()->getIndividual(0);
+            ftExp->convertIndividual(FTNEAT_individual, HyperNEAT_substrate);
+            globals->setRandomStream(generation->getGenerationNumber(), individualId);
+            ftExp->evaluateIndividual(FTNEAT_individual);
+            globals->clearRandomStream();
+            float fitness = FTNEAT_individual->getFitness();
+            delete FTNEAT_population;
+            return fitness;
+        }
+    };
+
+    void writeFitness(const string &individualFitnessFile, float fitness) {
+        cout << "[HyperNEAT core] Fitness found to be " << fitness << ". Writing to: " <<
+            individualFitnessFile << endl;
+        ofstream fout(individualFitnessFile.c_str());
+        fout << fitness << endl;
+        fout.close();
+        cout << "[HyperNEAT core] Individual evaluation fin." << endl;
+    }
+
+    /**
+     * Answers one request line from a server client.  Requests are
+     *     LOAD (populationfile)       -> OK
+     *     EVAL (id) (id) ...          -> FITNESS (fitness) (fitness) ...
+     *     QUIT                        -> BYE
+     * and any failure is answered with ERROR (message).  Returns false on QUIT.
+     */
+    bool handleRequest(const string &request, HCUBE::ExperimentRun &experimentRun,
+                       AtariEvaluator &evaluator, bool &populationLoaded, string &response) {
+        istringstream input(request);
+        string command;
+        input >> command;
+
+        try {
+            if (command == "LOAD") {
+                string populationFile;
+                input >> populationFile;
+                experimentRun.createPopulation(populationFile);
+                populationLoaded = true;
+                cout << "[HyperNEAT core] Population loaded from " << populationFile << endl;
+                response = "OK";
+            } else if (command == "EVAL") {
+                if (!populationLoaded) {
+                    response = "ERROR no population loaded";
+                    return true;
+                }
+                ostringstream output;
+                output << "FITNESS";
+                unsigned int individualId;
+                while (input >> individualId) {
+                    if (individualId >= (unsigned int)experimentRun.getPopulation()->getIndividualCount()) {
+                        response = "ERROR individual " + toString(individualId) + " out of range";
+                        return true;
+                    }
+                    output << ' ' << evaluator.evaluate(individualId);
+                }
+                response = output.str();
+            } else if (command == "QUIT") {
+                response = "BYE";
+                return false;
+            } else {
+                response = "ERROR unknown command " + command;
+            }
+        } catch (const std::exception &ex) {
+            response = string("ERROR ") + ex.what();
+        } catch (string s) {
+            response = "ERROR " + s;
+        }
+
+        return true;
+    }
+
+    /**
+     * Serves evaluation requests on a unix domain socket until a client sends QUIT.
+     * Clients are served one at a time, one request per line.
+     */
+    void runServer(const string &socketPath, HCUBE::ExperimentRun &experimentRun, AtariEvaluator &evaluator) {
+        int listenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenSocket < 0) {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Could not create the server socket!");
+        }
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Server socket path is too long!");
+        }
+        strcpy(address.sun_path, socketPath.c_str());
+        unlink(socketPath.c_str());
+
+        if (::bind(listenSocket, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, 1) != 0) {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not listen on ") + socketPath);
+        }
+        cout << "[HyperNEAT core] Evaluation server listening on " << socketPath << endl;
+
+        // A client that disconnects mid-response must not kill the server
+        signal(SIGPIPE, SIG_IGN);
+
+        bool populationLoaded = false;
+        bool serving = true;
+        while (serving) {
+            int clientSocket = ::accept(listenSocket, NULL, NULL);
+            if (clientSocket < 0) {
+                continue;
+            }
+
+            FILE *in = fdopen(clientSocket, "r");
+            FILE *out = fdopen(dup(clientSocket), "w");
+
+            char buffer[4096];
+            string request;
+            while (serving && fgets(buffer, sizeof(buffer), in)) {
+                request += buffer;
+                if (request.empty() || request[request.size()-1] != '\n') {
+                    continue; // Long request, keep reading
+                }
+
+                string response;
+                serving = handleRequest(request, experimentRun, evaluator, populationLoaded, response);
+                fprintf(out, "%s\n", response.c_str());
+                fflush(out);
+                request.clear();
+            }
+
+            fclose(out);
+            fclose(in);
+        }
+
+        close(listenSocket);
+        unlink(socketPath.c_str());
+    }
+}
+
 int HyperNEAT_main(int argc,char **argv) {
     CommandLineParser commandLineParser(argc,argv);
     Globals* globals = Globals::init();
 
+    bool serverMode = commandLineParser.HasSwitch("-S"); // Socket to serve evaluations on
+
     if (commandLineParser.HasSwitch("-I") && // Experiment params
-        commandLineParser.HasSwitch("-F") && // Fitness file to write to
-        commandLineParser.HasSwitch("-P") && // Population file to read from
-        commandLineParser.HasSwitch("-N") && // Individual number within pop file
-        commandLineParser.HasSwitch("-G"))   // Rom file to run
+        commandLineParser.HasSwitch("-G") && // Rom file to run
+        (serverMode ||
+         (commandLineParser.HasSwitch("-F") && // Fitness file to write to
+          commandLineParser.HasSwitch("-P") && // Population file to read from
+          commandLineParser.HasSwitch("-N"))))   // Individual number within pop file
     {
 
         globals = Globals::init(commandLineParser.GetArgument("-I",0));
@@ -46,94 +298,28 @@ int HyperNEAT_main(int argc,char **argv) {
         HCUBE::ExperimentRun experimentRun;
         experimentRun.setupExperiment(experimentType, "output.xml");
 
-        string populationFile = commandLineParser.GetArgument("-P",0);
-        experimentRun.createPopulation(populationFile);
-        cout << "[HyperNEAT core] Population Created\n";
+        string rom_file = commandLineParser.GetArgument("-G",0);
+        AtariEvaluator evaluator(experimentRun, experimentType, rom_file);
 
-        unsigned int individualId = stringTo<unsigned int>(commandLineParser.GetArgument("-N",0));
-        cout << "[HyperNEAT core] Evaluating individual: " << individualId << endl;
+        if (serverMode) {
+            runServer(commandLineParser.GetArgument("-S",0), experimentRun, evaluator);
+        } else {
+            string populationFile = commandLineParser.GetArgument("-P",0);
+            experimentRun.createPopulation(populationFile);
+            cout << "[HyperNEAT core] Population Created\n";
 
-        // Cast the experiment into the correct subclass and initialize with rom file
-        string rom_file = commandLineParser.GetArgument("-G",0);
-        shared_ptr<Experiment> e = experimentRun.getExperiment();
-        if (experimentType == 30 || experimentType == 35 || experimentType == 36) {
-            shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 31) {
-            shared_ptr<AtariNoGeomExperiment> exp = static_pointer_cast<AtariNoGeomExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 32) {
-            shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 33) {
-            // This is the Hybrid experiment and can thus be either HyperNEAT or FT-NEAT
-            if (globals->hasParameterValue("HybridConversionFinished") &&
-                globals->getParameterValue("HybridConversionFinished") == 1.0) {
-                // Make the FT-NEAT experiment active
-                experimentRun.setActiveExperiment(1);
-                e = experimentRun.getExperiment();
-                shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
-                exp->initializeExperiment(rom_file.c_str());
-            } else {
-                // shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
-                // exp->initializeExperiment(rom_file.c_str());
-
-                // This is a nasty-hack like short circuit of the
-                // normal evaluation procedure. It is used for
-                // HyperNEAT evaluation in Hybrid experiments. The
-                // crux of this method is to convert the hyperneat
-                // indvidual to be evaluated into a FT-individual and
-                // then perform the eval using FT methods. This should
-                // ensure that when the swap is done, fitness does not
-                // drop off as a result of using different types of
-                // networks to evaluate individuals.
-                // This is the early generational case before the swap has happened
-                shared_ptr<AtariExperiment> atariExp = static_pointer_cast<AtariExperiment>(e);
-                // Initialize both experiments
-                atariExp->initializeExperiment(rom_file.c_str());
-                experimentRun.setActiveExperiment(1);
-                e = experimentRun.getExperiment();
-                shared_ptr<AtariFTNeatExperiment> ftExp = static_pointer_cast<AtariFTNeatExperiment>(e);
-                ftExp->initializeExperiment(rom_file.c_str());
-                // Get the individual to evaluate
-                shared_ptr<NEAT::GeneticPopulation> population = experimentRun.getPopulation();
-                shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
-                shared_ptr<NEAT::GeneticIndividual> HyperNEAT_individual = generation->getIndividual(individualId);
-                atariExp->substrate.populateSubstrate(HyperNEAT_individual);
-                NEAT::LayeredSubstrate<float>* HyperNEAT_substrate = &atariExp->substrate;
-                GeneticPopulation* FTNEAT_population = ftExp->createInitialPopulation(1);
-                shared_ptr<GeneticIndividual> FTNEAT_individual = FTNEAT_population->getGeneration()->getIndividual(0);
-                ftExp->convertIndividual(FTNEAT_individual, HyperNEAT_substrate);
-                ftExp->evaluateIndividual(FTNEAT_individual);
-                float fitness = FTNEAT_individual->getFitness();
-                string individualFitnessFile = commandLineParser.GetArgument("-F",0);
-                cout << "[HyperNEAT core] Fitness found to be " << fitness << ". Writing to: " <<
-                    individualFitnessFile << endl;
-                ofstream fout(individualFitnessFile.c_str());
-                fout << fitness << endl;
-                fout.close();
-                cout << "[HyperNEAT core] Individual evaluation fin." << endl;
-                exit(0);
-            }
-        }  else if (experimentType == 34) {
-            shared_ptr<AtariIntrinsicExperiment> exp = static_pointer_cast<AtariIntrinsicExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        }
+            unsigned int individualId = stringTo<unsigned int>(commandLineParser.GetArgument("-N",0));
+            cout << "[HyperNEAT core] Evaluating individual: " << individualId << endl;
 
-        float fitness = experimentRun.evaluateIndividual(individualId);
+            float fitness = evaluator.evaluate(individualId);
 
-        string individualFitnessFile = 
-            commandLineParser.GetArgument("-F",0);
-        cout << "[HyperNEAT core] Fitness found to be " << fitness << ". Writing to: " <<
-            individualFitnessFile << endl;
-        ofstream fout(individualFitnessFile.c_str());
-        fout << fitness << endl;
-        fout.close();
-        cout << "[HyperNEAT core] Individual evaluation fin." << endl;
+            writeFitness(commandLineParser.GetArgument("-F",0), fitness);
+        }
 
     } else {
         cout << "./atari_evaluate [-R (seed)] -I (datafile) -P (populationfile) -N (individualId) "
             "-F (fitnessFile) -G (romFile)\n";
+        cout << "./atari_evaluate [-R (seed)] -I (datafile) -G (romFile) -S (socketFile)\n";
         cout << "\t\t(datafile) HyperNEAT experiment data file - typically data/AtariExperiment.dat\n";
         cout << "\t\t(populationfile) current population file containing all the individuals - "
             "typically generationXX.xml.gz\n";
@@ -142,6 +328,9 @@ int HyperNEAT_main(int argc,char **argv) {
         cout << "\t\t(fitnessFile) fitness value once estimated written to file - "
             "typically fitness.XX.individualId\n";
         cout << "\t\t(romFile) the Atari rom file to evaluate the agent against.\n";
+        cout << "\t\t(socketFile) serve evaluations on this unix socket instead of evaluating one\n"
+            "\t\t\tindividual. Each request is one line: 'LOAD (populationfile)' answers 'OK',\n"
+            "\t\t\t'EVAL (id) (id) ...' answers 'FITNESS (fitness) (fitness) ...', 'QUIT' stops.\n";
     }
 
     globals->deinit();
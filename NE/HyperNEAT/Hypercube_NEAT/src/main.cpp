@@ -47,6 +47,27 @@ int HyperNEAT_main(int argc,char **argv)
 
     CommandLineParser commandLineParser(argc,argv);
 
+    if(commandLineParser.HasSwitch("-T"))
+    {
+#if defined(_DEBUG) || defined(USE_GPU)
+        //Debug and GPU builds evaluate on one thread only, see HCUBE_Defines.cpp
+        cout << "Ignoring -T: this build uses one evaluation thread\n";
+#else
+        //0 uses one evaluation thread per core
+        HCUBE::NUM_THREADS = atoi(commandLineParser.GetSafeArgument("-T",0,"1").c_str());
+        if(HCUBE::NUM_THREADS<=0)
+        {
+            HCUBE::NUM_THREADS = max(1,int(boost::thread::hardware_concurrency()));
+        }
+        cout << "Using " << HCUBE::NUM_THREADS << " evaluation threads\n";
+#endif
+    }
+
+    if(commandLineParser.HasSwitch("-profile"))
+    {
+        NEAT::Profiler::start(commandLineParser.GetSafeArgument("-profile",0,"profile.csv"));
+    }
+
 #if 1
 
 #if 0
@@ -384,7 +405,8 @@ int HyperNEAT_main(int argc,char **argv)
         else
         {
             cout << "Syntax for passing command-line options to HyperNEAT (do not actually type '(' or ')' ):\n";
-            cout << "./HyperNEAT [-R (seed)] -I (datafile) -O (outputfile)\n";
+            cout << "./HyperNEAT [-R (seed)] [-T (threads, 0 for one per core)] [-profile (profilefile)] -I (datafile) -O (outputfile)\n";
+            cout << "\t(profilefile) gets the time of each generation's hot paths, as JSON lines if it ends in .json and as CSV otherwise\n";
         }
     }
 #if 0
@@ -405,6 +427,8 @@ int HyperNEAT_main(int argc,char **argv)
     }
 #endif
 
+    NEAT::Profiler::stop();
+
     NEAT::Globals::deinit();
 
 #endif
@@ -0,0 +1,366 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_OthelloExperiment.h"
+
+using namespace HCUBE;
+
+/**
+ *  othello_perft: checks the bitboard move generator against generateMoveList,
+ *  makeMove and getWinner on random games and with perft from the starting
+ *  position, checks OthelloEvaluationCache against a map of every evaluation
+ *  it was given, and measures how fast both generators are.
+ *  Build with BUILD_BENCHMARKS=ON and run othello_perft [depth] [games].
+ */
+
+#define OTHELLO_PERFT_DEFAULT_DEPTH (8)
+
+#define OTHELLO_PERFT_DEFAULT_GAMES (20000)
+
+namespace
+{
+    //Leaf counts for the starting position, black to move
+    const unsigned long long startingPositionCounts[] =
+    {
+        1ULL,4ULL,12ULL,56ULL,244ULL,1396ULL,8200ULL,55092ULL,390216ULL,3005288ULL,24571284ULL
+    };
+    const int maxKnownDepth = 10;
+
+    int otherColor(int color)
+    {
+        return (color==OTHELLO_BLACK) ? OTHELLO_WHITE : OTHELLO_BLACK;
+    }
+
+    void resetBoard(ushort b[8][8])
+    {
+        memset(b,0,sizeof(ushort)*8*8);
+
+        b[3][3] = b[4][4] = OTHELLO_WHITE;
+        b[4][3] = b[3][4] = OTHELLO_BLACK;
+
+        OTHELLO_SET_NUM_BLACK_PIECES(b,2);
+        OTHELLO_SET_NUM_WHITE_PIECES(b,2);
+    }
+
+    /**
+     *  referenceEvaluation: stands in for a substrate.  Any value will do as
+     *  long as it depends on the position and the substrate.
+     */
+    OthelloNEATDatatype referenceEvaluation(const OthelloBitboard &position,int substrateIndex)
+    {
+        OthelloNEATDatatype value =
+            OthelloNEATDatatype(OthelloBitboard::getSquareCount(position.black)-OthelloBitboard::getSquareCount(position.white))+
+            OthelloNEATDatatype(OthelloBitboard::getSquareCount(OthelloCommon::getMobility(position,OTHELLO_BLACK)))/64;
+        return substrateIndex ? -value : value;
+    }
+
+    typedef map<pair<pair<unsigned long long,unsigned long long>,int>,OthelloNEATDatatype> EvaluationMap;
+
+    /**
+     *  OthelloChecker runs the checks on the move stack of OthelloCommon,
+     *  where generateMoveList expects its move lists to be.
+     */
+    class OthelloChecker : public OthelloCommon
+    {
+    public:
+        unsigned long long perft(ushort b[8][8],int color,int depth)
+        {
+            return perft(b,color,depth,totalMoveList);
+        }
+
+        unsigned long long perft(const OthelloBitboard &position,int color,int depth)
+        {
+            if (!depth)
+            {
+                return 1;
+            }
+
+            unsigned long long moves = getMobility(position,color);
+
+            if (!moves)
+            {
+                if (!getMobility(position,otherColor(color)))
+                {
+                    //Game over
+                    return 1;
+                }
+
+                //Pass
+                return perft(position,otherColor(color),depth-1);
+            }
+
+            unsigned long long leaves=0;
+            for (;moves;moves&=(moves-1))
+            {
+                OthelloBitboard child = position;
+                makeMove(OthelloBitboard::getFirstSquare(moves),child,color);
+                leaves += perft(child,otherColor(color),depth-1);
+            }
+            return leaves;
+        }
+
+        /**
+         *  checkPosition: checks that both generators return the same moves in
+         *  the same order, that every move flips the same pieces, and that both
+         *  getWinner agree.  Returns the number of moves, or -1 on an error.
+         */
+        int checkPosition(ushort b[8][8],int color)
+        {
+            OthelloMove *moveList = totalMoveList;
+            OthelloBitboard position(b);
+
+            int numMoves = generateMoveList(b,moveList,color);
+            unsigned long long moves = getMobility(position,color);
+
+            if (numMoves!=OthelloBitboard::getSquareCount(moves))
+            {
+                printBoard(b);
+                cout << "Move count mismatch: " << numMoves << " != " << OthelloBitboard::getSquareCount(moves) << endl;
+                return -1;
+            }
+
+            for (int a=0;a<numMoves;a++,moves&=(moves-1))
+            {
+                int square = OthelloBitboard::getFirstSquare(moves);
+
+                if (moveList[a].position.x!=OthelloBitboard::getX(square) ||
+                    moveList[a].position.y!=OthelloBitboard::getY(square))
+                {
+                    printBoard(b);
+                    cout << "Move " << a << " is on another square" << endl;
+                    return -1;
+                }
+
+                OthelloBitboard child = position;
+                makeMove(square,child,color);
+
+                makeMove(moveList[a],b);
+
+                bool childMatches =
+                    OthelloBitboard(b)==child &&
+                    OTHELLO_GET_NUM_BLACK_PIECES(b)==OthelloBitboard::getSquareCount(child.black) &&
+                    OTHELLO_GET_NUM_WHITE_PIECES(b)==OthelloBitboard::getSquareCount(child.white) &&
+                    moveList[a].getNumPiecesFlipped()==OthelloBitboard::getSquareCount(getFlips(position,color,square));
+
+                reverseMove(moveList[a],b);
+
+                if (!childMatches)
+                {
+                    printBoard(b);
+                    cout << "Move " << a << " doesn't match" << endl;
+                    return -1;
+                }
+            }
+
+            if (!(OthelloBitboard(b)==position))
+            {
+                printBoard(b);
+                cout << "reverseMove didn't restore the position" << endl;
+                return -1;
+            }
+
+            if (getWinner(b)!=getWinner(position))
+            {
+                printBoard(b);
+                cout << "Winner mismatch: " << getWinner(b) << " != " << getWinner(position) << endl;
+                return -1;
+            }
+
+            return numMoves;
+        }
+
+        /**
+         *  checkGame: plays a random game from the starting position, checking
+         *  every position on the way, and runs the evaluation of both players
+         *  through the cache.  Returns the number of errors.
+         */
+        int checkGame(
+            NEAT::Random &random,
+            OthelloEvaluationCache &cache,
+            EvaluationMap &evaluations,
+            unsigned long long &positions,
+            unsigned long long &cacheHits
+            )
+        {
+            ushort b[8][8];
+            resetBoard(b);
+            int color = OTHELLO_BLACK;
+            bool passed = false;
+
+            for (;;)
+            {
+                positions++;
+
+                OthelloBitboard position(b);
+
+                for (int substrateIndex=0;substrateIndex<2;substrateIndex++)
+                {
+                    OthelloNEATDatatype value = referenceEvaluation(position,substrateIndex);
+                    const OthelloNEATDatatype *cachedValue = cache.probe(position,substrateIndex);
+
+                    if (cachedValue)
+                    {
+                        EvaluationMap::iterator evaluation = evaluations.find(
+                            make_pair(make_pair(position.black,position.white),substrateIndex)
+                            );
+
+                        if (evaluation==evaluations.end() || *cachedValue!=evaluation->second || *cachedValue!=value)
+                        {
+                            printBoard(b);
+                            cout << "The cache returned an evaluation it wasn't given" << endl;
+                            return 1;
+                        }
+                        cacheHits++;
+                    }
+                    else
+                    {
+                        cache.store(position,substrateIndex,value);
+                        evaluations[make_pair(make_pair(position.black,position.white),substrateIndex)] = value;
+                    }
+                }
+
+                int numMoves = checkPosition(b,color);
+
+                if (numMoves<0)
+                {
+                    return 1;
+                }
+
+                if (!numMoves)
+                {
+                    if (passed)
+                    {
+                        //Neither side can move
+                        return 0;
+                    }
+                    passed = true;
+                    color = otherColor(color);
+                    continue;
+                }
+
+                passed = false;
+
+                //checkPosition left the moves on the stack, made and reversed once
+                OthelloMove move = totalMoveList[random.getRandomInt(numMoves)];
+                move.reset(move.position,move.color);
+                makeMove(move,b);
+                color = otherColor(color);
+            }
+        }
+
+    protected:
+        unsigned long long perft(ushort b[8][8],int color,int depth,OthelloMove *moveList)
+        {
+            if (!depth)
+            {
+                return 1;
+            }
+
+            int numMoves = generateMoveList(b,moveList,color);
+
+            if (!numMoves)
+            {
+                if (!generateMoveList(b,moveList,otherColor(color)))
+                {
+                    //Game over
+                    return 1;
+                }
+
+                //Pass
+                return perft(b,otherColor(color),depth-1,moveList);
+            }
+
+            unsigned long long leaves=0;
+            for (int a=0;a<numMoves;a++)
+            {
+                makeMove(moveList[a],b);
+                leaves += perft(b,otherColor(color),depth-1,moveList+numMoves);
+                reverseMove(moveList[a],b);
+            }
+            return leaves;
+        }
+    };
+
+    void printResult(const string &name,unsigned long long leaves,double seconds)
+    {
+        cout << "    " << setw(16) << left << name << right
+            << setw(12) << leaves << " leaves "
+            << setw(10) << setprecision(3) << fixed << seconds << " s "
+            << setw(14) << setprecision(0) << fixed << (seconds>0 ? leaves/seconds : 0.0) << " leaves/s"
+            << endl;
+    }
+
+    double secondsSince(clock_t start)
+    {
+        return double(clock()-start)/CLOCKS_PER_SEC;
+    }
+}
+
+int main(int argc,char **argv)
+{
+    int depth = OTHELLO_PERFT_DEFAULT_DEPTH;
+    int games = OTHELLO_PERFT_DEFAULT_GAMES;
+
+    if (argc>1)
+    {
+        depth = atoi(argv[1]);
+    }
+    if (argc>2)
+    {
+        games = atoi(argv[2]);
+    }
+
+    //The move stack is too big for the stack
+    shared_ptr<OthelloChecker> checker(new OthelloChecker());
+
+    int errors=0;
+
+    {
+        NEAT::Random random(1);
+        OthelloEvaluationCache cache;
+        EvaluationMap evaluations;
+        unsigned long long positions=0,cacheHits=0;
+
+        for (int a=0;a<games && !errors;a++)
+        {
+            errors += checker->checkGame(random,cache,evaluations,positions,cacheHits);
+        }
+
+        cout << games << " random games, " << positions << " positions, "
+            << cacheHits << " cache hits" << endl;
+    }
+
+    ushort b[8][8];
+    resetBoard(b);
+
+    for (int a=1;a<=depth;a++)
+    {
+        cout << "Depth " << a << endl;
+
+        clock_t start = clock();
+        unsigned long long bitboardLeaves = checker->perft(OthelloBitboard(b),OTHELLO_BLACK,a);
+        printResult("bitboard",bitboardLeaves,secondsSince(start));
+
+        start = clock();
+        unsigned long long boardLeaves = checker->perft(b,OTHELLO_BLACK,a);
+        printResult("generateMoveList",boardLeaves,secondsSince(start));
+
+        if (bitboardLeaves!=boardLeaves || (a<=maxKnownDepth && bitboardLeaves!=startingPositionCounts[a]))
+        {
+            cout << "    MISMATCH";
+            if (a<=maxKnownDepth)
+            {
+                cout << ", expected " << startingPositionCounts[a];
+            }
+            cout << endl;
+            errors++;
+        }
+    }
+
+    if (errors)
+    {
+        cout << errors << " errors" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_CheckersCommon.h"
+
+using namespace HCUBE;
+
+/**
+ *  checkers_perft: checks the bitboard move generator against generateMoveList
+ *  on random games and with the published perft counts, and measures how fast
+ *  both generators are.
+ *  Build with BUILD_BENCHMARKS=ON and run checkers_perft [depth] [games].
+ */
+
+#define CHECKERS_PERFT_DEFAULT_DEPTH (9)
+
+#define CHECKERS_PERFT_DEFAULT_GAMES (20000)
+
+//Random kings can move back and forth forever, so games stop after this
+#define CHECKERS_PERFT_MAX_PLIES (300)
+
+namespace
+{
+    //Leaf counts for the starting position, black to move
+    const unsigned long long startingPositionCounts[] =
+    {
+        1ULL,7ULL,49ULL,302ULL,1469ULL,7361ULL,36768ULL,179740ULL,845931ULL,3963680ULL,18391564ULL
+    };
+    const int maxKnownDepth = 10;
+
+    int otherColor(int color)
+    {
+        return (color==BLACK) ? WHITE : BLACK;
+    }
+
+    /**
+     *  checkMoves: walks the tree and checks that both generators return the
+     *  same moves in the same order, and that the incremental Zobrist key
+     *  matches the one computed from scratch.  Returns the number of errors.
+     */
+    int checkMoves(CheckersCommon &common,uchar b[8][8],int color,int depth)
+    {
+        CheckersBitboard position(b);
+
+        vector<CheckersMove> moveList;
+        bool foundJump;
+        int numMoves = common.generateMoveList(moveList,0,b,color,foundJump);
+
+        CheckersBitboardMove bitboardMoveList[CHECKERS_MAX_BITBOARD_MOVES];
+        bool foundBitboardJump;
+        int numBitboardMoves = common.generateMoves(position,color,bitboardMoveList,foundBitboardJump);
+
+        if (numMoves!=numBitboardMoves || foundJump!=foundBitboardJump)
+        {
+            common.printBoard(b);
+            cout << "Move count mismatch: " << numMoves << " != " << numBitboardMoves << endl;
+            return 1;
+        }
+
+        int errors=0;
+        unsigned long long hash = CheckersCommon::computeHash(position);
+
+        for (int a=0;a<numMoves && !errors;a++)
+        {
+            CheckersBitboard child = position;
+            CheckersCommon::makeMove(bitboardMoveList[a],child,color);
+
+            common.makeMove(moveList[a],b);
+
+            if (!(CheckersBitboard(b)==child))
+            {
+                common.printBoard(b);
+                cout << "Move " << a << " doesn't match" << endl;
+                errors++;
+            }
+            else if ((hash^CheckersCommon::getMoveHash(bitboardMoveList[a],position,color))!=CheckersCommon::computeHash(child))
+            {
+                common.printBoard(b);
+                cout << "Move " << a << " has the wrong Zobrist key" << endl;
+                errors++;
+            }
+            else if (depth>1)
+            {
+                errors += checkMoves(common,b,otherColor(color),depth-1);
+            }
+
+            common.reverseMove(moveList[a],b);
+        }
+
+        return errors;
+    }
+
+    /**
+     *  GameStats counts how often the random games reached the rules that the
+     *  first plies from the starting position never do.
+     */
+    struct GameStats
+    {
+        unsigned long long positions;
+        unsigned long long kingMoves;
+        unsigned long long promotions;
+        unsigned long long multipleJumps;
+
+        GameStats()
+            :
+        positions(0),
+            kingMoves(0),
+            promotions(0),
+            multipleJumps(0)
+        {}
+    };
+
+    /**
+     *  checkGame: plays a random game from the starting position.  Checks
+     *  every move of every position with checkMoves, plays the move on the
+     *  board, and checks the Zobrist key kept up to date along the game.
+     *  Returns the number of errors.
+     */
+    int checkGame(CheckersCommon &common,NEAT::Random &random,GameStats &stats)
+    {
+        uchar b[8][8];
+        common.resetBoard(b);
+        int color = BLACK;
+        unsigned long long hash = CheckersCommon::computeHash(CheckersBitboard(b));
+
+        for (int ply=0;ply<CHECKERS_PERFT_MAX_PLIES;ply++)
+        {
+            stats.positions++;
+
+            if (checkMoves(common,b,color,1))
+            {
+                return 1;
+            }
+
+            CheckersBitboard position(b);
+
+            vector<CheckersMove> moveList;
+            bool foundJump;
+            int numMoves = common.generateMoveList(moveList,0,b,color,foundJump);
+
+            if (!numMoves)
+            {
+                //The side to move has lost
+                return 0;
+            }
+
+            CheckersBitboardMove bitboardMoveList[CHECKERS_MAX_BITBOARD_MOVES];
+            common.generateMoves(position,color,bitboardMoveList,foundJump);
+
+            //checkMoves made sure both lists hold the same moves in the same order
+            int moveIndex = random.getRandomInt(numMoves);
+            const CheckersBitboardMove &move = bitboardMoveList[moveIndex];
+
+            if (position.kings&(1u<<move.from))
+            {
+                stats.kingMoves++;
+            }
+            if (move.promoted)
+            {
+                stats.promotions++;
+            }
+            if (move.captured&(move.captured-1))
+            {
+                stats.multipleJumps++;
+            }
+
+            hash ^= CheckersCommon::getMoveHash(move,position,color);
+
+            CheckersBitboard child = position;
+            CheckersCommon::makeMove(move,child,color);
+
+            common.makeMove(moveList[moveIndex],b);
+            color = otherColor(color);
+
+            if (!(CheckersBitboard(b)==child) || hash!=CheckersCommon::computeHash(child))
+            {
+                common.printBoard(b);
+                cout << "The game went wrong after ply " << ply << endl;
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    void printResult(const string &name,unsigned long long leaves,double seconds)
+    {
+        cout << "    " << setw(16) << left << name << right
+            << setw(12) << leaves << " leaves "
+            << setw(10) << setprecision(3) << fixed << seconds << " s "
+            << setw(14) << setprecision(0) << fixed << (seconds>0 ? leaves/seconds : 0.0) << " leaves/s"
+            << endl;
+    }
+
+    double secondsSince(clock_t start)
+    {
+        return double(clock()-start)/CLOCKS_PER_SEC;
+    }
+}
+
+int main(int argc,char **argv)
+{
+    int depth = CHECKERS_PERFT_DEFAULT_DEPTH;
+    int games = CHECKERS_PERFT_DEFAULT_GAMES;
+
+    if (argc>1)
+    {
+        depth = atoi(argv[1]);
+    }
+    if (argc>2)
+    {
+        games = atoi(argv[2]);
+    }
+
+    CheckersCommon common;
+    uchar b[8][8];
+    common.resetBoard(b);
+
+    int errors = checkMoves(common,b,BLACK,min(depth,6));
+
+    {
+        NEAT::Random random(1);
+        GameStats stats;
+
+        for (int a=0;a<games && !errors;a++)
+        {
+            errors += checkGame(common,random,stats);
+        }
+
+        cout << games << " random games, " << stats.positions << " positions, "
+            << stats.kingMoves << " king moves, " << stats.promotions << " promotions, "
+            << stats.multipleJumps << " multiple jumps" << endl;
+    }
+
+    for (int a=1;a<=depth;a++)
+    {
+        cout << "Depth " << a << endl;
+
+        clock_t start = clock();
+        unsigned long long bitboardLeaves = common.perft(CheckersBitboard(b),BLACK,a);
+        printResult("bitboard",bitboardLeaves,secondsSince(start));
+
+        start = clock();
+        unsigned long long boardLeaves = common.perft(b,BLACK,a);
+        printResult("generateMoveList",boardLeaves,secondsSince(start));
+
+        if (bitboardLeaves!=boardLeaves || (a<=maxKnownDepth && bitboardLeaves!=startingPositionCounts[a]))
+        {
+            cout << "    MISMATCH";
+            if (a<=maxKnownDepth)
+            {
+                cout << ", expected " << startingPositionCounts[a];
+            }
+            cout << endl;
+            errors++;
+        }
+    }
+
+    if (errors)
+    {
+        cout << errors << " errors" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -29,17 +29,26 @@ int HyperNEAT_main(int argc,char **argv) {
     if (!commandLineParser.HasSwitch("-I") ||
         !commandLineParser.HasSwitch("-O") ||
         !commandLineParser.HasSwitch("-G")) {
-        cout << "./atari_generate [-R (seed)] -I (datafile) -O (outputfile) -G (ROMFile) [-P (populationfile) -F (fitnessprefix) [-E (evaluationFile)] ]\n";
+        cout << "./atari_generate [-R (seed)] [-profile (profilefile)] -I (datafile) -O (outputfile) -G (ROMFile) [-P (populationfile) -F (fitnessprefix) [-E (evaluationFile)] [-g (generation)] ]\n";
         cout << "\t(datafile) experiment data file - typically data/AtariExperiment.dat\n";
         cout << "\t(outputfile) the next generation file to be created - typically generationXX.xml\n";
         cout << "\t(populationfile) the current generation file (required when outputfile is > generation0) - typically generationXX(-1).xml.gz\n";
         cout << "\t(fitnessprefix) used to locate the fitness files for individuals in the current generation (required for generation > 0) - typically fitness.XX.\n";
         cout << "\t(evaluationfile) populationfile + fitness + speciation (output only - not required for next cycle) - typicall generationXX(-1).eval.xml\n";
+        cout << "\tAn outputfile ending in .ckpt is a checkpoint log: each run appends only the generations that changed.\n";
+        cout << "\tPass the same log as populationfile to continue from it.\n";
+        cout << "\t(generation) the generation to resume from when populationfile is a checkpoint log - defaults to the newest\n";
+        cout << "\t(profilefile) each run appends the time of its hot paths, as JSON lines if it ends in .json and as CSV otherwise\n";
         return 0;
     }
 
     Globals *globals = Globals::init(commandLineParser.GetArgument("-I",0));
 
+    if (commandLineParser.HasSwitch("-profile")) {
+        Profiler::start(commandLineParser.GetArgument("-profile",0));
+        Profiler::beginGeneration();
+    }
+
     if (commandLineParser.HasSwitch("-R")) {
         unsigned int seed = stringTo<unsigned int>(commandLineParser.GetArgument("-R",0));
         globals->setParameterValue("RandomSeed",double(seed));
@@ -59,8 +68,13 @@ int HyperNEAT_main(int argc,char **argv) {
         string populationFile = commandLineParser.GetArgument("-P",0);
         string fitnessFunctionPrefix = commandLineParser.GetArgument("-F",0);
         string evaluationFile = commandLineParser.GetSafeArgument("-E",0,"");
+        int generation = -1;
+        if (commandLineParser.HasSwitch("-g")) {
+            generation = stringTo<int>(commandLineParser.GetArgument("-g",0));
+        }
         cout << "[HyperNEAT core] Population for existing generation created from: " << populationFile << endl;
-        experimentRun.createPopulationFromCondorRun(populationFile, fitnessFunctionPrefix, evaluationFile, rom_file);
+        experimentRun.createPopulationFromCondorRun(populationFile, fitnessFunctionPrefix, evaluationFile, rom_file,
+                                                    generation);
     } else {
         cout << "[HyperNEAT core] Population for first generation created" << endl;
         shared_ptr<Experiment> e = experimentRun.getExperiment();        
@@ -85,6 +99,9 @@ int HyperNEAT_main(int argc,char **argv) {
     }
     experimentRun.startCondor();
 
+    Profiler::endGeneration(experimentRun.getPopulation()->getGenerationCount()-1);
+    Profiler::stop();
+
     NEAT::Globals::deinit();
 }
 
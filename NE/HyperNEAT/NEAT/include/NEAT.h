@@ -3,6 +3,7 @@
 
 #include "NEAT_Globals.h"
 #include "NEAT_Random.h"
+#include "NEAT_Profiler.h"
 #include "NEAT_Network.h"
 #include "NEAT_ModularNetwork.h"
 #include "NEAT_FastLayeredNetwork.h"
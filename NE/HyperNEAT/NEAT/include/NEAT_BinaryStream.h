@@ -0,0 +1,117 @@
+#ifndef NEAT_BINARYSTREAM_H_INCLUDED
+#define NEAT_BINARYSTREAM_H_INCLUDED
+
+#include "NEAT_Defines.h"
+
+/**
+ *  A compact binary encoding for genomes that are shipped between
+ *  processes.  Values are copied in the native byte order, so both ends
+ *  must run on the same architecture.
+ */
+
+namespace NEAT
+{
+    /**
+     *  BinaryWriter: appends values to the end of a byte buffer.  The buffer
+     *  is owned by the caller so it can be reused and sent as is.
+     */
+    class BinaryWriter
+    {
+    protected:
+        vector<char> &buffer;
+
+    public:
+        BinaryWriter(vector<char> &_buffer)
+            :
+            buffer(_buffer)
+        {}
+
+        template<class Type>
+        inline void write(const Type &value)
+        {
+            writeBytes(&value,sizeof(Type));
+        }
+
+        inline void writeBool(bool value)
+        {
+            write<unsigned char>(value ? 1 : 0);
+        }
+
+        inline void writeString(const string &value)
+        {
+            write<int>(int(value.length()));
+            writeBytes(value.data(),value.length());
+        }
+
+        inline void writeBytes(const void *data,size_t size)
+        {
+            if (size)
+            {
+                size_t offset = buffer.size();
+                buffer.resize(offset+size);
+                memcpy(&buffer[offset],data,size);
+            }
+        }
+    };
+
+    /**
+     *  BinaryReader: reads values written by BinaryWriter straight out of a
+     *  byte buffer, without copying it first.  Throws if a value runs past
+     *  the end of the buffer.
+     */
+    class BinaryReader
+    {
+    protected:
+        const char *position;
+        const char *end;
+
+    public:
+        BinaryReader(const char *data,size_t size)
+            :
+            position(data),
+            end(data+size)
+        {}
+
+        template<class Type>
+        inline Type read()
+        {
+            Type value;
+            readBytes(&value,sizeof(Type));
+            return value;
+        }
+
+        inline bool readBool()
+        {
+            return read<unsigned char>()!=0;
+        }
+
+        inline string readString()
+        {
+            int length = read<int>();
+            if (length<0 || length>end-position)
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Binary stream ended in the middle of a string");
+            }
+            string value(position,length);
+            position += length;
+            return value;
+        }
+
+        inline void readBytes(void *data,size_t size)
+        {
+            if (size>size_t(end-position))
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Binary stream ended in the middle of a value");
+            }
+            memcpy(data,position,size);
+            position += size;
+        }
+
+        inline bool atEnd() const
+        {
+            return position==end;
+        }
+    };
+}
+
+#endif // NEAT_BINARYSTREAM_H_INCLUDED
@@ -16,6 +16,16 @@ namespace NEAT
             shared_ptr<GeneticIndividual> ind1,
             shared_ptr<GeneticIndividual> ind2) = 0;
 
+        /**
+         * cloneCoEvoExperiment: returns a new copy of this experiment that can play
+         * games on another thread at the same time, or NULL if the experiment can't
+         * be copied.  The tournament scheduler then plays every game on this one.
+         */
+        virtual CoEvoExperiment* cloneCoEvoExperiment()
+        {
+            return NULL;
+        }
+
         virtual ~CoEvoExperiment() {}
     };
 }
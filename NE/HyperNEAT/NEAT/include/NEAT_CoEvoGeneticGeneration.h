@@ -127,6 +127,18 @@ namespace NEAT
         );
 
         bool getTestResult(int t1,int t2);
+
+        /**
+         * playTestMatches: plays the tests in each pair of matches (first against
+         * second) and stores the rewards in match order.  The games are split over
+         * "TournamentThreads" threads (default 1, 0 means one per core), each with
+         * its own clone of the experiment.  Every match draws from its own random
+         * stream, so the rewards don't depend on the number of threads.
+         */
+        void playTestMatches(
+            const vector<pair<int,int> > &matches,
+            vector<pair<double,double> > &rewards
+        );
     };
 }
 
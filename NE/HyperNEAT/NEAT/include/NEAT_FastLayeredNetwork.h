@@ -54,6 +54,49 @@ namespace NEAT
         }
     };
 
+    /**
+     *  CompiledLayerWeights: the weights from one source layer as the
+     *  adaptive engines propagate them (see LayeredNetworkEngine)
+     */
+    template<class Type>
+    class CompiledLayerWeights
+    {
+    public:
+        //Fraction of the weights that are non-zero
+        double density;
+
+        //True when the pair is propagated from the CSR copy below instead
+        //of from the dense weights
+        bool sparse;
+
+        //The non-zero weights grouped by target node
+        vector<int> rowStart;
+        vector<int> fromNodes;
+        vector<Type> weights;
+
+        //For pairs from an input layer (see LayeredNetworkInputs): the
+        //weights grouped by source node, columns[fromNode*numToNodes+toNode]
+        vector<Type> columns;
+
+        //LAYERED_NETWORK_INPUTS_INCREMENTAL: the sums from the source layer
+        //as of the last update, the source values they were computed from
+        //and the source nodes that were non-zero then
+        vector<Type> inputSums;
+        vector<Type> propagatedValues;
+        vector<int> propagatedNodes;
+        bool inputSumsValid;
+        int updatesSinceRefresh;
+
+        CompiledLayerWeights()
+            :
+            density(1.0),
+            sparse(false),
+            inputSumsValid(false),
+            updatesSinceRefresh(0)
+        {
+        }
+    };
+
     /**
      *  The FastLayeredNetwork class is designed to be faster at the cost
      *  of being less dynamic.  Adding/Removing links and nodes
@@ -65,6 +108,30 @@ namespace NEAT
     protected:
         vector<NetworkLayer<Type> > layers;
 
+        /**
+         * compiledWeights[layer][a] is the compiled form of
+         * layers[layer].fromWeights[a], built by compileWeights().  It is
+         * stale while weightsCompiled is false.
+         */
+        vector< vector< CompiledLayerWeights<Type> > > compiledWeights;
+        bool weightsCompiled;
+
+        //True when compileWeights() also built the columns of the input pairs
+        bool inputColumnsCompiled;
+
+        //Scratch space for the sums from one source layer
+        vector<Type> pairSums;
+
+        /**
+         * activeInputs[layer] holds the nodes of an input layer that setValue()
+         * made non-zero since the last reinitialize(), in the order they were
+         * set.  A node may be listed twice, or be zero again by now.
+         */
+        vector< vector<int> > activeInputs;
+
+        //Scratch space for the input nodes whose value changed
+        vector<int> changedInputs;
+
     public:
         /**
          *  (Constructor) Create a Network with the inputed toplogy
@@ -120,6 +187,20 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT void setLink(const Node &fromNodeIndex,const Node &toNodeIndex,Type weight);
 
+        /**
+         * compileWeights: measures the density of every layer pair and builds
+         * the compressed copies used by the adaptive engines.  Call once the
+         * weights are set.  update() recompiles on demand after setLink().
+         */
+        NEAT_DLL_EXPORT void compileWeights();
+
+        /**
+         * getWeightDensity: the fraction of non-zero weights from
+         * fromLayers[fromLayerIndex] into the given layer, as measured by
+         * the last compileWeights()
+         */
+        NEAT_DLL_EXPORT double getWeightDensity(int layerIndex,int fromLayerIndex);
+
         /**
          * reinitialize: This resets the state of the network
          * to its initial state
@@ -138,6 +219,18 @@ namespace NEAT
         NEAT_DLL_EXPORT virtual void update();
 
     protected:
+        /**
+         * propagateCompiled: adds the sums from layers[layerIndex].fromLayers[a]
+         * into the layer's node values using the compiled weights
+         */
+        void propagateCompiled(int layerIndex,int a,bool useSimd);
+
+        /**
+         * propagateInputs: adds the sums from the input layer
+         * layers[layerIndex].fromLayers[a] into the layer's node values,
+         * reading only the weight columns of the active input nodes
+         */
+        void propagateInputs(int layerIndex,int a,bool incremental);
     };
 
 }
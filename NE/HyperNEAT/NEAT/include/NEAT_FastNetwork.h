@@ -28,6 +28,53 @@ namespace NEAT
         NetworkIndexedLink<Type> *links;
         map<pair<int,int>,int> nodeLinkMap;
 
+        /**
+         * batchNewValues is scratch space for updateBatch().  It is not
+         * part of the network state and is not copied with the network.
+         */
+        vector<Type> batchNewValues;
+
+        /**
+         * Compressed sparse row (CSR) copy of the links, used by the
+         * FAST_NETWORK_ENGINE_CSR engines.  There is one row per updated node,
+         * holding that node's incoming links in link list order.  Rows are
+         * sorted by activation function so each function is applied to one
+         * contiguous block (csrBucketStart[function] to csrBucketStart[function+1]).
+         * Built on the first CSR update; it is empty until then.
+         */
+        vector<int> csrRowStart;
+        vector<int> csrRowNode;
+        vector<int> csrBucketStart;
+        vector<int> csrFromNode;
+        vector<int> csrLinkIndex;
+        vector<Type> csrWeights;
+        vector<Type> csrRowValues;
+
+        /**
+         * csrWeightsDirty is set whenever the link weights may have changed
+         * (getLink() hands out a writable link) and csrWeights is refreshed
+         * from links on the next CSR update.
+         */
+        bool csrWeightsDirty;
+
+        /**
+         * Instruction tape used by FAST_NETWORK_ENGINE_TAPE.  The updated nodes
+         * are sorted topologically and each instruction sums one node's incoming
+         * links (in link list order) and applies its activation function, so a
+         * single pass over the tape settles the whole network.  tapeLinkStart
+         * holds one entry per instruction plus an end marker.
+         * tapeDepth is the longest chain of updated nodes, or -1 when the
+         * network is recurrent and has no tape.  Built on the first tape update.
+         */
+        vector<int> tapeNode;
+        vector<int> tapeLinkStart;
+        vector<int> tapeFromNode;
+        vector<int> tapeLinkIndex;
+        vector<Type> tapeWeights;
+        int tapeDepth;
+        bool tapeBuilt;
+        bool tapeWeightsDirty;
+
         /**
          * numConstantNodes holds the index of the first node that is updated.  All nodes before
          * numConstantNodes are constant
@@ -93,11 +140,53 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT void setValue(const string &nodeName,Type newValue);
 
+        /**
+         *  getNodeIndex: gets the position of a node in the node value
+         *  array.  Throws if the node does not exist.  Resolve a node name
+         *  once and use the index with getValue(int)/setValue(int,Type) or
+         *  getNodeValues() in inner loops to avoid the name lookup.
+         */
+        NEAT_DLL_EXPORT int getNodeIndex(const string &nodeName);
+
+        /**
+         *  getValue: gets the value for a node index from getNodeIndex()
+         */
+        inline Type getValue(int nodeIndex)
+        {
+            return nodeValues[nodeIndex];
+        }
+
+        /**
+         *  setValue: sets the value for a node index from getNodeIndex()
+         */
+        inline void setValue(int nodeIndex,Type newValue)
+        {
+            nodeValues[nodeIndex] = newValue;
+        }
+
+        /**
+         *  getNodeValues: gets the node value array, indexed by getNodeIndex()
+         */
+        inline Type *getNodeValues()
+        {
+            return nodeValues;
+        }
+
+        /**
+         *  getNodeCount: gets the number of nodes
+         */
+        inline int getNodeCount()
+        {
+            return numNodes;
+        }
+
         /**
          *  getLink: gets the link according to its index when created
          */
         NetworkIndexedLink<Type> *getLink(int index)
         {
+            csrWeightsDirty=true;
+            tapeWeightsDirty=true;
             return &links[index];
         }
 
@@ -141,6 +230,26 @@ namespace NEAT
             updateFixedIterations(1);
         }
 
+        /**
+         * updateBatch: Activates batchSize independent copies of the network
+         * at once.  batchValues is laid out node-major (structure of arrays):
+         * the value of node n for pattern b is batchValues[n*batchSize+b], with
+         * n taken from getNodeIndex().  The caller zeroes the buffer (the
+         * equivalent of reinitialize()) and fills in the input nodes.  Each
+         * pattern is updated (1+ExtraActivationUpdates) times, exactly as
+         * update() would on a freshly reinitialized network, and yields the
+         * same values bit for bit.  The network's own node values are untouched.
+         */
+        NEAT_DLL_EXPORT void updateBatch(Type *batchValues,int batchSize);
+
+        /**
+         * updateBatchFixedIterations: Same as updateBatch(), but every pattern
+         * is updated exactly (iterations) times, the way updateFixedIterations()
+         * updates a network after reinitialize() and dummyActivation().  This is
+         * what substrates that are read after a fixed number of steps need.
+         */
+        NEAT_DLL_EXPORT void updateBatchFixedIterations(Type *batchValues,int batchSize,int iterations);
+
         NEAT_DLL_EXPORT void print();
 
         NEAT_DLL_EXPORT void clearAllLinkWeights();
@@ -150,6 +259,40 @@ namespace NEAT
     protected:
         void copyFrom(const FastNetwork &other);
 
+        /**
+         * buildCompiledLinks: builds the CSR copy of the links
+         */
+        void buildCompiledLinks();
+
+        /**
+         * updateCompiled: runs (count) updates with the CSR engine.
+         * useSimd selects FAST_NETWORK_ENGINE_CSR_SIMD.
+         */
+        void updateCompiled(int count,bool useSimd);
+
+        /**
+         * buildTape: sorts the updated nodes topologically and builds the
+         * instruction tape, or marks the network as recurrent
+         */
+        void buildTape();
+
+        /**
+         * canUseTape: true if one pass over the tape gives the same values as
+         * (count) updates.  That needs an acyclic network and enough updates
+         * for the deepest node to settle.
+         */
+        bool canUseTape(int count);
+
+        /**
+         * refreshTapeWeights: copies changed link weights into the tape
+         */
+        void refreshTapeWeights();
+
+        /**
+         * updateTape: evaluates the network in one pass over the tape
+         */
+        void updateTape();
+
         Type runActivationFunction(Type value,ActivationFunction function,bool signedActivation,bool usingTanhSigmoid);
 
         Type activationFunctionDerivative(Type value,ActivationFunction function);
@@ -2,6 +2,7 @@
 #define __GENETICGENE_H__
 
 #include "NEAT_Globals.h"
+#include "NEAT_BinaryStream.h"
 
 namespace NEAT
 {
@@ -40,6 +41,11 @@ namespace NEAT
 
         GeneticGene(istream &istr);
 
+        /**
+         * Constructor: Creates a GeneticGene from its binary format
+         */
+        GeneticGene(BinaryReader &reader);
+
         virtual ~GeneticGene();
 
         virtual bool operator==(const GeneticGene &other) const;
@@ -95,6 +101,8 @@ namespace NEAT
 
         virtual void dump(ostream &ostr);
 
+        virtual void dump(BinaryWriter &writer);
+
         inline void incrementAge()
         {
             age++;
@@ -82,6 +82,12 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT GeneticIndividual(istream& stream);
 
+        /**
+         * Create an individual from its binary description.  Unlike the stream
+         * description this keeps every bit of the weights.
+         */
+        NEAT_DLL_EXPORT GeneticIndividual(BinaryReader &reader);
+
         /**
          * Create a baby individual from two parents
         */
@@ -132,6 +138,8 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void dump(ostream &ostr);
 
+        NEAT_DLL_EXPORT void dump(BinaryWriter &writer);
+
         NEAT_DLL_EXPORT void print() const;
 
         inline void setFitness(double _fitness)
@@ -170,9 +178,20 @@ namespace NEAT
         }
 
         /**
-         * getCompatibility: returns the compatibility between this individual and another
+         * getGenomeHash: returns a hash of everything that shapes the phenotype:
+         * the node genes (ID, name, type, activation function) and the link genes
+         * (ID, endpoints, weight, enabled).  The order of the genes doesn't matter,
+         * so individuals with the same genes always hash the same.
+         */
+        NEAT_DLL_EXPORT unsigned long long getGenomeHash() const;
+
+        /**
+         * getCompatibility: returns the compatibility between this individual and another.
+         * If the result is certain to be >= bound the comparison stops early and returns
+         * a value >= bound instead, so callers that only test compatibility<bound can pass
+         * their threshold.
          */
-        NEAT_DLL_EXPORT double getCompatibility(shared_ptr<GeneticIndividual> other);
+        NEAT_DLL_EXPORT double getCompatibility(shared_ptr<GeneticIndividual> other,double bound=DBL_MAX);
 
         inline void setCanReproduce(bool _canReproduce)
         {
@@ -217,6 +236,13 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void addLink(GeneticLinkGene link);
 
+        /**
+         * commitInnovations: swaps the provisional IDs this individual got while
+         * its innovations were deferred for the real IDs that
+         * Globals::commitInnovations handed out for them.
+         */
+        NEAT_DLL_EXPORT void commitInnovations(const vector<int> &nodeIDs,const vector<int> &linkIDs);
+
         NEAT_DLL_EXPORT bool isValid();
 	protected:
     };
@@ -58,6 +58,8 @@ namespace NEAT
 
         GeneticLinkGene(istream &istr);
 
+        GeneticLinkGene(BinaryReader &reader);
+
         virtual ~GeneticLinkGene();
 
         virtual bool operator==(const GeneticLinkGene &other) const;
@@ -101,6 +103,8 @@ namespace NEAT
 
         virtual void dump(ostream &ostr);
 
+        virtual void dump(BinaryWriter &writer);
+
         void setFixed(bool _fixed)
         {
             fixed = _fixed;
@@ -62,6 +62,8 @@ namespace NEAT
 
         GeneticNodeGene(istream &istr);
 
+        GeneticNodeGene(BinaryReader &reader);
+
         virtual bool operator==(const GeneticNodeGene &other) const;
 
         inline const string &getName() const
@@ -90,6 +92,8 @@ namespace NEAT
 
         virtual void dump(ostream &ostr);
 
+        virtual void dump(BinaryWriter &writer);
+
         inline ActivationFunction getActivationFunction() const
         {
             return activationFunction;
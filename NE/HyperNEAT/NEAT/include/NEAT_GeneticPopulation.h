@@ -41,6 +41,51 @@ namespace NEAT
         }
         BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+    public:
+        /**
+         * saveGenerations: Writes the globals and the generations from firstGeneration
+         * up to the current one.  Checkpoint logs use this to write only what changed
+         * since the previous record.
+         */
+        template<class Archive>
+            void saveGenerations(Archive & ar,int firstGeneration) const
+        {
+            ar  & (*Globals::getSingleton());
+            ar  & onGeneration;
+            ar  & firstGeneration;
+            for (int a=firstGeneration;a<=onGeneration;a++)
+            {
+                ar  & generations[a];
+            }
+        }
+
+        /**
+         * loadGenerations: Reads a record written by saveGenerations on top of the
+         * generations that are already loaded.  Call adjustFitness() after the last record.
+         */
+        template<class Archive>
+            void loadGenerations(Archive & ar)
+        {
+            ar  & (*Globals::getSingleton());
+            int firstGeneration;
+            ar  & onGeneration;
+            ar  & firstGeneration;
+
+            if (firstGeneration>(int)generations.size())
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Checkpoint record skips a generation!");
+            }
+
+            //A record describes the whole population at the time it was written,
+            //newer generations from an abandoned branch are dropped
+            generations.resize(onGeneration+1);
+            for (int a=firstGeneration;a<=onGeneration;a++)
+            {
+                ar  & generations[a];
+            }
+        }
+
+    protected:
         vector<shared_ptr<GeneticGeneration> > generations;
 
         vector<shared_ptr<GeneticSpecies> > species;
@@ -113,6 +158,19 @@ namespace NEAT
         {
             return (int)generations.size();
         }
+
+    protected:
+        /**
+         * makeBabies: makes one baby per offspring on "ReproductionThreads"
+         * threads (default 1, 0 means one per core).  Every baby draws from its
+         * own random stream and its new genes are numbered in offspring order,
+         * so the babies don't depend on the number of threads.
+         */
+        void makeBabies(
+            const vector<Offspring> &offspring,
+            double minFitness,
+            vector<shared_ptr<GeneticIndividual> > &babies
+            );
     };
 
 }
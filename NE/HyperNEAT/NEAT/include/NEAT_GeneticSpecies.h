@@ -6,6 +6,30 @@
 
 namespace NEAT
 {
+    /*
+     * Offspring: the parents chosen for one baby.  Without a second parent the
+     * baby is a copy of the first one, mutated if mutate is set.
+     */
+    struct Offspring
+    {
+        shared_ptr<GeneticIndividual> parent1,parent2;
+
+        bool mutate;
+
+        Offspring(shared_ptr<GeneticIndividual> _parent1,bool _mutate)
+            :
+            parent1(_parent1),
+            mutate(_mutate)
+        {}
+
+        Offspring(shared_ptr<GeneticIndividual> _parent1,shared_ptr<GeneticIndividual> _parent2)
+            :
+            parent1(_parent1),
+            parent2(_parent2),
+            mutate(true)
+        {}
+    };
+
     /*
      * GeneticSpecies: This class is responsible for handling a species: a group of similar individuals
      */
@@ -126,7 +150,11 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void incrementAge();
 
-        NEAT_DLL_EXPORT void makeBabies(vector<shared_ptr<GeneticIndividual> > &babies, double minGenerationalFitness);
+        /**
+         * chooseParents: picks the parents of this species' offspring.  The
+         * babies themselves are made by GeneticPopulation.
+         */
+        NEAT_DLL_EXPORT void chooseParents(vector<Offspring> &offspring);
 
         NEAT_DLL_EXPORT void dump(TiXmlElement *speciesElement);
     };
@@ -8,6 +8,7 @@
 
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 /* #defines */
 #define LAST_GENERATION  (-1)
@@ -27,8 +28,167 @@ enum ActivationFunction
 
 extern const char *activationFunctionNames[ACTIVATION_FUNCTION_END];
 
+/**
+ * FastNetworkEngine: selects how FastNetwork::updateFixedIterations
+ * propagates values.  Set with the "FastNetworkEngine" parameter.
+ *
+ * FAST_NETWORK_ENGINE_LINKS: walks the link list in creation order (default)
+ * FAST_NETWORK_ENGINE_CSR: links grouped by target node (CSR).  Each node
+ *   sums its inputs in the same order as the link list, so the results are
+ *   bit for bit identical to FAST_NETWORK_ENGINE_LINKS.  (Builds that fuse
+ *   multiply-adds, e.g. with -mfma, may fuse the two loops differently; the
+ *   CSR_SIMD tolerance below then applies.)
+ * FAST_NETWORK_ENGINE_CSR_SIMD: as CSR, but on CPUs with AVX2 each node's
+ *   sum is split over vector lanes, which reorders the additions.  The
+ *   AVX2 kernels are picked at run time, so SSE2 builds use them too.
+ *   Without AVX2 it is the same as FAST_NETWORK_ENGINE_CSR.  Each sum
+ *   agrees with the other engines to within a few ulps of the sum of
+ *   |input*weight|.  A sum that crosses a step of the sigmoid lookup
+ *   table moves the output by up to 5e-4.  Feed-forward networks therefore
+ *   agree to within 1e-3 absolute (typically 1e-5 for floats).
+ *   Recurrent networks feed the rounding differences back on every update
+ *   and can drift apart; use FAST_NETWORK_ENGINE_CSR when they must match.
+ * FAST_NETWORK_ENGINE_TAPE: feed-forward networks are compiled once into a
+ *   tape of nodes in topological order and evaluated in a single pass,
+ *   instead of (1+ExtraActivationUpdates) passes over every link.  When that
+ *   many updates are enough for the deepest node to settle, the values are
+ *   bit for bit those of FAST_NETWORK_ENGINE_LINKS.  Recurrent networks,
+ *   updates too short to settle the network and single updates (where the
+ *   tape saves nothing) run FAST_NETWORK_ENGINE_CSR.
+ */
+enum FastNetworkEngine
+{
+    FAST_NETWORK_ENGINE_LINKS = 0,
+    FAST_NETWORK_ENGINE_CSR,
+    FAST_NETWORK_ENGINE_CSR_SIMD,
+    FAST_NETWORK_ENGINE_TAPE,
+    FAST_NETWORK_ENGINE_END
+};
+
+/**
+ * LayeredNetworkEngine: selects how FastLayeredNetwork::update propagates
+ * between layers.  Set with the "LayeredNetworkEngine" parameter.
+ *
+ * LAYERED_NETWORK_ENGINE_DENSE: dot product over every weight (default)
+ * LAYERED_NETWORK_ENGINE_ADAPTIVE: once the weights are set, the density of
+ *   every layer pair is measured.  Sparse pairs propagate from a compressed
+ *   copy of the non-zero weights, dense pairs run the dot product blocked to
+ *   stay in cache.  Zero weights add nothing to a sum, so the results are
+ *   bit for bit identical to LAYERED_NETWORK_ENGINE_DENSE.
+ * LAYERED_NETWORK_ENGINE_ADAPTIVE_SIMD: as ADAPTIVE, but on CPUs with AVX2
+ *   the sums of sparse pairs are split over vector lanes, which reorders the
+ *   additions.  Dense pairs are summed as in ADAPTIVE.  The network is
+ *   feed-forward, so the FAST_NETWORK_ENGINE_CSR_SIMD tolerance for
+ *   feed-forward networks applies: 1e-3 absolute, typically 1e-5 for floats.
+ */
+enum LayeredNetworkEngine
+{
+    LAYERED_NETWORK_ENGINE_DENSE = 0,
+    LAYERED_NETWORK_ENGINE_ADAPTIVE,
+    LAYERED_NETWORK_ENGINE_ADAPTIVE_SIMD,
+    LAYERED_NETWORK_ENGINE_END
+};
+
+/**
+ * LayeredNetworkInputs: selects how FastLayeredNetwork::update propagates
+ * from input layers (layers that no other layer feeds) into the next layer.
+ * Set with the "LayeredNetworkInputs" parameter.  The other layer pairs
+ * use the LayeredNetworkEngine.
+ *
+ * LAYERED_NETWORK_INPUTS_DENSE: input layers are treated like any other
+ *   layer (default)
+ * LAYERED_NETWORK_INPUTS_SPARSE: setValue() records the input nodes it makes
+ *   non-zero, and only the weight columns of those nodes are added into the
+ *   target layer.  Columns are added in node order, so the results are bit
+ *   for bit identical to LAYERED_NETWORK_ENGINE_DENSE.
+ * LAYERED_NETWORK_INPUTS_INCREMENTAL: as SPARSE, but the sums of each input
+ *   pair are kept between updates and only the columns of inputs whose value
+ *   changed since the last update are added, scaled by the change.  The
+ *   rounding of the running sums builds up, so they are recomputed in full
+ *   every LAYERED_NETWORK_INPUT_REFRESH updates; in between they agree with
+ *   SPARSE to within a few ulps of the sum of |input*weight|.
+ */
+enum LayeredNetworkInputs
+{
+    LAYERED_NETWORK_INPUTS_DENSE = 0,
+    LAYERED_NETWORK_INPUTS_SPARSE,
+    LAYERED_NETWORK_INPUTS_INCREMENTAL,
+    LAYERED_NETWORK_INPUTS_END
+};
+
+/**
+ * ParameterSlot: parameters read on hot paths (speciation, mutation and
+ * reproduction).  Globals resolves their values from the parameter map
+ * whenever it changes, so getParameterValue(ParameterSlot) is an array
+ * read instead of a string search.
+ */
+enum ParameterSlot
+{
+    PARAMETER_DISJOINT_COEFFICIENT = 0,
+    PARAMETER_EXCESS_COEFFICIENT,
+    PARAMETER_WEIGHT_DIFFERENCE_COEFFICIENT,
+    PARAMETER_FITNESS_COEFFICIENT,
+    PARAMETER_COMPATIBILITY_THRESHOLD,
+    PARAMETER_COMPATIBILITY_MODIFIER,
+    PARAMETER_SPECIES_SIZE_TARGET,
+    PARAMETER_DROPOFF_AGE,
+    PARAMETER_AGE_SIGNIFICANCE,
+    PARAMETER_SURVIVAL_THRESHOLD,
+    PARAMETER_MUTATE_ADD_NODE_PROBABILITY,
+    PARAMETER_MUTATE_ADD_LINK_PROBABILITY,
+    PARAMETER_MUTATE_DEMOLISH_LINK_PROBABILITY,
+    PARAMETER_MUTATE_LINK_WEIGHTS_PROBABILITY,
+    PARAMETER_MUTATE_LINK_PROBABILITY,
+    PARAMETER_MUTATE_ONLY_PROBABILITY,
+    PARAMETER_MUTATE_SPECIES_CHAMPION_PROBABILITY,
+    PARAMETER_MUTATION_POWER,
+    PARAMETER_ADULT_LINK_AGE,
+    PARAMETER_ALLOW_RECURRENT_CONNECTIONS,
+    PARAMETER_ALLOW_SELF_RECURRENT_CONNECTIONS,
+    PARAMETER_ALLOW_ADD_NODE_TO_RECURRENT_CONNECTION,
+    PARAMETER_SMALLEST_SPECIES_SIZE_WITH_ELITISM,
+    PARAMETER_FORCE_COPY_GENERATION_CHAMPION,
+    PARAMETER_LINK_GENE_MINIMUM_WEIGHT_FOR_PHENTOYPE,
+    PARAMETER_EXTRA_ACTIVATION_FUNCTIONS,
+    PARAMETER_ADD_BIAS_TO_HIDDEN_NODES,
+    PARAMETER_ONLY_GAUSSIAN_HIDDEN_NODES,
+    PARAMETER_MIN_POSSIBLE_FITNESS,
+    PARAMETER_SLOT_END
+};
+
+extern const char *parameterSlotNames[PARAMETER_SLOT_END];
+
 namespace NEAT
 {
+    /**
+     * InnovationLog: the genes one offspring invented while its IDs were
+     * deferred (see Globals::deferInnovations).  New node a got the
+     * provisional ID FIRST_PROVISIONAL_ID+a, and so did new link a, which
+     * joins links[a].first to links[a].second.
+     */
+    class InnovationLog
+    {
+    public:
+        enum { FIRST_PROVISIONAL_ID = 0x40000000 };
+
+        int nodeCount;
+
+        vector<pair<int,int> > links;
+
+        //Index into links of every (fromNodeID,toNodeID) in it
+        boost::unordered_map<pair<int,int>,int> linkIndex;
+
+        InnovationLog()
+            :
+            nodeCount(0)
+        {}
+
+        inline static bool isProvisional(int ID)
+        {
+            return ID>=FIRST_PROVISIONAL_ID;
+        }
+    };
+
     class Globals
     {
         friend class boost::serialization::access;
@@ -61,6 +221,7 @@ namespace NEAT
             ar & speciesCounter;
             ar & minPossibleFitness;
             ar & linkGenesThisGeneration;
+            rebuildLinkHistoryIndex();
 
             // De-serialize the parameters
             int numParams;
@@ -87,6 +248,9 @@ namespace NEAT
 
         vector<shared_ptr<GeneticLinkGene> > linkGenesThisGeneration;
 
+        //Innovation number of every (fromNodeID,toNodeID) in linkGenesThisGeneration
+        boost::unordered_map<pair<int,int>,int> linkHistoryIndex;
+
         StackMap<string,double,4096> parameters;
 
         Random random;
@@ -96,6 +260,18 @@ namespace NEAT
 		bool signedActivation;
 
 		bool useTanhSigmoid;
+
+		FastNetworkEngine fastNetworkEngine;
+
+		LayeredNetworkEngine layeredNetworkEngine;
+
+		LayeredNetworkInputs layeredNetworkInputs;
+
+		int frameSkip;
+
+        double parameterSlotValues[PARAMETER_SLOT_END];
+
+        bool parameterSlotSet[PARAMETER_SLOT_END];
     public:
         static inline Globals *getSingleton()
         {
@@ -143,10 +319,26 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void assignNodeID(GeneticNodeGene *testNode);
 
-        NEAT_DLL_EXPORT void assignLinkID(GeneticLinkGene *testLink,bool ignoreHistory=false);
+        NEAT_DLL_EXPORT void assignLinkID(GeneticLinkGene *testLink);
 
         NEAT_DLL_EXPORT void clearLinkHistory();
 
+        /**
+         * deferInnovations: while a log is set, new genes made on the calling
+         * thread get provisional IDs and are recorded in the log instead of
+         * touching the counters, so offspring can be made on many threads.
+         * Pass NULL to go back to assigning IDs right away.
+         */
+        NEAT_DLL_EXPORT void deferInnovations(InnovationLog *log);
+
+        /**
+         * commitInnovations: gives the genes in the log their real IDs, as if
+         * they had been assigned when the genes were made.  nodeIDs[a] and
+         * linkIDs[a] receive the IDs of new node a and new link a.  Logs must
+         * be committed in a fixed order for the IDs to be deterministic.
+         */
+        NEAT_DLL_EXPORT void commitInnovations(const InnovationLog &log,vector<int> &nodeIDs,vector<int> &linkIDs);
+
         NEAT_DLL_EXPORT int generateSpeciesID();
 
         NEAT_DLL_EXPORT void addParameter(string name,double value);
@@ -157,6 +349,19 @@ namespace NEAT
 
         NEAT_DLL_EXPORT double getParameterValue(string name);
 
+        /**
+         * getParameterValue: reads a hot path parameter without a map lookup
+         */
+        inline double getParameterValue(ParameterSlot slot)
+        {
+            if (!parameterSlotSet[slot])
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO(string("Tried to get a missing parameter: ")+parameterSlotNames[slot]);
+            }
+
+            return parameterSlotValues[slot];
+        }
+
         NEAT_DLL_EXPORT void setParameterValue(string name,double value);
 
         inline StackMap<string,double,4096>::iterator getMapBegin()
@@ -171,10 +376,23 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void initRandom();
 
-        inline Random &getRandom()
-        {
-            return random;
-        }
+        /**
+         * getRandom: returns the calling thread's random stream if one was
+         * set with setRandomStream, otherwise the shared generator.
+         */
+        NEAT_DLL_EXPORT Random &getRandom();
+
+        /**
+         * setRandomStream: makes getRandom() on the calling thread draw from
+         * a stream derived from (seed, generation, individual), so an
+         * evaluation sees the same numbers whichever thread runs it.
+         */
+        NEAT_DLL_EXPORT void setRandomStream(int generation,int individual);
+
+        /**
+         * clearRandomStream: returns the calling thread to the shared generator
+         */
+        NEAT_DLL_EXPORT void clearRandomStream();
 
         NEAT_DLL_EXPORT void seedRandom(unsigned int newSeed);
 
@@ -195,6 +413,30 @@ namespace NEAT
 			return useTanhSigmoid;
 		}
 
+		inline FastNetworkEngine getFastNetworkEngine()
+		{
+			return fastNetworkEngine;
+		}
+
+		inline LayeredNetworkEngine getLayeredNetworkEngine()
+		{
+			return layeredNetworkEngine;
+		}
+
+		inline LayeredNetworkInputs getLayeredNetworkInputs()
+		{
+			return layeredNetworkInputs;
+		}
+
+		/**
+		 * getFrameSkip: the number of frames an agent holds each action it
+		 * picks for (the FrameSkip parameter, at least 1, default 1)
+		 */
+		inline int getFrameSkip()
+		{
+			return frameSkip;
+		}
+
     protected:
         NEAT_DLL_EXPORT Globals();
 
@@ -208,7 +450,17 @@ namespace NEAT
 
         int generateLinkID();
 
+        /**
+         * registerLink: returns the innovation number of a link between the two
+         * nodes, making a new one if no such link was made this generation
+         */
+        int registerLink(int fromNodeID,int toNodeID);
+
+        void rebuildLinkHistoryIndex();
+
 		void cacheParameters();
+
+        void updateParameterSlot(const string &name,double value);
     };
 
 }
@@ -12,6 +12,9 @@
 
 namespace NEAT
 {
+    template<class NetworkDataType>
+    class LinkWeightPair;
+
     class LayeredSubstrateInfo
     {
     public:
@@ -160,6 +163,15 @@ namespace NEAT
         }
 		
 	protected:
+        int flushCppnBatch(
+            NEAT::FastNetwork<NetworkDataType> &cppn,
+            vector<NetworkDataType> &batchValues,
+            int batchSize,
+            int outputIndex,
+            vector<JGTL::Vector3<int> > &batchInputNodes,
+            vector<JGTL::Vector3<int> > &batchOutputNodes,
+            map<JGTL::Vector3<int>, vector<LinkWeightPair<NetworkDataType> > > &allIncomingLinks
+            );
 	};
 }
 
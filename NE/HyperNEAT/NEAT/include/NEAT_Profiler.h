@@ -0,0 +1,130 @@
+#ifndef NEAT_PROFILER_H_INCLUDED
+#define NEAT_PROFILER_H_INCLUDED
+
+#include "NEAT_Defines.h"
+
+/**
+ *  Timing of the hot paths of a run, on top of JGTL's QuickProf.  Each
+ *  generation is one profiling cycle, and after every generation the time
+ *  of each scope goes to the profile file.
+ */
+
+namespace NEAT
+{
+    /**
+     *  Profiler: collects the time of the scopes in each generation.
+     *
+     *  Profiling is off until start() is called.  While it is off a scope
+     *  costs one test of a flag.  Each scope name is given an ID the first
+     *  time its NEAT_PROFILE_SCOPE runs.  Scopes may run on any thread: each
+     *  thread adds the time of its scopes to its own counters, and
+     *  endGeneration() merges the counters of all threads, so the threads
+     *  never wait on each other.  The time of a scope that runs on several
+     *  threads at once is the sum over the threads, so it can exceed the time
+     *  of the generation.  A scope's time includes that of the scopes inside
+     *  it.
+     *
+     *  A profile file whose name ends in .json gets one JSON object per
+     *  generation and line.  Any other file gets CSV rows of generation,
+     *  scope, milliseconds and percent of the generation, where the scope
+     *  "generation" is the wall time of the whole generation.
+     */
+    class Profiler
+    {
+    protected:
+        NEAT_DLL_EXPORT static bool enabled;
+
+    public:
+        static inline bool isEnabled()
+        {
+            return enabled;
+        }
+
+        /**
+         *  start: turns profiling on and appends the summaries to fileName
+         */
+        NEAT_DLL_EXPORT static void start(const string &fileName);
+
+        /**
+         *  stop: turns profiling off and closes the profile file
+         */
+        NEAT_DLL_EXPORT static void stop();
+
+        NEAT_DLL_EXPORT static void beginGeneration();
+
+        /**
+         *  endGeneration: ends the cycle begun by beginGeneration() and
+         *  writes its summary under the given generation number
+         */
+        NEAT_DLL_EXPORT static void endGeneration(int generation);
+
+        NEAT_DLL_EXPORT static unsigned long getMicroseconds();
+
+        /**
+         *  getScopeID: returns the ID of the scope with the given name,
+         *  giving it one if it has none yet
+         */
+        NEAT_DLL_EXPORT static int getScopeID(const char *scope);
+
+        /**
+         *  addTime: adds to the time of a scope on the calling thread
+         */
+        NEAT_DLL_EXPORT static void addTime(int scopeID,unsigned long microseconds);
+    };
+
+    /**
+     *  ProfileScope: times the rest of the enclosing block under the given
+     *  name.  Use NEAT_PROFILE_SCOPE rather than naming one.
+     */
+    class ProfileScope
+    {
+    protected:
+        int scopeID;
+        unsigned long startMicroseconds;
+
+    public:
+        /**
+         *  siteScopeID is the ID cache of the call site, -1 until the scope
+         *  first runs with profiling on.  Threads that race to set it all
+         *  write the same ID.
+         */
+        inline ProfileScope(const char *scope,int &siteScopeID)
+            :
+            scopeID(-1),
+            startMicroseconds(0)
+        {
+            if (Profiler::isEnabled())
+            {
+                if (siteScopeID<0)
+                {
+                    siteScopeID = Profiler::getScopeID(scope);
+                }
+                scopeID = siteScopeID;
+                startMicroseconds = Profiler::getMicroseconds();
+            }
+        }
+
+        inline ~ProfileScope()
+        {
+            if (scopeID>=0)
+            {
+                Profiler::addTime(scopeID,Profiler::getMicroseconds()-startMicroseconds);
+            }
+        }
+    };
+}
+
+#define NEAT_PROFILE_SCOPE_VARIABLE2(line) neatProfileScope##line
+#define NEAT_PROFILE_SCOPE_VARIABLE(line) NEAT_PROFILE_SCOPE_VARIABLE2(line)
+#define NEAT_PROFILE_SCOPE_ID2(line) neatProfileScopeID##line
+#define NEAT_PROFILE_SCOPE_ID(line) NEAT_PROFILE_SCOPE_ID2(line)
+
+/**
+ *  NEAT_PROFILE_SCOPE: times the rest of the enclosing block.  The name
+ *  must be a string literal.  The name is looked up once per call site.
+ */
+#define NEAT_PROFILE_SCOPE(scope) \
+    static int NEAT_PROFILE_SCOPE_ID(__LINE__) = -1; \
+    NEAT::ProfileScope NEAT_PROFILE_SCOPE_VARIABLE(__LINE__)(scope,NEAT_PROFILE_SCOPE_ID(__LINE__))
+
+#endif // NEAT_PROFILER_H_INCLUDED
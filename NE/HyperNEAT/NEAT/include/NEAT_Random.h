@@ -62,6 +62,18 @@ namespace NEAT
         {
             return seed;
         }
+
+        /**
+         * deriveSeed: hashes (seed, stream, substream) into a seed for an
+         * independent stream.  The result is a valid, non-zero generator seed.
+         */
+        NEAT_DLL_EXPORT static unsigned int deriveSeed(unsigned int seed,int stream,int substream);
+
+        /**
+         * mixBits: scrambles a 64 bit value so that every input bit affects
+         * every output bit.  Used to build hashes.
+         */
+        NEAT_DLL_EXPORT static unsigned long long mixBits(unsigned long long value);
     protected:
     };
 }
@@ -0,0 +1,234 @@
+#ifndef NEAT_ROWSUMS_H_INCLUDED
+#define NEAT_ROWSUMS_H_INCLUDED
+
+//The AVX2 kernels are compiled for AVX2 on their own, so they are there in
+//builds for plain SSE2 and are picked at run time on CPUs that have AVX2
+#if defined(__AVX2__)
+#define NEAT_ROWSUMS_AVX2
+#define NEAT_ROWSUMS_AVX2_TARGET
+#elif (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || __GNUC__>4 || (__GNUC__==4 && __GNUC_MINOR__>=9))
+#define NEAT_ROWSUMS_AVX2
+#define NEAT_ROWSUMS_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && _MSC_VER>=1800 && (defined(_M_IX86) || defined(_M_X64))
+#define NEAT_ROWSUMS_AVX2
+#define NEAT_ROWSUMS_AVX2_TARGET
+#endif
+
+#ifdef NEAT_ROWSUMS_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/**
+ *  Row sums over compressed sparse row (CSR) weights, shared by the
+ *  compiled engines of FastNetwork and FastLayeredNetwork.  A row is the
+ *  list of (fromNode,weight) pairs feeding one node.
+ */
+
+namespace NEAT
+{
+    /**
+     *  compiledRowSum: sums one CSR row in order
+     */
+    template<class Type>
+    inline Type compiledRowSum(const Type *values,const int *fromNodes,const Type *weights,int count)
+    {
+        Type sum = 0;
+        for (int a=0;a<count;a++)
+        {
+            sum += values[fromNodes[a]]*weights[a];
+        }
+        return sum;
+    }
+
+    /**
+     *  compiledRowSums: sums every CSR row in link order.  Four rows are
+     *  summed side by side so the additions form four independent chains;
+     *  each row still adds its links in order.
+     */
+    template<class Type>
+    inline void compiledRowSums(
+        const Type *values,
+        const int *rowStart,
+        const int *fromNodes,
+        const Type *weights,
+        Type *rowValues,
+        int numRows
+        )
+    {
+        int row=0;
+        for (;row+4<=numRows;row+=4)
+        {
+            const int *from0 = fromNodes+rowStart[row  ];
+            const int *from1 = fromNodes+rowStart[row+1];
+            const int *from2 = fromNodes+rowStart[row+2];
+            const int *from3 = fromNodes+rowStart[row+3];
+            const Type *weight0 = weights+rowStart[row  ];
+            const Type *weight1 = weights+rowStart[row+1];
+            const Type *weight2 = weights+rowStart[row+2];
+            const Type *weight3 = weights+rowStart[row+3];
+            int count0 = rowStart[row+1]-rowStart[row  ];
+            int count1 = rowStart[row+2]-rowStart[row+1];
+            int count2 = rowStart[row+3]-rowStart[row+2];
+            int count3 = rowStart[row+4]-rowStart[row+3];
+            int common = min(min(count0,count1),min(count2,count3));
+
+            Type sum0=0,sum1=0,sum2=0,sum3=0;
+            int a=0;
+            for (;a<common;a++)
+            {
+                sum0 += values[from0[a]]*weight0[a];
+                sum1 += values[from1[a]]*weight1[a];
+                sum2 += values[from2[a]]*weight2[a];
+                sum3 += values[from3[a]]*weight3[a];
+            }
+            for (int b=a;b<count0;b++) sum0 += values[from0[b]]*weight0[b];
+            for (int b=a;b<count1;b++) sum1 += values[from1[b]]*weight1[b];
+            for (int b=a;b<count2;b++) sum2 += values[from2[b]]*weight2[b];
+            for (int b=a;b<count3;b++) sum3 += values[from3[b]]*weight3[b];
+
+            rowValues[row  ] = sum0;
+            rowValues[row+1] = sum1;
+            rowValues[row+2] = sum2;
+            rowValues[row+3] = sum3;
+        }
+        for (;row<numRows;row++)
+        {
+            int start = rowStart[row];
+            rowValues[row] = compiledRowSum(values,fromNodes+start,weights+start,rowStart[row+1]-start);
+        }
+    }
+
+#ifdef NEAT_ROWSUMS_AVX2
+    /**
+     *  cpuHasAvx2: true when the CPU and the operating system support AVX2
+     */
+    inline bool cpuHasAvx2()
+    {
+#if defined(__AVX2__)
+        return true;
+#elif defined(_MSC_VER)
+        int info[4];
+        __cpuid(info,0);
+        if (info[0]<7)
+        {
+            return false;
+        }
+        __cpuid(info,1);
+        //OSXSAVE and AVX, then the OS must save the YMM registers
+        if ((info[2]&0x18000000)!=0x18000000 || (_xgetbv(0)&6)!=6)
+        {
+            return false;
+        }
+        __cpuidex(info,7,0);
+        return (info[1]&0x20)!=0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2")!=0;
+#endif
+    }
+
+    /**
+     *  canUseRowSumsSimd: true when compiledRowSumsSimd runs the AVX2 kernels.
+     *  The CPU is only asked once.
+     */
+    inline bool canUseRowSumsSimd()
+    {
+        static const bool hasAvx2 = cpuHasAvx2();
+        return hasAvx2;
+    }
+
+    /**
+     *  compiledRowSumSimd: sums one CSR row across AVX2 lanes.  The order of
+     *  the additions differs from compiledRowSum.
+     */
+    NEAT_ROWSUMS_AVX2_TARGET inline float compiledRowSumSimd(const float *values,const int *fromNodes,const float *weights,int count)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        int a=0;
+        for (;a+8<=count;a+=8)
+        {
+            __m256i indices = _mm256_loadu_si256((const __m256i*)(fromNodes+a));
+            __m256 fromValues = _mm256_i32gather_ps(values,indices,4);
+            sum = _mm256_add_ps(sum,_mm256_mul_ps(fromValues,_mm256_loadu_ps(weights+a)));
+        }
+
+        float lanes[8];
+        _mm256_storeu_ps(lanes,sum);
+        float total = ((lanes[0]+lanes[1])+(lanes[2]+lanes[3]))+((lanes[4]+lanes[5])+(lanes[6]+lanes[7]));
+        for (;a<count;a++)
+        {
+            total += values[fromNodes[a]]*weights[a];
+        }
+        return total;
+    }
+
+    NEAT_ROWSUMS_AVX2_TARGET inline double compiledRowSumSimd(const double *values,const int *fromNodes,const double *weights,int count)
+    {
+        __m256d sum = _mm256_setzero_pd();
+        //The masked gather with a zero source, as GCC warns about the
+        //undefined source of _mm256_i32gather_pd
+        __m256d allLanes = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+        int a=0;
+        for (;a+4<=count;a+=4)
+        {
+            __m128i indices = _mm_loadu_si128((const __m128i*)(fromNodes+a));
+            __m256d fromValues = _mm256_mask_i32gather_pd(_mm256_setzero_pd(),values,indices,allLanes,8);
+            sum = _mm256_add_pd(sum,_mm256_mul_pd(fromValues,_mm256_loadu_pd(weights+a)));
+        }
+
+        double lanes[4];
+        _mm256_storeu_pd(lanes,sum);
+        double total = (lanes[0]+lanes[1])+(lanes[2]+lanes[3]);
+        for (;a<count;a++)
+        {
+            total += values[fromNodes[a]]*weights[a];
+        }
+        return total;
+    }
+
+    /**
+     *  compiledRowSumsSimd: sums every CSR row with compiledRowSumSimd.  Only
+     *  call it when canUseRowSumsSimd() is true.
+     */
+    template<class Type>
+    NEAT_ROWSUMS_AVX2_TARGET inline void compiledRowSumsSimd(
+        const Type *values,
+        const int *rowStart,
+        const int *fromNodes,
+        const Type *weights,
+        Type *rowValues,
+        int numRows
+        )
+    {
+        for (int row=0;row<numRows;row++)
+        {
+            int start = rowStart[row];
+            rowValues[row] = compiledRowSumSimd(values,fromNodes+start,weights+start,rowStart[row+1]-start);
+        }
+    }
+#else
+    inline bool canUseRowSumsSimd()
+    {
+        return false;
+    }
+
+    template<class Type>
+    inline void compiledRowSumsSimd(
+        const Type *values,
+        const int *rowStart,
+        const int *fromNodes,
+        const Type *weights,
+        Type *rowValues,
+        int numRows
+        )
+    {
+        compiledRowSums(values,rowStart,fromNodes,weights,rowValues,numRows);
+    }
+#endif
+}
+
+#endif // NEAT_ROWSUMS_H_INCLUDED
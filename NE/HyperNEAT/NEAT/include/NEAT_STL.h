@@ -29,6 +29,7 @@
 #include <ctime>
 #include <cmath>
 #include <climits>
+#include <cfloat>
 #include <sstream>
 #include <list>
 #include <map>
@@ -0,0 +1,517 @@
+#include "NEAT.h"
+
+#include "NEAT_GeneticIndividual.h"
+#include "NEAT_GeneticPopulation.h"
+#include "NEAT_RowSums.h"
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace NEAT;
+
+/**
+ *  NEAT_Benchmark: micro benchmarks for the NEAT library hot paths.
+ *  Build with BUILD_BENCHMARKS=ON and run NEATBenchmark [iterations].
+ */
+
+#define NEAT_BENCHMARK_DEFAULT_ITERATIONS (200000)
+
+namespace
+{
+    //Every timed loop adds its outputs to a sink, and the sinks end up here, so
+    //the work can't be optimized away
+    double outputChecksum = 0;
+
+    const int numCppnInputs = 7;
+    const char *cppnInputNames[numCppnInputs] =
+    {
+        "X1","Y1","X2","Y2","DeltaX","DeltaY","Bias"
+    };
+
+    double secondsSince(clock_t start)
+    {
+        return double(clock()-start)/CLOCKS_PER_SEC;
+    }
+
+    void printResult(const string &name,double seconds,int iterations,const string &unit="query")
+    {
+        cout << "    " << setw(32) << left << name << right
+            << setw(12) << setprecision(4) << fixed << (seconds*1e9/iterations) << " ns/" << unit
+            << endl;
+    }
+
+    /**
+     *  createCppnGenes: creates the input and output nodes used by LayeredSubstrate
+     */
+    vector<GeneticNodeGene> createCppnGenes()
+    {
+        vector<GeneticNodeGene> genes;
+
+        for (int a=0;a<numCppnInputs;a++)
+        {
+            genes.push_back(GeneticNodeGene(cppnInputNames[a],"NetworkSensor",0,false));
+        }
+        genes.push_back(GeneticNodeGene("Output_0","NetworkOutputNode",1,false,ACTIVATION_FUNCTION_SIGMOID));
+
+        return genes;
+    }
+
+    /**
+     *  createCppn: creates a mutated CPPN from the given nodes.  CPPNs which
+     *  should share their link IDs, like the members of a population, must
+     *  start from the same nodes.
+     */
+    shared_ptr<GeneticIndividual> createCppn(int mutations,const vector<GeneticNodeGene> &genes=createCppnGenes())
+    {
+        shared_ptr<GeneticIndividual> individual(new GeneticIndividual(genes,true,1.0));
+
+        for (int a=0;a<mutations;a++)
+        {
+            individual->testMutate();
+        }
+
+        return individual;
+    }
+
+    /**
+     *  benchmarkNodeAccess: compares one CPPN query (set the inputs, update,
+     *  read the output) through node names against the same query through
+     *  indices from getNodeIndex().
+     */
+    void benchmarkNodeAccess(int iterations)
+    {
+        cout << "FastNetwork node access:" << endl;
+
+        FastNetwork<float> network = createCppn(50)->spawnFastPhenotypeStack<float>();
+
+        string inputNames[numCppnInputs];
+        int inputIndices[numCppnInputs];
+        for (int a=0;a<numCppnInputs;a++)
+        {
+            inputNames[a] = cppnInputNames[a];
+            inputIndices[a] = network.getNodeIndex(inputNames[a]);
+        }
+        string outputName("Output_0");
+        int outputIndex = network.getNodeIndex(outputName);
+
+        volatile float sink=0;
+        clock_t start;
+
+        start = clock();
+        for (int i=0;i<iterations;i++)
+        {
+            network.reinitialize();
+            for (int a=0;a<numCppnInputs;a++)
+            {
+                network.setValue(inputNames[a],float(i%17)/17.0f);
+            }
+            sink += network.getValue(outputName);
+        }
+        double namedAccessTime = secondsSince(start);
+
+        start = clock();
+        for (int i=0;i<iterations;i++)
+        {
+            network.reinitialize();
+            for (int a=0;a<numCppnInputs;a++)
+            {
+                network.setValue(inputIndices[a],float(i%17)/17.0f);
+            }
+            sink += network.getValue(outputIndex);
+        }
+        double indexedAccessTime = secondsSince(start);
+
+        start = clock();
+        for (int i=0;i<iterations;i++)
+        {
+            network.reinitialize();
+            for (int a=0;a<numCppnInputs;a++)
+            {
+                network.setValue(inputNames[a],float(i%17)/17.0f);
+            }
+            network.update();
+            sink += network.getValue(outputName);
+        }
+        double namedQueryTime = secondsSince(start);
+
+        start = clock();
+        for (int i=0;i<iterations;i++)
+        {
+            network.reinitialize();
+            for (int a=0;a<numCppnInputs;a++)
+            {
+                network.setValue(inputIndices[a],float(i%17)/17.0f);
+            }
+            network.update();
+            sink += network.getValue(outputIndex);
+        }
+        double indexedQueryTime = secondsSince(start);
+
+        printResult("set/get by name",namedAccessTime,iterations);
+        printResult("set/get by index",indexedAccessTime,iterations);
+        printResult("query by name",namedQueryTime,iterations);
+        printResult("query by index",indexedQueryTime,iterations);
+        outputChecksum += sink;
+    }
+
+    /**
+     *  benchmarkEngines: times update() on a fully connected substrate sized
+     *  network with each FastNetworkEngine
+     */
+    void benchmarkEngines(int iterations)
+    {
+        cout << "FastNetwork engines (256 inputs x 64 outputs, CSR SIMD "
+            << (canUseRowSumsSimd() ? "with AVX2" : "without AVX2") << "):" << endl;
+
+        vector<GeneticNodeGene> genes;
+        for (int a=0;a<256;a++)
+        {
+            genes.push_back(GeneticNodeGene(string("Input_")+toString(a),"NetworkSensor",0,false));
+        }
+        for (int a=0;a<64;a++)
+        {
+            genes.push_back(GeneticNodeGene(string("Output_")+toString(a),"NetworkOutputNode",1,false,ACTIVATION_FUNCTION_SIGMOID));
+        }
+
+        shared_ptr<GeneticIndividual> individual(new GeneticIndividual(genes,true,1.0));
+        FastNetwork<float> network = individual->spawnFastPhenotypeStack<float>();
+
+        vector<int> inputIndices;
+        for (int a=0;a<256;a++)
+        {
+            inputIndices.push_back(network.getNodeIndex(string("Input_")+toString(a)));
+        }
+        int outputIndex = network.getNodeIndex("Output_0");
+
+        //The substrate is much bigger than a CPPN, so run fewer updates
+        int updates = max(1,iterations/100);
+
+        const char *engineNames[FAST_NETWORK_ENGINE_END] = { "links","CSR","CSR SIMD","tape" };
+        for (int engine=0;engine<FAST_NETWORK_ENGINE_END;engine++)
+        {
+            Globals::getSingleton()->setParameterValue("FastNetworkEngine",engine);
+
+            volatile float sink=0;
+            clock_t start = clock();
+            for (int i=0;i<updates;i++)
+            {
+                network.reinitialize();
+                network.dummyActivation();
+                for (int a=0;a<256;a++)
+                {
+                    network.setValue(inputIndices[a],float((i+a)%17)/17.0f);
+                }
+                network.update();
+                sink += network.getValue(outputIndex);
+            }
+            printResult(engineNames[engine],secondsSince(start),updates,"update");
+            outputChecksum += sink;
+        }
+
+        Globals::getSingleton()->setParameterValue("FastNetworkEngine",FAST_NETWORK_ENGINE_LINKS);
+    }
+
+    /**
+     *  benchmarkCppnEngines: times a full CPPN query (reinitialize, set the
+     *  inputs, first update with its extra activation updates, read the
+     *  output) with each FastNetworkEngine, and checks that the tape gives
+     *  the same output as the link list
+     */
+    void benchmarkCppnEngines(int iterations)
+    {
+        cout << "CPPN query engines (" << (1+Globals::getSingleton()->getExtraActivationUpdates())
+            << " updates per query):" << endl;
+
+        FastNetwork<float> network = createCppn(50)->spawnFastPhenotypeStack<float>();
+
+        int inputIndices[numCppnInputs];
+        for (int a=0;a<numCppnInputs;a++)
+        {
+            inputIndices[a] = network.getNodeIndex(cppnInputNames[a]);
+        }
+        int outputIndex = network.getNodeIndex("Output_0");
+
+        const char *engineNames[FAST_NETWORK_ENGINE_END] = { "links","CSR","CSR SIMD","tape" };
+        float outputSums[FAST_NETWORK_ENGINE_END];
+        for (int engine=0;engine<FAST_NETWORK_ENGINE_END;engine++)
+        {
+            Globals::getSingleton()->setParameterValue("FastNetworkEngine",engine);
+
+            float outputSum=0;
+            clock_t start = clock();
+            for (int i=0;i<iterations;i++)
+            {
+                network.reinitialize();
+                for (int a=0;a<numCppnInputs;a++)
+                {
+                    network.setValue(inputIndices[a],float((i+a)%17)/17.0f);
+                }
+                network.update();
+                outputSum += network.getValue(outputIndex);
+            }
+            printResult(engineNames[engine],secondsSince(start),iterations);
+            outputSums[engine] = outputSum;
+        }
+
+        if (outputSums[FAST_NETWORK_ENGINE_TAPE]!=outputSums[FAST_NETWORK_ENGINE_LINKS])
+        {
+            cout << "    WARNING: tape and link list outputs differ" << endl;
+        }
+
+        Globals::getSingleton()->setParameterValue("FastNetworkEngine",FAST_NETWORK_ENGINE_LINKS);
+    }
+
+    /**
+     *  benchmarkLayeredEngines: times FastLayeredNetwork::update() between two
+     *  64x64 layers at several weight densities with each LayeredNetworkEngine
+     */
+    void benchmarkLayeredEngines(int iterations)
+    {
+        cout << "FastLayeredNetwork engines (64x64 -> 64x64):" << endl;
+
+        const int size = 64;
+        vector<JGTL::Vector2<int> > layerSizes(1,JGTL::Vector2<int>(size,size));
+        vector<int> noFromLayers;
+        vector<int> fromInputLayer(1,0);
+
+        int updates = max(1,iterations/2000);
+
+        const double densities[] = { 1.0,0.5,0.3,0.1,0.01 };
+        const char *engineNames[LAYERED_NETWORK_ENGINE_END] = { "dense","adaptive","adaptive SIMD" };
+        for (int d=0;d<int(sizeof(densities)/sizeof(double));d++)
+        {
+            vector<NetworkLayer<float> > layers;
+            layers.push_back(NetworkLayer<float>("Input",size*size,size,noFromLayers,layerSizes));
+            layers.push_back(NetworkLayer<float>("Output",size*size,size,fromInputLayer,layerSizes));
+            FastLayeredNetwork<float> network(layers);
+
+            for (int y2=0;y2<size;y2++)
+            {
+                for (int x2=0;x2<size;x2++)
+                {
+                    for (int y1=0;y1<size;y1++)
+                    {
+                        for (int x1=0;x1<size;x1++)
+                        {
+                            if (Globals::getSingleton()->getRandom().getRandomDouble()<densities[d])
+                            {
+                                network.setLink(
+                                    Node(x1,y1,0),
+                                    Node(x2,y2,1),
+                                    float(Globals::getSingleton()->getRandom().getRandomDouble(-3.0,3.0))
+                                    );
+                            }
+                        }
+                    }
+                }
+            }
+
+            for (int engine=0;engine<LAYERED_NETWORK_ENGINE_END;engine++)
+            {
+                Globals::getSingleton()->setParameterValue("LayeredNetworkEngine",engine);
+
+                //Leave the one-off compileWeights() out of the timing
+                network.update();
+
+                volatile float sink=0;
+                clock_t start = clock();
+                for (int i=0;i<updates;i++)
+                {
+                    network.reinitialize();
+                    for (int a=0;a<size;a++)
+                    {
+                        network.setValue(Node(a,(i+a)%size,0),float((i+a)%17)/17.0f);
+                    }
+                    network.update();
+                    sink += network.getValue(Node(0,0,1));
+                }
+                printResult(
+                    string(engineNames[engine])+" @ "+toString(densities[d]),
+                    secondsSince(start),
+                    updates,
+                    "update"
+                    );
+                outputChecksum += sink;
+            }
+        }
+
+        Globals::getSingleton()->setParameterValue("LayeredNetworkEngine",LAYERED_NETWORK_ENGINE_DENSE);
+    }
+
+    /**
+     *  benchmarkLayeredInputs: times FastLayeredNetwork::update() from a 64x64
+     *  input layer in which only a few nodes are set, with each
+     *  LayeredNetworkInputs mode.  As with objects on a game screen, one
+     *  node moves on every update and the others stay where they are.
+     */
+    void benchmarkLayeredInputs(int iterations)
+    {
+        cout << "FastLayeredNetwork inputs (64x64 -> 64x64, fully connected):" << endl;
+
+        const int size = 64;
+        vector<JGTL::Vector2<int> > layerSizes(1,JGTL::Vector2<int>(size,size));
+        vector<int> noFromLayers;
+        vector<int> fromInputLayer(1,0);
+
+        vector<NetworkLayer<float> > layers;
+        layers.push_back(NetworkLayer<float>("Input",size*size,size,noFromLayers,layerSizes));
+        layers.push_back(NetworkLayer<float>("Output",size*size,size,fromInputLayer,layerSizes));
+        FastLayeredNetwork<float> network(layers);
+
+        for (int y2=0;y2<size;y2++)
+        {
+            for (int x2=0;x2<size;x2++)
+            {
+                for (int y1=0;y1<size;y1++)
+                {
+                    for (int x1=0;x1<size;x1++)
+                    {
+                        network.setLink(
+                            Node(x1,y1,0),
+                            Node(x2,y2,1),
+                            float(Globals::getSingleton()->getRandom().getRandomDouble(-3.0,3.0))
+                            );
+                    }
+                }
+            }
+        }
+
+        int updates = max(1,iterations/2000);
+
+        const int activeCounts[] = { 4,64,1024 };
+        const char *inputsNames[LAYERED_NETWORK_INPUTS_END] = { "dense","sparse","incremental" };
+        for (int c=0;c<int(sizeof(activeCounts)/sizeof(int));c++)
+        {
+            int spacing = (size*size)/activeCounts[c];
+
+            for (int inputs=0;inputs<LAYERED_NETWORK_INPUTS_END;inputs++)
+            {
+                Globals::getSingleton()->setParameterValue("LayeredNetworkInputs",inputs);
+
+                //Leave the one-off compileWeights() out of the timing
+                network.update();
+
+                volatile float sink=0;
+                clock_t start = clock();
+                for (int i=0;i<updates;i++)
+                {
+                    network.reinitialize();
+                    network.setValue(Node(i%size,(i/size)%size,0),1.0f);
+                    for (int a=1;a<activeCounts[c];a++)
+                    {
+                        network.setValue(Node((a*spacing)%size,(a*spacing)/size,0),1.0f);
+                    }
+                    network.update();
+                    sink += network.getValue(Node(0,0,1));
+                }
+                printResult(
+                    string(inputsNames[inputs])+", "+toString(activeCounts[c])+" set",
+                    secondsSince(start),
+                    updates,
+                    "update"
+                    );
+                outputChecksum += sink;
+            }
+        }
+
+        Globals::getSingleton()->setParameterValue("LayeredNetworkInputs",LAYERED_NETWORK_INPUTS_DENSE);
+    }
+
+    /**
+     *  createPopulation: creates a population of independently mutated CPPNs
+     *  with random positive fitness
+     */
+    shared_ptr<GeneticPopulation> createPopulation(const vector<shared_ptr<GeneticIndividual> > &individuals)
+    {
+        shared_ptr<GeneticPopulation> population(new GeneticPopulation());
+        for (int a=0;a<(int)individuals.size();a++)
+        {
+            population->addIndividual(
+                shared_ptr<GeneticIndividual>(new GeneticIndividual(*individuals[a]))
+                );
+        }
+        return population;
+    }
+
+    /**
+     *  benchmarkSpeciation: times getCompatibility with and without the early
+     *  exit bound, and a speciation pass with 1, 2, 4 and 8 threads.  The
+     *  timed pass runs after a first pass has created the species, as in
+     *  every generation after the first.
+     */
+    void benchmarkSpeciation(int iterations)
+    {
+        const int populationSize = 2000;
+
+        cout << "Speciation (" << populationSize << " individuals):" << endl;
+
+        vector<GeneticNodeGene> genes = createCppnGenes();
+        vector<shared_ptr<GeneticIndividual> > individuals;
+        for (int a=0;a<populationSize;a++)
+        {
+            individuals.push_back(createCppn(10+a%40,genes));
+            individuals.back()->setFitness(Globals::getSingleton()->getRandom().getRandomDouble(1.0,10.0));
+        }
+
+        double compatThreshold = Globals::getSingleton()->getParameterValue("CompatibilityThreshold");
+
+        volatile double sink=0;
+        clock_t start = clock();
+        for (int i=0;i<iterations;i++)
+        {
+            sink += individuals[i%populationSize]->getCompatibility(individuals[(i*7+1)%populationSize]);
+        }
+        printResult("compatibility",secondsSince(start),iterations,"pair");
+
+        start = clock();
+        for (int i=0;i<iterations;i++)
+        {
+            sink += individuals[i%populationSize]->getCompatibility(individuals[(i*7+1)%populationSize],compatThreshold);
+        }
+        printResult("compatibility with bound",secondsSince(start),iterations,"pair");
+        outputChecksum += sink;
+
+        //Threads mostly wait on each other, so use wall time here
+        const int threadCounts[] = { 1,2,4,8 };
+        for (int t=0;t<int(sizeof(threadCounts)/sizeof(int));t++)
+        {
+            shared_ptr<GeneticPopulation> population = createPopulation(individuals);
+            Globals::getSingleton()->setParameterValue("CompatibilityThreshold",compatThreshold);
+            Globals::getSingleton()->setParameterValue("SpeciationThreads",threadCounts[t]);
+            population->speciate();
+            Globals::getSingleton()->setParameterValue("CompatibilityThreshold",compatThreshold);
+
+            boost::posix_time::ptime wallStart = boost::posix_time::microsec_clock::universal_time();
+            population->speciate();
+            double seconds = (boost::posix_time::microsec_clock::universal_time()-wallStart).total_microseconds()/1e6;
+
+            printResult(string("speciate, ")+toString(threadCounts[t])+" threads",seconds,populationSize,"individual");
+        }
+
+        Globals::getSingleton()->setParameterValue("CompatibilityThreshold",compatThreshold);
+        Globals::getSingleton()->setParameterValue("SpeciationThreads",1);
+    }
+}
+
+int main(int argc,char **argv)
+{
+    int iterations = NEAT_BENCHMARK_DEFAULT_ITERATIONS;
+
+    if (argc>1)
+    {
+        iterations = atoi(argv[1]);
+    }
+
+    Globals::init();
+    Globals::getSingleton()->seedRandom(0);
+
+    benchmarkNodeAccess(iterations);
+    benchmarkEngines(iterations);
+    benchmarkCppnEngines(iterations);
+    benchmarkLayeredEngines(iterations);
+    benchmarkLayeredInputs(iterations);
+    benchmarkSpeciation(iterations);
+
+    cout << "Output checksum: " << setprecision(6) << outputChecksum << endl;
+
+    return 0;
+}
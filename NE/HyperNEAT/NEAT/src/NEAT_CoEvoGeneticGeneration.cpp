@@ -5,6 +5,9 @@
 #include "NEAT_GeneticLinkGene.h"
 #include "NEAT_Globals.h"
 
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
 #ifdef EPLEX_INTERNAL
 
 #define DEBUG_REMOVE_STALE_TESTS (1)
@@ -16,6 +19,49 @@
 
 namespace NEAT
 {
+    namespace
+    {
+        /**
+         *  playMatches: plays every (step)th match starting at (first) on one
+         *  experiment.  A failure is stored in (error) and stops this thread.
+         */
+        void playMatches(
+            CoEvoExperiment *experiment,
+            const vector<shared_ptr<GeneticIndividual> > *tests,
+            const vector<pair<int,int> > *matches,
+            int generationNumber,
+            int first,
+            int step,
+            vector<pair<double,double> > *rewards,
+            string *error
+            )
+        {
+            try
+            {
+                for (int a=first;a<(int)matches->size();a+=step)
+                {
+                    //Negative substreams never collide with the individual streams
+                    Globals::getSingleton()->setRandomStream(generationNumber,-1-a);
+
+                    (*rewards)[a] = experiment->playGame(
+                        (*tests)[(*matches)[a].first],
+                        (*tests)[(*matches)[a].second]
+                        );
+                }
+            }
+            catch (const std::exception &e)
+            {
+                *error = e.what();
+            }
+            catch (const string &s)
+            {
+                *error = s;
+            }
+
+            Globals::getSingleton()->clearRandomStream();
+        }
+    }
+
     CoEvoGeneticGeneration::CoEvoGeneticGeneration(int _generationNumber,shared_ptr<CoEvoExperiment> _experiment)
         :
     GeneticGeneration(_generationNumber),
@@ -267,6 +313,20 @@ namespace NEAT
             testA->setFitness(0.0);
         }
 
+        vector<pair<int,int> > matches;
+        for (int a=0;a<getTestCount();a++)
+        {
+            for (int b=(a+1);b<getTestCount();b++)
+            {
+                matches.push_back(pair<int,int>(a,b));
+            }
+        }
+
+        vector<pair<double,double> > matchRewards;
+        playTestMatches(matches,matchRewards);
+
+        //Rewards are handed out in the order of the serial round robin
+        int match=0;
         for (int a=0;a<getTestCount();a++)
         {
             shared_ptr<GeneticIndividual> testA = getTest(a);
@@ -275,10 +335,7 @@ namespace NEAT
             {
                 shared_ptr<GeneticIndividual> testB = getTest(b);
 
-                pair<double,double> rewards = experiment->playGame(
-                    testA,
-                    testB
-                    );
+                pair<double,double> rewards = matchRewards[match++];
 
                 testA->reward(rewards.first);
                 testB->reward(rewards.second);
@@ -336,7 +393,21 @@ namespace NEAT
 
                 //Play games so that it's still true that all tests have played each other
                 //This is important because it's needed for the other tests' fitnesses to be accurate.
+                //The results between the older tests are kept from earlier generations.
+                vector<pair<int,int> > matches;
+                for (int a=0;a<getTestCount();a++)
+                {
+                    if (test != getTest(a))
+                    {
+                        matches.push_back(pair<int,int>(newTestIndex,a));
+                    }
+                }
+
+                vector<pair<double,double> > matchRewards;
+                playTestMatches(matches,matchRewards);
+
                 test->setFitness(0);
+                int match=0;
                 for (int a=0;a<getTestCount();a++)
                 {
 
@@ -345,11 +416,7 @@ namespace NEAT
                     if (test != getTest(a))
                     {
                         //cout << "*";
-                        pair<double,double> rewards =
-                            experiment->playGame(
-                            test,
-                            testA
-                            );
+                        pair<double,double> rewards = matchRewards[match++];
 
                         test->reward(rewards.first);
 
@@ -449,6 +516,79 @@ namespace NEAT
     {
         return testResults[t1][t2];
     }
+
+    void CoEvoGeneticGeneration::playTestMatches(
+        const vector<pair<int,int> > &matches,
+        vector<pair<double,double> > &rewards
+        )
+    {
+        int numMatches = int(matches.size());
+
+        rewards.assign(numMatches,pair<double,double>(0.0,0.0));
+
+        int numThreads = 1;
+        if (Globals::getSingleton()->hasParameterValue("TournamentThreads"))
+        {
+            numThreads = int(Globals::getSingleton()->getParameterValue("TournamentThreads"));
+            if (numThreads<=0)
+            {
+                numThreads = max(1,int(boost::thread::hardware_concurrency()));
+            }
+        }
+        numThreads = max(1,min(numThreads,numMatches));
+
+        //Games keep their state (substrates, search tables) in the experiment,
+        //so every thread needs its own copy
+        vector<shared_ptr<CoEvoExperiment> > experiments;
+        for (int t=0;t<numThreads && numThreads>1;t++)
+        {
+            CoEvoExperiment *clone = experiment->cloneCoEvoExperiment();
+            if (!clone)
+            {
+                experiments.clear();
+                break;
+            }
+            experiments.push_back(shared_ptr<CoEvoExperiment>(clone));
+        }
+
+        vector<string> errors(max(1,int(experiments.size())));
+
+        if (experiments.empty())
+        {
+            playMatches(experiment.get(),&tests,&matches,generationNumber,0,1,&rewards,&errors[0]);
+        }
+        else
+        {
+            //Matches are dealt round robin, so the games between the same tests
+            //(which tend to take about as long) end up on different threads
+            boost::thread_group threads;
+            for (int t=0;t<(int)experiments.size();t++)
+            {
+                threads.create_thread(
+                    boost::bind(
+                        &playMatches,
+                        experiments[t].get(),
+                        &tests,
+                        &matches,
+                        generationNumber,
+                        t,
+                        int(experiments.size()),
+                        &rewards,
+                        &errors[t]
+                        )
+                    );
+            }
+            threads.join_all();
+        }
+
+        for (int t=0;t<(int)errors.size();t++)
+        {
+            if (errors[t].length())
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO(string("Error playing tests: ")+errors[t]);
+            }
+        }
+    }
 }
 
 #endif
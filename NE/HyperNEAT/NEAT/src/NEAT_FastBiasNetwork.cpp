@@ -8,6 +8,8 @@
 
 #include "NEAT_Globals.h"
 
+#include "NEAT_Profiler.h"
+
 #include "NEAT_GeneticLinkGene.h"
 #include "NEAT_GeneticNodeGene.h"
 
@@ -507,6 +509,8 @@ namespace NEAT
 	template<class Type>
 	void FastBiasNetwork<Type>::updateFixedIterations(int iterations)
 	{
+		NEAT_PROFILE_SCOPE("networkUpdate");
+
 		int count=iterations;
 		if (!this->activated)
 		{
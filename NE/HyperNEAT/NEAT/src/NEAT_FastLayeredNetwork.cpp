@@ -8,15 +8,32 @@
 
 #include "NEAT_Globals.h"
 
+#include "NEAT_Profiler.h"
+
 #include "NEAT_GeneticLinkGene.h"
 #include "NEAT_GeneticNodeGene.h"
 
+#include "NEAT_RowSums.h"
+
 #define DEBUG_ACTIVATION_CALCULATION (0)
 
 #define DEBUG_NETWORK_CREATION (0)
 
 #define DEBUG_NETWORK_UPDATE (0)
 
+//Layer pairs with fewer non-zero weights than this are propagated sparsely.
+//Between 64x64 layers the sparse and dense sums take the same time at a
+//density of about 0.4 (floats, with or without AVX2); below 0.3 the sparse
+//sums are at least 20% faster.
+#define LAYERED_NETWORK_SPARSE_DENSITY (0.3)
+
+//Bytes of source values per cache block in the dense dot products (half of
+//a typical L1 data cache: 4096 floats or 2048 doubles)
+#define LAYERED_NETWORK_BLOCK_BYTES (16384)
+
+//Number of incremental updates of an input pair between two full sums
+#define LAYERED_NETWORK_INPUT_REFRESH (64)
+
 namespace NEAT
 {
     extern double signedSigmoidTable[6001];
@@ -26,7 +43,10 @@ namespace NEAT
     FastLayeredNetwork<Type>::FastLayeredNetwork(const vector<NetworkLayer<Type> > &_layers)
         :
         Network<Type>(),
-        layers(_layers)
+        layers(_layers),
+        weightsCompiled(false),
+        inputColumnsCompiled(false),
+        activeInputs(_layers.size())
     {
         //Perform a sanity check on the layers
         for(size_t toLayer=0;toLayer<layers.size();toLayer++)
@@ -45,6 +65,9 @@ namespace NEAT
 
     template<class Type>
     FastLayeredNetwork<Type>::FastLayeredNetwork()
+        :
+        weightsCompiled(false),
+        inputColumnsCompiled(false)
     {
     }
 
@@ -107,7 +130,27 @@ namespace NEAT
             throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
         }
 
-        layer.nodeValues[nodeArrayIndex] = newValue;
+        Type &nodeValue = layer.nodeValues[nodeArrayIndex];
+        if(nodeValue==0 && newValue!=0 && layer.fromLayers.empty())
+        {
+            vector<int> &active = activeInputs[nodeIndex.z];
+            if(active.size()>=layer.nodeValues.size())
+            {
+                //Nodes keep going back to zero without a reinitialize(), so
+                //list the ones that are still set instead of growing the list
+                active.clear();
+                for(int a=0;a<(int)layer.nodeValues.size();a++)
+                {
+                    if(layer.nodeValues[a]!=0)
+                    {
+                        active.push_back(a);
+                    }
+                }
+            }
+            active.push_back(nodeArrayIndex);
+        }
+
+        nodeValue = newValue;
     }
 
     template<class Type>
@@ -171,12 +214,357 @@ namespace NEAT
             }
 
             toLayer.fromWeights[a][toNodeArrayIndex*toLayer.nodeValues.size()+fromNodeArrayIndex] = weight;
+            weightsCompiled = false;
             return;
         }
 
         throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
     }
 
+    template<class Type>
+    void FastLayeredNetwork<Type>::compileWeights()
+    {
+        size_t maxLayerSize=0;
+
+        bool compileInputs = (Globals::getSingleton()->getLayeredNetworkInputs()!=LAYERED_NETWORK_INPUTS_DENSE);
+
+        compiledWeights.resize(layers.size());
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            NetworkLayer<Type> &layer = layers[layerIndex];
+            int numToNodes = (int)layer.nodeValues.size();
+            maxLayerSize = max(maxLayerSize,layer.nodeValues.size());
+
+            compiledWeights[layerIndex].resize(layer.fromLayers.size());
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                CompiledLayerWeights<Type> &compiled = compiledWeights[layerIndex][a];
+                int numFromNodes = (int)layers[layer.fromLayers[a]].nodeValues.size();
+
+                //Rows are read exactly as update() reads them: the row for a
+                //target node starts at toNode*numToNodes
+                size_t numNonZero=0;
+                for(int toNode=0;toNode<numToNodes;toNode++)
+                {
+                    const Type *weightsPtr = &(layer.fromWeights[a][toNode*layer.nodeValues.size()]);
+                    for(int fromNode=0;fromNode<numFromNodes;fromNode++)
+                    {
+                        if(weightsPtr[fromNode]!=0)
+                        {
+                            numNonZero++;
+                        }
+                    }
+                }
+
+                double numWeights = double(numToNodes)*numFromNodes;
+                compiled.density = numWeights>0 ? numNonZero/numWeights : 1.0;
+                compiled.sparse = (compiled.density<LAYERED_NETWORK_SPARSE_DENSITY);
+
+                //The dense path reads fromWeights directly, so the CSR copy
+                //is only built for sparse pairs
+                vector<int>().swap(compiled.rowStart);
+                vector<int>().swap(compiled.fromNodes);
+                vector<Type>().swap(compiled.weights);
+                if(compiled.sparse)
+                {
+                    compiled.rowStart.assign(numToNodes+1,0);
+                    compiled.fromNodes.reserve(numNonZero);
+                    compiled.weights.reserve(numNonZero);
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        const Type *weightsPtr = &(layer.fromWeights[a][toNode*layer.nodeValues.size()]);
+                        for(int fromNode=0;fromNode<numFromNodes;fromNode++)
+                        {
+                            if(weightsPtr[fromNode]!=0)
+                            {
+                                compiled.fromNodes.push_back(fromNode);
+                                compiled.weights.push_back(weightsPtr[fromNode]);
+                            }
+                        }
+                        compiled.rowStart[toNode+1] = (int)compiled.weights.size();
+                    }
+                }
+
+                if(compileInputs && layers[layer.fromLayers[a]].fromLayers.empty())
+                {
+                    compiled.columns.resize(size_t(numFromNodes)*numToNodes);
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        const Type *weightsPtr = &(layer.fromWeights[a][toNode*layer.nodeValues.size()]);
+                        for(int fromNode=0;fromNode<numFromNodes;fromNode++)
+                        {
+                            compiled.columns[size_t(fromNode)*numToNodes+toNode] = weightsPtr[fromNode];
+                        }
+                    }
+                    compiled.inputSums.assign(numToNodes,0);
+                    compiled.propagatedValues.assign(numFromNodes,0);
+                }
+                else
+                {
+                    vector<Type>().swap(compiled.columns);
+                    vector<Type>().swap(compiled.inputSums);
+                    vector<Type>().swap(compiled.propagatedValues);
+                }
+                compiled.propagatedNodes.clear();
+                compiled.inputSumsValid = false;
+                compiled.updatesSinceRefresh = 0;
+            }
+        }
+
+        pairSums.resize(maxLayerSize);
+        weightsCompiled = true;
+        inputColumnsCompiled = compileInputs;
+    }
+
+    template<class Type>
+    double FastLayeredNetwork<Type>::getWeightDensity(int layerIndex,int fromLayerIndex)
+    {
+        if(!weightsCompiled)
+        {
+            compileWeights();
+        }
+
+        return compiledWeights[layerIndex][fromLayerIndex].density;
+    }
+
+    /**
+     *  denseRowSums: sums[row] = dot product of fromValues with row 'row' of
+     *  the weights, adding in source node order.  The source nodes are taken
+     *  in cache sized blocks and four rows are summed side by side; neither
+     *  changes the order of the additions within a row.
+     */
+    template<class Type>
+    inline void denseRowSums(
+        const Type *fromValues,
+        int numFromNodes,
+        const Type *weights,
+        size_t rowStride,
+        Type *sums,
+        int numRows
+        )
+    {
+        for(int row=0;row<numRows;row++)
+        {
+            sums[row]=0;
+        }
+
+        const int blockSize = int(LAYERED_NETWORK_BLOCK_BYTES/sizeof(Type));
+        for(int blockStart=0;blockStart<numFromNodes;blockStart+=blockSize)
+        {
+            int blockEnd = min(numFromNodes,blockStart+blockSize);
+
+            int row=0;
+            for(;row+4<=numRows;row+=4)
+            {
+                const Type *weights0 = weights+(row  )*rowStride;
+                const Type *weights1 = weights+(row+1)*rowStride;
+                const Type *weights2 = weights+(row+2)*rowStride;
+                const Type *weights3 = weights+(row+3)*rowStride;
+                Type sum0=sums[row],sum1=sums[row+1],sum2=sums[row+2],sum3=sums[row+3];
+                for(int fromNode=blockStart;fromNode<blockEnd;fromNode++)
+                {
+                    Type fromValue = fromValues[fromNode];
+                    sum0 += fromValue * weights0[fromNode];
+                    sum1 += fromValue * weights1[fromNode];
+                    sum2 += fromValue * weights2[fromNode];
+                    sum3 += fromValue * weights3[fromNode];
+                }
+                sums[row  ]=sum0;
+                sums[row+1]=sum1;
+                sums[row+2]=sum2;
+                sums[row+3]=sum3;
+            }
+            for(;row<numRows;row++)
+            {
+                const Type *weightsPtr = weights+row*rowStride;
+                Type sum=sums[row];
+                for(int fromNode=blockStart;fromNode<blockEnd;fromNode++)
+                {
+                    sum += fromValues[fromNode] * weightsPtr[fromNode];
+                }
+                sums[row]=sum;
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::propagateCompiled(int layerIndex,int a,bool useSimd)
+    {
+        NetworkLayer<Type> &layer = layers[layerIndex];
+        const NetworkLayer<Type> &fromLayer = layers[layer.fromLayers[a]];
+        const CompiledLayerWeights<Type> &compiled = compiledWeights[layerIndex][a];
+
+        int numToNodes = (int)layer.nodeValues.size();
+        int numFromNodes = (int)fromLayer.nodeValues.size();
+        const Type *fromNodesPtr = &(fromLayer.nodeValues[0]);
+        Type *sums = &pairSums[0];
+
+        if(compiled.sparse)
+        {
+            const int *fromNodes = compiled.weights.size() ? &compiled.fromNodes[0] : NULL;
+            const Type *weights = compiled.weights.size() ? &compiled.weights[0] : NULL;
+            if(useSimd && canUseRowSumsSimd())
+            {
+                compiledRowSumsSimd(fromNodesPtr,&compiled.rowStart[0],fromNodes,weights,sums,numToNodes);
+            }
+            else
+            {
+                compiledRowSums(fromNodesPtr,&compiled.rowStart[0],fromNodes,weights,sums,numToNodes);
+            }
+        }
+        else
+        {
+            //Splitting the dense rows over vector lanes was slower than
+            //summing four rows side by side, so both engines do the latter
+            denseRowSums(fromNodesPtr,numFromNodes,&(layer.fromWeights[a][0]),layer.nodeValues.size(),sums,numToNodes);
+        }
+
+        Type *toNodes = &(layer.nodeValues[0]);
+        for(int toNode=0;toNode<numToNodes;toNode++)
+        {
+            toNodes[toNode] += sums[toNode];
+        }
+    }
+
+    /**
+     *  inputColumnSums: sums[row] = the sum over the active source nodes, in
+     *  the order given, of the node's value times its weight to 'row'.
+     *  columns holds the weights of each source node together.
+     */
+    template<class Type>
+    inline void inputColumnSums(
+        const Type *fromValues,
+        const vector<int> &activeNodes,
+        const Type *columns,
+        Type *sums,
+        int numRows
+        )
+    {
+        for(int row=0;row<numRows;row++)
+        {
+            sums[row]=0;
+        }
+
+        for(int b=0;b<(int)activeNodes.size();b++)
+        {
+            int fromNode = activeNodes[b];
+            Type fromValue = fromValues[fromNode];
+            const Type *column = columns+size_t(fromNode)*numRows;
+            for(int row=0;row<numRows;row++)
+            {
+                sums[row] += fromValue * column[row];
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::propagateInputs(int layerIndex,int a,bool incremental)
+    {
+        NetworkLayer<Type> &layer = layers[layerIndex];
+        int fromLayerIndex = layer.fromLayers[a];
+        const Type *fromValues = &(layers[fromLayerIndex].nodeValues[0]);
+        CompiledLayerWeights<Type> &compiled = compiledWeights[layerIndex][a];
+
+        int numToNodes = (int)layer.nodeValues.size();
+        if(numToNodes==0)
+        {
+            return;
+        }
+
+        //Sort the active nodes, so the columns are added in the order the
+        //dense loop adds them, and drop repeats and nodes that are zero again
+        vector<int> &active = activeInputs[fromLayerIndex];
+        sort(active.begin(),active.end());
+        int numActive=0;
+        for(int b=0;b<(int)active.size();b++)
+        {
+            if(fromValues[active[b]]!=0 && (numActive==0 || active[numActive-1]!=active[b]))
+            {
+                active[numActive++] = active[b];
+            }
+        }
+        active.resize(numActive);
+
+        const Type *columns = compiled.columns.size() ? &compiled.columns[0] : NULL;
+        Type *sums;
+
+        if(!incremental)
+        {
+            sums = &pairSums[0];
+            inputColumnSums(fromValues,active,columns,sums,numToNodes);
+        }
+        else
+        {
+            sums = &compiled.inputSums[0];
+            Type *propagatedValues = &compiled.propagatedValues[0];
+
+            bool refresh = !compiled.inputSumsValid || compiled.updatesSinceRefresh>=LAYERED_NETWORK_INPUT_REFRESH;
+            if(!refresh)
+            {
+                //The inputs that were non-zero last time and have changed,
+                //then the ones that were zero and are set now
+                changedInputs.clear();
+                for(int b=0;b<(int)compiled.propagatedNodes.size();b++)
+                {
+                    int fromNode = compiled.propagatedNodes[b];
+                    if(fromValues[fromNode]!=propagatedValues[fromNode])
+                    {
+                        changedInputs.push_back(fromNode);
+                    }
+                }
+                for(int b=0;b<numActive;b++)
+                {
+                    if(propagatedValues[active[b]]==0)
+                    {
+                        changedInputs.push_back(active[b]);
+                    }
+                }
+
+                //Past this point the full sum reads no more columns
+                refresh = (changedInputs.size()>=active.size() && changedInputs.size()>0);
+            }
+
+            if(refresh)
+            {
+                inputColumnSums(fromValues,active,columns,sums,numToNodes);
+
+                for(int b=0;b<(int)compiled.propagatedNodes.size();b++)
+                {
+                    propagatedValues[compiled.propagatedNodes[b]]=0;
+                }
+                for(int b=0;b<numActive;b++)
+                {
+                    propagatedValues[active[b]] = fromValues[active[b]];
+                }
+                compiled.inputSumsValid = true;
+                compiled.updatesSinceRefresh = 0;
+            }
+            else
+            {
+                for(int b=0;b<(int)changedInputs.size();b++)
+                {
+                    int fromNode = changedInputs[b];
+                    Type delta = fromValues[fromNode]-propagatedValues[fromNode];
+                    const Type *column = columns+size_t(fromNode)*numToNodes;
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        sums[toNode] += delta * column[toNode];
+                    }
+                    propagatedValues[fromNode] = fromValues[fromNode];
+                }
+                compiled.updatesSinceRefresh++;
+            }
+
+            compiled.propagatedNodes = active;
+        }
+
+        Type *toNodes = &(layer.nodeValues[0]);
+        for(int toNode=0;toNode<numToNodes;toNode++)
+        {
+            toNodes[toNode] += sums[toNode];
+        }
+    }
+
     template<class Type>
     void FastLayeredNetwork<Type>::reinitialize()
     {
@@ -184,11 +572,28 @@ namespace NEAT
         {
             layers[a].initialize();
         }
+
+        for(size_t a=0;a<activeInputs.size();a++)
+        {
+            activeInputs[a].clear();
+        }
     }
 
     template<class Type>
     void FastLayeredNetwork<Type>::update()
     {
+        NEAT_PROFILE_SCOPE("networkUpdate");
+
+        LayeredNetworkEngine engine = Globals::getSingleton()->getLayeredNetworkEngine();
+        LayeredNetworkInputs inputs = Globals::getSingleton()->getLayeredNetworkInputs();
+        if(
+            (engine!=LAYERED_NETWORK_ENGINE_DENSE && !weightsCompiled) ||
+            (inputs!=LAYERED_NETWORK_INPUTS_DENSE && (!weightsCompiled || !inputColumnsCompiled))
+            )
+        {
+            compileWeights();
+        }
+
         for(typename vector<NetworkLayer<Type> >::iterator layer = layers.begin();layer != layers.end();layer++)
         {
             vector<Type> &toNodes = layer->nodeValues;
@@ -206,6 +611,26 @@ namespace NEAT
 
                 for(size_t a=0;a<layer->fromLayers.size();a++)
                 {
+                    if(inputs!=LAYERED_NETWORK_INPUTS_DENSE && layers[layer->fromLayers[a]].fromLayers.empty())
+                    {
+                        propagateInputs(
+                            int(layer-layers.begin()),
+                            int(a),
+                            inputs==LAYERED_NETWORK_INPUTS_INCREMENTAL
+                            );
+                        continue;
+                    }
+
+                    if(engine!=LAYERED_NETWORK_ENGINE_DENSE)
+                    {
+                        propagateCompiled(
+                            int(layer-layers.begin()),
+                            int(a),
+                            engine==LAYERED_NETWORK_ENGINE_ADAPTIVE_SIMD
+                            );
+                        continue;
+                    }
+
                     const NetworkLayer<Type> &fromLayer = layers[layer->fromLayers[a]];
 
                     const vector<Type> &fromNodes = fromLayer.nodeValues;
@@ -8,9 +8,13 @@
 
 #include "NEAT_Globals.h"
 
+#include "NEAT_Profiler.h"
+
 #include "NEAT_GeneticLinkGene.h"
 #include "NEAT_GeneticNodeGene.h"
 
+#include "NEAT_RowSums.h"
+
 #define DEBUG_ACTIVATION_CALCULATION (0)
 
 #define DEBUG_NETWORK_CREATION (0)
@@ -27,7 +31,11 @@ namespace NEAT
         :
     Network<Type>(),
         numNodes(int(_nodes.size())),
-        numLinks(int(_links.size()))
+        numLinks(int(_links.size())),
+        csrWeightsDirty(true),
+        tapeDepth(0),
+        tapeBuilt(false),
+        tapeWeightsDirty(true)
     {
         data = (char*)malloc(
             sizeof(Type)*2*numNodes +
@@ -111,7 +119,11 @@ namespace NEAT
         :
     Network<Type>(),
         numNodes(_numNodes),
-        numLinks(_numLinks)
+        numLinks(_numLinks),
+        csrWeightsDirty(true),
+        tapeDepth(0),
+        tapeBuilt(false),
+        tapeWeightsDirty(true)
     {
         data = (char*)malloc(
             sizeof(Type)*2*numNodes +
@@ -198,7 +210,11 @@ namespace NEAT
         :
     Network<Type>(),
         numNodes(int(_nodes.size())),
-        numLinks(int(_links.size()))
+        numLinks(int(_links.size())),
+        csrWeightsDirty(true),
+        tapeDepth(0),
+        tapeBuilt(false),
+        tapeWeightsDirty(true)
     {
         data = (char*)malloc(
             sizeof(Type)*2*numNodes +
@@ -287,7 +303,11 @@ namespace NEAT
     Network<Type>(),
         numNodes(0),
         numLinks(0),
-        data(NULL)
+        data(NULL),
+        csrWeightsDirty(true),
+        tapeDepth(0),
+        tapeBuilt(false),
+        tapeWeightsDirty(true)
     {
 	}
 
@@ -326,6 +346,24 @@ namespace NEAT
             numConstantNodes = other.numConstantNodes;
             nodeLinkMap = other.nodeLinkMap;
 
+            csrRowStart = other.csrRowStart;
+            csrRowNode = other.csrRowNode;
+            csrBucketStart = other.csrBucketStart;
+            csrFromNode = other.csrFromNode;
+            csrLinkIndex = other.csrLinkIndex;
+            csrWeights = other.csrWeights;
+            csrRowValues = other.csrRowValues;
+            csrWeightsDirty = other.csrWeightsDirty;
+
+            tapeNode = other.tapeNode;
+            tapeLinkStart = other.tapeLinkStart;
+            tapeFromNode = other.tapeFromNode;
+            tapeLinkIndex = other.tapeLinkIndex;
+            tapeWeights = other.tapeWeights;
+            tapeDepth = other.tapeDepth;
+            tapeBuilt = other.tapeBuilt;
+            tapeWeightsDirty = other.tapeWeightsDirty;
+
             data = (char*)realloc(
                 data,
                 sizeof(Type)*2*numNodes +
@@ -387,14 +425,15 @@ namespace NEAT
     template<class Type>
     Type FastNetwork<Type>::getValue(const string &nodeName)
     {
-        if (!nodeNameToIndex.count(nodeName))
+        map<string,int>::iterator it = nodeNameToIndex.find(nodeName);
+        if (it==nodeNameToIndex.end())
         {
             cout << "ERROR: Could not find node named " << nodeName << endl;
             throw (string("ERROR: Could not find node named ") + string(nodeName) + string("\n"));
         }
         else
         {
-            return nodeValues[nodeNameToIndex[nodeName]];
+            return nodeValues[it->second];
         }
     }
 
@@ -418,9 +457,24 @@ namespace NEAT
         }
     }
 
+    template<class Type>
+    int FastNetwork<Type>::getNodeIndex(const string &nodeName)
+    {
+        map<string,int>::iterator it = nodeNameToIndex.find(nodeName);
+        if(it==nodeNameToIndex.end())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO( (string("ERROR: Could not find node named ") + string(nodeName) + string("\n")) );
+        }
+
+        return it->second;
+    }
+
     template<class Type>
     NetworkIndexedLink<Type> *FastNetwork<Type>::getLink(const string &fromNodeName,const string &toNodeName)
     {
+        csrWeightsDirty=true;
+        tapeWeightsDirty=true;
+
         int fromNodeIndex = nodeNameToIndex[fromNodeName];
         int toNodeIndex = nodeNameToIndex[toNodeName];
 
@@ -479,6 +533,8 @@ namespace NEAT
     template<class Type>
     void FastNetwork<Type>::updateFixedIterations(int iterations)
     {
+        NEAT_PROFILE_SCOPE("networkUpdate");
+
         int count=iterations;
         if (!this->activated)
         {
@@ -494,6 +550,28 @@ namespace NEAT
             //throw CREATE_LOCATEDEXCEPTION_INFO("THE NETWORK HAS BEEN UPDATED WHILE ALREADY ACTIVE!");
         }
 
+        FastNetworkEngine engine = Globals::getSingleton()->getFastNetworkEngine();
+        if (engine==FAST_NETWORK_ENGINE_TAPE)
+        {
+            //A single update is one pass either way, and the CSR rows are
+            //summed interleaved.  The tape pays off when it replaces several.
+            if (count>1 && canUseTape(count))
+            {
+                updateTape();
+            }
+            else
+            {
+                //Recurrent, or the deepest node wouldn't settle in (count) updates
+                updateCompiled(count,false);
+            }
+            return;
+        }
+        if (engine!=FAST_NETWORK_ENGINE_LINKS)
+        {
+            updateCompiled(count,engine==FAST_NETWORK_ENGINE_CSR_SIMD);
+            return;
+        }
+
         for (int a=0;a<count;a++)
         {
             /*for (int a=0;a<nodes.size();a++)
@@ -578,6 +656,379 @@ namespace NEAT
         }
     }
 
+    template<class Type>
+    void FastNetwork<Type>::buildCompiledLinks()
+    {
+        int numRows = numNodes-numConstantNodes;
+
+        //Counting sort of the updated nodes by activation function
+        csrBucketStart.assign(ACTIVATION_FUNCTION_END+1,0);
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            csrBucketStart[activationFunctions[a]+1]++;
+        }
+        for (int a=0;a<ACTIVATION_FUNCTION_END;a++)
+        {
+            csrBucketStart[a+1] += csrBucketStart[a];
+        }
+
+        vector<int> nodeToRow(numNodes,-1);
+        vector<int> bucketFill(csrBucketStart.begin(),csrBucketStart.end()-1);
+        csrRowNode.resize(numRows);
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            int row = bucketFill[activationFunctions[a]]++;
+            csrRowNode[row] = a;
+            nodeToRow[a] = row;
+        }
+
+        //Counting sort of the links by target row.  This is stable, so every
+        //row keeps its links in link list order.  Links into constant nodes
+        //never change anything and are dropped.
+        csrRowStart.assign(numRows+1,0);
+        for (int a=0;a<numLinks;a++)
+        {
+            int row = nodeToRow[links[a].toNode];
+            if (row>=0)
+            {
+                csrRowStart[row+1]++;
+            }
+        }
+        for (int a=0;a<numRows;a++)
+        {
+            csrRowStart[a+1] += csrRowStart[a];
+        }
+
+        int numCompiledLinks = csrRowStart[numRows];
+        vector<int> rowFill(csrRowStart.begin(),csrRowStart.end()-1);
+        csrFromNode.resize(numCompiledLinks);
+        csrLinkIndex.resize(numCompiledLinks);
+        csrWeights.resize(numCompiledLinks);
+        for (int a=0;a<numLinks;a++)
+        {
+            int row = nodeToRow[links[a].toNode];
+            if (row>=0)
+            {
+                int position = rowFill[row]++;
+                csrFromNode[position] = links[a].fromNode;
+                csrLinkIndex[position] = a;
+            }
+        }
+
+        csrRowValues.resize(numRows);
+        csrWeightsDirty=true;
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::updateCompiled(int count,bool useSimd)
+    {
+        if (csrRowStart.empty())
+        {
+            buildCompiledLinks();
+        }
+
+        int numRows = numNodes-numConstantNodes;
+        int numCompiledLinks = int(csrWeights.size());
+
+        if (csrWeightsDirty)
+        {
+            for (int a=0;a<numCompiledLinks;a++)
+            {
+                csrWeights[a] = links[csrLinkIndex[a]].weight;
+            }
+            csrWeightsDirty=false;
+        }
+
+        if (numRows==0)
+        {
+            return;
+        }
+
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+
+        const int *rowStart = &csrRowStart[0];
+        const int *rowNode = &csrRowNode[0];
+        const int *fromNodes = numCompiledLinks ? &csrFromNode[0] : NULL;
+        const Type *weights = numCompiledLinks ? &csrWeights[0] : NULL;
+        Type *rowValues = &csrRowValues[0];
+
+        for (int iteration=0;iteration<count;iteration++)
+        {
+            if (useSimd && canUseRowSumsSimd())
+            {
+                compiledRowSumsSimd(nodeValues,rowStart,fromNodes,weights,rowValues,numRows);
+            }
+            else
+            {
+                compiledRowSums(nodeValues,rowStart,fromNodes,weights,rowValues,numRows);
+            }
+
+            for (int function=0;function<ACTIVATION_FUNCTION_END;function++)
+            {
+                for (int row=csrBucketStart[function];row<csrBucketStart[function+1];row++)
+                {
+                    rowValues[row] = runActivationFunction(
+                        rowValues[row],
+                        ActivationFunction(function),
+                        signedActivation,
+                        usingTanhSigmoid
+                        );
+                }
+            }
+
+            //Every sum has been taken, so the new values can go straight back
+            for (int row=0;row<numRows;row++)
+            {
+                nodeValues[rowNode[row]] = rowValues[row];
+            }
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::buildTape()
+    {
+        tapeBuilt=true;
+        tapeNode.clear();
+        tapeLinkStart.clear();
+        tapeFromNode.clear();
+        tapeLinkIndex.clear();
+        tapeWeightsDirty=true;
+
+        //Incoming links of every node in link list order, and the number of
+        //them that come from updated nodes (constant nodes are always ready)
+        vector<int> incomingStart(numNodes+1,0);
+        vector<int> waitingFor(numNodes,0);
+        vector<vector<int> > dependents(numNodes);
+        for (int a=0;a<numLinks;a++)
+        {
+            if (links[a].toNode<numConstantNodes)
+            {
+                continue;
+            }
+            incomingStart[links[a].toNode+1]++;
+            if (links[a].fromNode>=numConstantNodes)
+            {
+                waitingFor[links[a].toNode]++;
+                dependents[links[a].fromNode].push_back(links[a].toNode);
+            }
+        }
+        for (int a=0;a<numNodes;a++)
+        {
+            incomingStart[a+1] += incomingStart[a];
+        }
+        vector<int> incomingLinks(incomingStart[numNodes]);
+        vector<int> incomingFill(incomingStart.begin(),incomingStart.end()-1);
+        for (int a=0;a<numLinks;a++)
+        {
+            if (links[a].toNode>=numConstantNodes)
+            {
+                incomingLinks[incomingFill[links[a].toNode]++] = a;
+            }
+        }
+
+        //Kahn's algorithm.  Every node is scheduled after all of its inputs.
+        vector<int> depth(numNodes,0);
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            if (waitingFor[a]==0)
+            {
+                tapeNode.push_back(a);
+                depth[a]=1;
+            }
+        }
+        tapeDepth = numNodes>numConstantNodes ? 1 : 0;
+        for (int position=0;position<(int)tapeNode.size();position++)
+        {
+            int node = tapeNode[position];
+            for (int a=0;a<(int)dependents[node].size();a++)
+            {
+                int dependent = dependents[node][a];
+                depth[dependent] = max(depth[dependent],depth[node]+1);
+                tapeDepth = max(tapeDepth,depth[dependent]);
+                if (--waitingFor[dependent]==0)
+                {
+                    tapeNode.push_back(dependent);
+                }
+            }
+        }
+
+        if ((int)tapeNode.size()<numNodes-numConstantNodes)
+        {
+            //Some nodes are on a cycle
+            tapeNode.clear();
+            tapeDepth=-1;
+            return;
+        }
+
+        for (int position=0;position<(int)tapeNode.size();position++)
+        {
+            int node = tapeNode[position];
+            tapeLinkStart.push_back(int(tapeFromNode.size()));
+            for (int a=incomingStart[node];a<incomingStart[node+1];a++)
+            {
+                tapeFromNode.push_back(links[incomingLinks[a]].fromNode);
+                tapeLinkIndex.push_back(incomingLinks[a]);
+            }
+        }
+        tapeLinkStart.push_back(int(tapeFromNode.size()));
+        tapeWeights.resize(tapeFromNode.size());
+    }
+
+    template<class Type>
+    bool FastNetwork<Type>::canUseTape(int count)
+    {
+        if (!tapeBuilt)
+        {
+            buildTape();
+        }
+
+        //Each update moves values one node further, so after (tapeDepth)
+        //updates every node holds its settled value and further updates
+        //recompute the same sums.  With fewer the result is still in transit.
+        return tapeDepth>=0 && count>=tapeDepth;
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::refreshTapeWeights()
+    {
+        if (tapeWeightsDirty)
+        {
+            for (int a=0;a<(int)tapeWeights.size();a++)
+            {
+                tapeWeights[a] = links[tapeLinkIndex[a]].weight;
+            }
+            tapeWeightsDirty=false;
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::updateTape()
+    {
+        refreshTapeWeights();
+
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+
+        int numInstructions = int(tapeNode.size());
+        const int *linkStart = numInstructions ? &tapeLinkStart[0] : NULL;
+        const int *fromNodes = tapeFromNode.empty() ? NULL : &tapeFromNode[0];
+        const Type *weights = tapeWeights.empty() ? NULL : &tapeWeights[0];
+
+        for (int instruction=0;instruction<numInstructions;instruction++)
+        {
+            //Same additions in the same order as the link list update, so the
+            //value is bit for bit the settled value of FAST_NETWORK_ENGINE_LINKS
+            Type sum = 0;
+            for (int a=linkStart[instruction];a<linkStart[instruction+1];a++)
+            {
+                sum += nodeValues[fromNodes[a]]*weights[a];
+            }
+
+            int node = tapeNode[instruction];
+            nodeValues[node] = runActivationFunction(sum,activationFunctions[node],signedActivation,usingTanhSigmoid);
+        }
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::updateBatch(Type *batchValues,int batchSize)
+    {
+        //Same count as the first update() after reinitialize()
+        updateBatchFixedIterations(
+            batchValues,
+            batchSize,
+            1 + Globals::getSingleton()->getExtraActivationUpdates()
+            );
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::updateBatchFixedIterations(Type *batchValues,int batchSize,int iterations)
+    {
+        if (numNodes==0 || batchSize<=0 || iterations<=0)
+        {
+            return;
+        }
+
+        int count = iterations;
+
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+
+        if (Globals::getSingleton()->getFastNetworkEngine()==FAST_NETWORK_ENGINE_TAPE && canUseTape(count))
+        {
+            refreshTapeWeights();
+
+            //One pass in topological order.  A node never feeds itself, so its
+            //row is summed in place.
+            for (int instruction=0;instruction<(int)tapeNode.size();instruction++)
+            {
+                int node = tapeNode[instruction];
+                Type *values = batchValues + size_t(node)*batchSize;
+                memset(values,0,sizeof(Type)*batchSize);
+
+                for (int a=tapeLinkStart[instruction];a<tapeLinkStart[instruction+1];a++)
+                {
+                    const Type weight = tapeWeights[a];
+                    const Type *fromValues = batchValues + size_t(tapeFromNode[a])*batchSize;
+
+                    for (int b=0;b<batchSize;b++)
+                    {
+                        values[b] += fromValues[b]*weight;
+                    }
+                }
+
+                ActivationFunction function = activationFunctions[node];
+                for (int b=0;b<batchSize;b++)
+                {
+                    values[b] = runActivationFunction(values[b],function,signedActivation,usingTanhSigmoid);
+                }
+            }
+            return;
+        }
+
+        batchNewValues.resize(size_t(numNodes)*batchSize);
+        Type *newValues = &batchNewValues[0];
+
+        for (int iteration=0;iteration<count;iteration++)
+        {
+            memset(newValues,0,sizeof(Type)*numNodes*batchSize);
+
+            //Links are visited in the same order as updateFixedIterations so
+            //every pattern accumulates its sums in the same order.  The inner
+            //loop runs over contiguous patterns and vectorizes.
+            for (int a=0;a<numLinks;a++)
+            {
+                const Type weight = links[a].weight;
+                const Type *fromValues = batchValues + size_t(links[a].fromNode)*batchSize;
+                Type *toValues = newValues + size_t(links[a].toNode)*batchSize;
+
+                for (int b=0;b<batchSize;b++)
+                {
+                    toValues[b] += fromValues[b]*weight;
+                }
+            }
+
+            //The activation function is fixed per node, so the switch is taken
+            //once per node instead of once per node per pattern
+            for (int a=numConstantNodes;a<numNodes;a++)
+            {
+                Type *values = newValues + size_t(a)*batchSize;
+                ActivationFunction function = activationFunctions[a];
+
+                for (int b=0;b<batchSize;b++)
+                {
+                    values[b] = runActivationFunction(values[b],function,signedActivation,usingTanhSigmoid);
+                }
+            }
+
+            memcpy(
+                batchValues+size_t(numConstantNodes)*batchSize,
+                newValues+size_t(numConstantNodes)*batchSize,
+                sizeof(Type)*(numNodes-numConstantNodes)*batchSize
+                );
+        }
+    }
+
     template<class Type>
     void FastNetwork<Type>::print()
     {
@@ -599,6 +1050,8 @@ namespace NEAT
         {
             links[a].weight = (Type)0.0;
         }
+        csrWeightsDirty=true;
+        tapeWeightsDirty=true;
     }
 
     const float LEARNING_RATE = (0.5f);//(0.5f);
@@ -606,6 +1059,9 @@ namespace NEAT
     template<class Type>
     void FastNetwork<Type>::backProp(const vector<string> &nodeNames,const vector<Type> &correctedValues,bool perceptron)
     {
+        csrWeightsDirty=true;
+        tapeWeightsDirty=true;
+
         set<int> fromNodes;
 
         map<int,double> linkErrorTerms;
@@ -28,6 +28,13 @@ namespace NEAT
 #endif
     }
 
+    GeneticGene::GeneticGene(BinaryReader &reader)
+    {
+        ID = reader.read<int>();
+        enabled = reader.readBool();
+        age = reader.read<int>();
+    }
+
     GeneticGene::~GeneticGene()
     {}
 
@@ -50,4 +57,11 @@ namespace NEAT
     {
         ostr << ID << ' ' << enabled << ' ';
     }
+
+    void GeneticGene::dump(BinaryWriter &writer)
+    {
+        writer.write<int>(ID);
+        writer.writeBool(enabled);
+        writer.write<int>(age);
+    }
 }
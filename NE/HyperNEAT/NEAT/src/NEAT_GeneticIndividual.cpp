@@ -31,13 +31,13 @@ namespace NEAT
     {
         bool allowRecurrentConnections
             = (
-            Globals::getSingleton()->getParameterValue("AllowRecurrentConnections")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_RECURRENT_CONNECTIONS)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
         bool allowSelfRecurrentConnections
             = (
-            Globals::getSingleton()->getParameterValue("AllowSelfRecurrentConnections")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_SELF_RECURRENT_CONNECTIONS)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
@@ -108,13 +108,13 @@ namespace NEAT
 
         bool allowRecurrentConnections
             = (
-            Globals::getSingleton()->getParameterValue("AllowRecurrentConnections")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_RECURRENT_CONNECTIONS)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
         bool allowSelfRecurrentConnections
             = (
-            Globals::getSingleton()->getParameterValue("AllowSelfRecurrentConnections")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_SELF_RECURRENT_CONNECTIONS)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
@@ -276,6 +276,30 @@ namespace NEAT
 		isValid();
     }
 
+    GeneticIndividual::GeneticIndividual(BinaryReader &reader)
+        :
+    canReproduce(true)
+    {
+        fitness = reader.read<double>();
+        speciesID = reader.read<int>();
+        userData = reader.readString();
+
+        //The genes were written in ID order, so they can be appended as they are
+        int numNodes = reader.read<int>();
+        nodes.reserve(numNodes);
+        for (int a=0;a<numNodes;a++)
+        {
+            nodes.push_back(GeneticNodeGene(reader));
+        }
+
+        int numLinks = reader.read<int>();
+        links.reserve(numLinks);
+        for (int a=0;a<numLinks;a++)
+        {
+            links.push_back(GeneticLinkGene(reader));
+        }
+    }
+
     GeneticIndividual::GeneticIndividual(shared_ptr<GeneticIndividual> parent1,shared_ptr<GeneticIndividual> parent2,bool mate_multipoint_avg, double minFitness)
         :
     fitness(0),
@@ -511,15 +535,15 @@ namespace NEAT
 #if DEBUG_MUTATE
         cout << "Mutating...";
 #endif
-        double addNodeProb = Globals::getSingleton()->getParameterValue("MutateAddNodeProbability");
-        double addLinkProb = Globals::getSingleton()->getParameterValue("MutateAddLinkProbability");
-        double mutateLinkWeightsProb = Globals::getSingleton()->getParameterValue("MutateLinkWeightsProbability");
-        double mutateLinkProb = Globals::getSingleton()->getParameterValue("MutateLinkProbability");
-        double mutateDemolishLinkProb = Globals::getSingleton()->getParameterValue("MutateDemolishLinkProbability");
+        double addNodeProb = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_ADD_NODE_PROBABILITY);
+        double addLinkProb = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_ADD_LINK_PROBABILITY);
+        double mutateLinkWeightsProb = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_LINK_WEIGHTS_PROBABILITY);
+        double mutateLinkProb = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_LINK_PROBABILITY);
+        double mutateDemolishLinkProb = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_DEMOLISH_LINK_PROBABILITY);
 
         bool finished=false;
 
-        int adultLinkAge = int(Globals::getSingleton()->getParameterValue("AdultLinkAge"));
+        int adultLinkAge = int(Globals::getSingleton()->getParameterValue(PARAMETER_ADULT_LINK_AGE));
 
         if (Globals::getSingleton()->getRandom().getRandomDouble()<addNodeProb)
         {
@@ -688,6 +712,42 @@ namespace NEAT
         links.push_back(link);
     }
 
+    namespace
+    {
+        int committedID(int ID,const vector<int> &IDs)
+        {
+            return InnovationLog::isProvisional(ID) ? IDs[ID-InnovationLog::FIRST_PROVISIONAL_ID] : ID;
+        }
+
+        bool linkIDLess(const GeneticLinkGene &link1,const GeneticLinkGene &link2)
+        {
+            return link1.getID()<link2.getID();
+        }
+    }
+
+    void GeneticIndividual::commitInnovations(const vector<int> &nodeIDs,const vector<int> &linkIDs)
+    {
+        //New nodes get IDs above every existing one, in the order they were
+        //made, so the nodes stay sorted
+        for (int a=0;a<(int)nodes.size();a++)
+        {
+            nodes[a].setID(committedID(nodes[a].getID(),nodeIDs));
+        }
+
+        //A new link may get the ID of a link made earlier this generation, so
+        //the links have to be sorted again
+        for (int a=0;a<(int)links.size();a++)
+        {
+            links[a].updateLegacy(
+                committedID(links[a].getFromNodeID(),nodeIDs),
+                committedID(links[a].getToNodeID(),nodeIDs)
+            );
+            links[a].setID(committedID(links[a].getID(),linkIDs));
+        }
+
+        stable_sort(links.begin(),links.end(),linkIDLess);
+    }
+
     int GeneticIndividual::getLinksCount() const
     {
         return (int)links.size();
@@ -797,6 +857,25 @@ namespace NEAT
         }
     }
 
+    void GeneticIndividual::dump(BinaryWriter &writer)
+    {
+        writer.write<double>(fitness);
+        writer.write<int>(speciesID);
+        writer.writeString(userData);
+
+        writer.write<int>(int(nodes.size()));
+        for (int a=0;a<(int)nodes.size();a++)
+        {
+            nodes[a].dump(writer);
+        }
+
+        writer.write<int>(int(links.size()));
+        for (int a=0;a<(int)links.size();a++)
+        {
+            links[a].dump(writer);
+        }
+    }
+
     void GeneticIndividual::print() const
     {
         cout << "NEW INDIVIDUAL:\n";
@@ -807,7 +886,54 @@ namespace NEAT
         cout << endl;
     }
 
-    double GeneticIndividual::getCompatibility(shared_ptr<GeneticIndividual> other)
+    namespace
+    {
+        unsigned long long hashString(const string &value)
+        {
+            //FNV-1a
+            unsigned long long hash = 0xCBF29CE484222325ULL;
+            for (int a=0;a<(int)value.length();a++)
+            {
+                hash = (hash ^ (unsigned char)value[a]) * 0x100000001B3ULL;
+            }
+            return hash;
+        }
+    }
+
+    unsigned long long GeneticIndividual::getGenomeHash() const
+    {
+        //Every gene is hashed on its own and the gene hashes are added, which
+        //makes the result independent of the gene order
+        unsigned long long nodeSum=0;
+        for (int a=0;a<(int)nodes.size();a++)
+        {
+            unsigned long long hash = Random::mixBits((unsigned int)nodes[a].getID());
+            hash = Random::mixBits(hash ^ hashString(nodes[a].getName()));
+            hash = Random::mixBits(hash ^ hashString(nodes[a].getType()));
+            hash = Random::mixBits(hash ^ (unsigned int)nodes[a].getActivationFunction());
+            nodeSum += hash;
+        }
+
+        unsigned long long linkSum=0;
+        for (int a=0;a<(int)links.size();a++)
+        {
+            double weight = links[a].getWeight();
+            unsigned long long weightBits;
+            memcpy(&weightBits,&weight,sizeof(weightBits));
+
+            unsigned long long hash = Random::mixBits((unsigned int)links[a].getID());
+            hash = Random::mixBits(hash ^ (unsigned int)links[a].getFromNodeID());
+            hash = Random::mixBits(hash ^ (unsigned int)links[a].getToNodeID());
+            hash = Random::mixBits(hash ^ weightBits);
+            hash = Random::mixBits(hash ^ (links[a].isEnabled()?1ULL:0ULL));
+            linkSum += hash;
+        }
+
+        unsigned long long hash = Random::mixBits(nodeSum ^ (unsigned long long)nodes.size());
+        return Random::mixBits(hash ^ linkSum ^ ((unsigned long long)links.size()<<32));
+    }
+
+    double GeneticIndividual::getCompatibility(shared_ptr<GeneticIndividual> other,double bound)
     {
         GeneticIndividual *ind1 = this;
         GeneticIndividual *ind2 = other.get();
@@ -820,6 +946,30 @@ namespace NEAT
 
         double weightDiffTotal=0;
 
+        double disjointCoeff = Globals::getSingleton()->getParameterValue(PARAMETER_DISJOINT_COEFFICIENT);
+        double excessCoeff = Globals::getSingleton()->getParameterValue(PARAMETER_EXCESS_COEFFICIENT);
+        double weightDiffCoeff = Globals::getSingleton()->getParameterValue(PARAMETER_WEIGHT_DIFFERENCE_COEFFICIENT);
+        double fitnessCoeff = Globals::getSingleton()->getParameterValue(PARAMETER_FITNESS_COEFFICIENT);
+        //This is a hack that sets N to 1.  If N is small enough, 1 works.
+        maxIndividualSize=1;
+        double normalizedFitnessDifference;
+        normalizedFitnessDifference = (fitness/other->fitness);
+        if (normalizedFitnessDifference<1.0)
+        {
+            normalizedFitnessDifference = 1.0/normalizedFitnessDifference;
+        }
+
+        //Every term is non-negative when the coefficients are, so the
+        //disjoint, excess and fitness terms alone bound the result from
+        //below.  They are added in the same order as the final sum, so
+        //rounding cannot push the final sum below the bound.
+        bool canExitEarly =
+            bound<DBL_MAX &&
+            disjointCoeff>=0.0 &&
+            excessCoeff>=0.0 &&
+            weightDiffCoeff>=0.0 &&
+            fitnessCoeff>=0.0;
+
         int link1index = 0,link2index=0;
 
         while (link1index<ind1->getLinksCount()&&link2index<ind2->getLinksCount())
@@ -829,42 +979,43 @@ namespace NEAT
             link1 = ind1->getLink(link1index);
             link2 = ind2->getLink(link2index);
 
-            if (link2->getID()<link1->getID())
+            if (link1->getID()==link2->getID())
             {
-                numDisjoint++;
+                weightDiffTotal += fabs(link1->getWeight()-link2->getWeight());
+                numMatching++;
+                link1index++;
                 link2index++;
+                continue;
             }
-            else if (link1->getID()<link2->getID())
+
+            if (link2->getID()<link1->getID())
             {
-                numDisjoint++;
-                link1index++;
+                link2index++;
             }
-            else //both links have the same ID
+            else
             {
-                weightDiffTotal += fabs(link1->getWeight()-link2->getWeight());
-                numMatching++;
                 link1index++;
-                link2index++;
             }
+            numDisjoint++;
 
+            if (canExitEarly)
+            {
+                double lowerBound = (
+                    disjointCoeff*(numDisjoint/double(maxIndividualSize))+
+                    excessCoeff*(numExcess/double(maxIndividualSize))
+                    )+
+                    fitnessCoeff*(normalizedFitnessDifference);
+                if (lowerBound>=bound)
+                {
+                    return lowerBound;
+                }
+            }
         }
 
         //Return the compatibility number using compatibility formula
         //Note that mut_diff_total/num_matching gives the AVERAGE
         //difference between mutation_nums for any two matching Genes
         //in the Genome
-        double disjointCoeff = Globals::getSingleton()->getParameterValue("DisjointCoefficient");
-        double excessCoeff = Globals::getSingleton()->getParameterValue("ExcessCoefficient");
-        double weightDiffCoeff = Globals::getSingleton()->getParameterValue("WeightDifferenceCoefficient");
-        double fitnessCoeff = Globals::getSingleton()->getParameterValue("FitnessCoefficient");
-        //This is a hack that sets N to 1.  If N is small enough, 1 works.
-        maxIndividualSize=1;
-        double normalizedFitnessDifference;
-        normalizedFitnessDifference = (fitness/other->fitness);
-        if (normalizedFitnessDifference<1.0)
-        {
-            normalizedFitnessDifference = 1.0/normalizedFitnessDifference;
-        }
         //Normalizing for genome size
         double difference = (
             disjointCoeff*(numDisjoint/double(maxIndividualSize))+
@@ -889,13 +1040,13 @@ namespace NEAT
 
         bool allowRecurrentConnections
             = (
-            Globals::getSingleton()->getParameterValue("AllowRecurrentConnections")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_RECURRENT_CONNECTIONS)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
         bool allowSelfRecurrentConnections
             = (
-            Globals::getSingleton()->getParameterValue("AllowSelfRecurrentConnections")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_SELF_RECURRENT_CONNECTIONS)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
@@ -954,7 +1105,7 @@ namespace NEAT
 
         bool allowAddNodeToRecurrentConnection
             = (
-            Globals::getSingleton()->getParameterValue("AllowAddNodeToRecurrentConnection")>
+            Globals::getSingleton()->getParameterValue(PARAMETER_ALLOW_ADD_NODE_TO_RECURRENT_CONNECTION)>
             Globals::getSingleton()->getRandom().getRandomDouble()
             );
 
@@ -1051,7 +1202,7 @@ namespace NEAT
 
             bool randomActivation=false;
 
-            if (Globals::getSingleton()->getParameterValue("ExtraActivationFunctions")>Globals::getSingleton()->getRandom().getRandomDouble())
+            if (Globals::getSingleton()->getParameterValue(PARAMETER_EXTRA_ACTIVATION_FUNCTIONS)>Globals::getSingleton()->getRandom().getRandomDouble())
                 randomActivation=true;
 
             GeneticNodeGene newNode = GeneticNodeGene("","HiddenNode",newPosition,randomActivation);
@@ -1062,7 +1213,7 @@ namespace NEAT
             addNode(newNode);
             addLink(sourceLink);
             addLink(destLink);
-            if (Globals::getSingleton()->getParameterValue("AddBiasToHiddenNodes")>Globals::getSingleton()->getRandom().getRandomDouble())
+            if (Globals::getSingleton()->getParameterValue(PARAMETER_ADD_BIAS_TO_HIDDEN_NODES)>Globals::getSingleton()->getRandom().getRandomDouble())
             {
                 int biasNodeID=-1;
                 for (int a=0;a<(int)nodes.size();a++)
@@ -1121,7 +1272,7 @@ namespace NEAT
         }
 
         double linkGeneMinimumWeightForPhentoype =
-            Globals::getSingleton()->getParameterValue("LinkGeneMinimumWeightForPhentoype");
+            Globals::getSingleton()->getParameterValue(PARAMETER_LINK_GENE_MINIMUM_WEIGHT_FOR_PHENTOYPE);
 
         vector<NetworkLink *> networkLinks;
         for (int a=0;a<(int)links.size();a++)
@@ -1215,7 +1366,7 @@ namespace NEAT
         }
 
         double linkGeneMinimumWeightForPhentoype =
-            Globals::getSingleton()->getParameterValue("LinkGeneMinimumWeightForPhentoype");
+            Globals::getSingleton()->getParameterValue(PARAMETER_LINK_GENE_MINIMUM_WEIGHT_FOR_PHENTOYPE);
 
         vector<NetworkLink *> networkLinks;
         for (int a=0;a<(int)links.size();a++)
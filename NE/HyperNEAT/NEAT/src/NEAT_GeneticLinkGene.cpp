@@ -70,6 +70,16 @@ namespace NEAT
         istr >> fromNodeID >> toNodeID >> fixed >> setprecision(15) >> weight;
     }
 
+    GeneticLinkGene::GeneticLinkGene(BinaryReader &reader)
+            :
+            GeneticGene(reader)
+    {
+        fromNodeID = reader.read<int>();
+        toNodeID = reader.read<int>();
+        fixed = reader.readBool();
+        weight = reader.read<double>();
+    }
+
     GeneticLinkGene::~GeneticLinkGene()
     {}
 
@@ -92,7 +102,7 @@ namespace NEAT
         {
             int mod=1;
             //mod = max(20-age,2)/2;
-            double mutationPower = mod*Globals::getSingleton()->getParameterValue("MutationPower");
+            double mutationPower = mod*Globals::getSingleton()->getParameterValue(PARAMETER_MUTATION_POWER);
             weight += mutationPower*(2.0*(Globals::getSingleton()->getRandom().getRandomDouble()-0.5));
 
             if (weight>5)
@@ -117,4 +127,14 @@ namespace NEAT
 
         ostr << fromNodeID << ' ' << toNodeID << ' ' << fixed << ' ' << setprecision(15) << weight << ' ';
     }
+
+    void GeneticLinkGene::dump(BinaryWriter &writer)
+    {
+        GeneticGene::dump(writer);
+
+        writer.write<int>(fromNodeID);
+        writer.write<int>(toNodeID);
+        writer.writeBool(fixed);
+        writer.write<double>(weight);
+    }
 }
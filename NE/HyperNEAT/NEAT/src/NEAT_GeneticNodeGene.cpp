@@ -25,7 +25,7 @@ namespace NEAT
     {
         if (randomizeActivation)
         {
-            if (Globals::getSingleton()->getParameterValue("OnlyGaussianHiddenNodes")>0.5)
+            if (Globals::getSingleton()->getParameterValue(PARAMETER_ONLY_GAUSSIAN_HIDDEN_NODES)>0.5)
             {
 				activationFunction = ACTIVATION_FUNCTION_GAUSSIAN;
             }
@@ -68,7 +68,7 @@ namespace NEAT
     {
         if (randomizeActivation)
         {
-            if (Globals::getSingleton()->getParameterValue("OnlyGaussianHiddenNodes")>0.5)
+            if (Globals::getSingleton()->getParameterValue(PARAMETER_ONLY_GAUSSIAN_HIDDEN_NODES)>0.5)
             {
                 do
                 {
@@ -158,6 +158,17 @@ namespace NEAT
 #endif
     }
 
+    GeneticNodeGene::GeneticNodeGene(BinaryReader &reader)
+            :
+            GeneticGene(reader)
+    {
+        name = reader.readString();
+        type = reader.readString();
+        drawingPosition = reader.read<double>();
+        topologyFrozen = reader.readBool();
+        activationFunction = (ActivationFunction)reader.read<int>();
+    }
+
     GeneticNodeGene::~GeneticNodeGene()
     {}
 
@@ -203,6 +214,17 @@ namespace NEAT
             << ((int)activationFunction) << ' ';
     }
 
+    void GeneticNodeGene::dump(BinaryWriter &writer)
+    {
+        GeneticGene::dump(writer);
+
+        writer.writeString(name);
+        writer.writeString(type);
+        writer.write<double>(drawingPosition);
+        writer.writeBool(topologyFrozen);
+        writer.write<int>(int(activationFunction));
+    }
+
     void GeneticNodeGene::mutate()
     {
         throw CREATE_LOCATEDEXCEPTION_INFO("Don\'t try to mutate node genes!");
@@ -10,9 +10,96 @@
 
 #include "NEAT_GeneticIndividual.h"
 #include "NEAT_Random.h"
+#include "NEAT_Profiler.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
 
 namespace NEAT
 {
+    namespace
+    {
+        /**
+         *  findExistingSpecies: for individuals [begin,end), stores the index of
+         *  the first species in species[0,numSpecies) compatible with it, or -1
+         */
+        void findExistingSpecies(
+            const vector<shared_ptr<GeneticIndividual> > *individuals,
+            const vector<shared_ptr<GeneticIndividual> > *speciesBest,
+            double compatThreshold,
+            int begin,
+            int end,
+            vector<int> *matches
+            )
+        {
+            for (int a=begin;a<end;a++)
+            {
+                (*matches)[a] = -1;
+                for (int b=0;b<(int)speciesBest->size();b++)
+                {
+                    if ((*speciesBest)[b]->getCompatibility((*individuals)[a],compatThreshold)<compatThreshold)
+                    {
+                        (*matches)[a] = b;
+                        break;
+                    }
+                }
+            }
+        }
+
+        /**
+         *  makeOffspring: makes every (step)th baby starting at (first), with
+         *  its innovations deferred to its log.  A failure is stored in
+         *  (error) and stops this thread.
+         */
+        void makeOffspring(
+            const vector<Offspring> *offspring,
+            double minFitness,
+            int generationNumber,
+            int first,
+            int step,
+            vector<shared_ptr<GeneticIndividual> > *babies,
+            vector<InnovationLog> *logs,
+            string *error
+            )
+        {
+            try
+            {
+                for (int a=first;a<(int)offspring->size();a+=step)
+                {
+                    const Offspring &parents = (*offspring)[a];
+
+                    //Negative generations never collide with the evaluation streams
+                    Globals::getSingleton()->setRandomStream(-1-generationNumber,a);
+                    Globals::getSingleton()->deferInnovations(&(*logs)[a]);
+
+                    if (parents.parent2)
+                    {
+                        (*babies)[a] = shared_ptr<GeneticIndividual>(
+                            new GeneticIndividual(parents.parent1,parents.parent2,false,minFitness)
+                            );
+                    }
+                    else
+                    {
+                        (*babies)[a] = shared_ptr<GeneticIndividual>(
+                            new GeneticIndividual(parents.parent1,parents.mutate)
+                            );
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                *error = e.what();
+            }
+            catch (const string &s)
+            {
+                *error = s;
+            }
+
+            Globals::getSingleton()->deferInnovations(NULL);
+            Globals::getSingleton()->clearRandomStream();
+        }
+    }
+
 
     GeneticPopulation::GeneticPopulation()
             : onGeneration(0)
@@ -243,17 +330,82 @@ namespace NEAT
 
     void GeneticPopulation::speciate()
     {
-        double compatThreshold = Globals::getSingleton()->getParameterValue("CompatibilityThreshold");
+        NEAT_PROFILE_SCOPE("speciation");
 
-        for (int a=0;a<generations[onGeneration]->getIndividualCount();a++)
+        double compatThreshold = Globals::getSingleton()->getParameterValue(PARAMETER_COMPATIBILITY_THRESHOLD);
+
+        int numIndividuals = generations[onGeneration]->getIndividualCount();
+
+        vector<shared_ptr<GeneticIndividual> > individuals;
+        for (int a=0;a<numIndividuals;a++)
         {
-            shared_ptr<GeneticIndividual> individual = generations[onGeneration]->getIndividual(a);
+            individuals.push_back(generations[onGeneration]->getIndividual(a));
+        }
+
+        //An individual joins the first compatible species, checking the species that
+        //existed before this pass first.  Those checks do not depend on each other, so
+        //they are split over threads.  The individuals that match none of them are then
+        //checked against the species made in this pass, in order, which gives exactly
+        //the assignment of a serial pass.
+        vector<shared_ptr<GeneticIndividual> > speciesBest;
+        for (int b=0;b<(int)species.size();b++)
+        {
+            speciesBest.push_back(species[b]->getBestIndividual());
+        }
+
+        int numThreads = 1;
+        if (Globals::getSingleton()->hasParameterValue("SpeciationThreads"))
+        {
+            numThreads = int(Globals::getSingleton()->getParameterValue("SpeciationThreads"));
+            if (numThreads<=0)
+            {
+                numThreads = max(1,int(boost::thread::hardware_concurrency()));
+            }
+        }
+        numThreads = max(1,min(numThreads,numIndividuals));
+
+        vector<int> matches(numIndividuals,-1);
+        if (numThreads==1 || speciesBest.empty())
+        {
+            findExistingSpecies(&individuals,&speciesBest,compatThreshold,0,numIndividuals,&matches);
+        }
+        else
+        {
+            boost::thread_group threads;
+            for (int t=0;t<numThreads;t++)
+            {
+                threads.create_thread(
+                    boost::bind(
+                        &findExistingSpecies,
+                        &individuals,
+                        &speciesBest,
+                        compatThreshold,
+                        (numIndividuals*t)/numThreads,
+                        (numIndividuals*(t+1))/numThreads,
+                        &matches
+                        )
+                    );
+            }
+            threads.join_all();
+        }
+
+        int numExistingSpecies = (int)species.size();
+
+        for (int a=0;a<numIndividuals;a++)
+        {
+            shared_ptr<GeneticIndividual> individual = individuals[a];
+
+            if (matches[a]>=0)
+            {
+                individual->setSpeciesID(species[matches[a]]->getID());
+                continue;
+            }
 
             bool makeNewSpecies=true;
 
-            for (int b=0;b<(int)species.size();b++)
+            for (int b=numExistingSpecies;b<(int)species.size();b++)
             {
-                double compatibility = species[b]->getBestIndividual()->getCompatibility(individual);
+                double compatibility = species[b]->getBestIndividual()->getCompatibility(individual,compatThreshold);
                 if (compatibility<compatThreshold)
                 {
                     //Found a compatible species
@@ -271,17 +423,17 @@ namespace NEAT
             }
         }
 
-        int speciesTarget = int(Globals::getSingleton()->getParameterValue("SpeciesSizeTarget"));
+        int speciesTarget = int(Globals::getSingleton()->getParameterValue(PARAMETER_SPECIES_SIZE_TARGET));
 
         double compatMod;
 
         if ((int)species.size()<speciesTarget)
         {
-            compatMod = -Globals::getSingleton()->getParameterValue("CompatibilityModifier");
+            compatMod = -Globals::getSingleton()->getParameterValue(PARAMETER_COMPATIBILITY_MODIFIER);
         }
         else if ((int)species.size()>speciesTarget)
         {
-            compatMod = +Globals::getSingleton()->getParameterValue("CompatibilityModifier");
+            compatMod = +Globals::getSingleton()->getParameterValue(PARAMETER_COMPATIBILITY_MODIFIER);
         }
         else
         {
@@ -356,6 +508,8 @@ namespace NEAT
 
     void GeneticPopulation::produceNextGeneration()
     {
+        NEAT_PROFILE_SCOPE("reproduction");
+
 #ifdef EPLEX_INTERNAL
         if (equals(generations[onGeneration]->getTypeName(),"CoEvoGeneticGeneration"))
         {
@@ -376,7 +530,7 @@ namespace NEAT
         cout << "[HyperNEAT Core - Genetic Population] Bad parents thrown out\n";
         double minFitness = species[0]->getAdjustedFitness();
         if (Globals::getSingleton()->hasParameterValue("MinPossibleFitness"))
-            minFitness = Globals::getSingleton()->getParameterValue("MinPossibleFitness");
+            minFitness = Globals::getSingleton()->getParameterValue(PARAMETER_MIN_POSSIBLE_FITNESS);
         for (int a=0;a<(int)species.size();a++)
         {
             double adjustedFitness = species[a]->getAdjustedFitness();
@@ -436,8 +590,8 @@ namespace NEAT
             cout << "Species ID: " << species[a]->getID() << " Age: " << species[a]->getAge() << " last improv. age: " << species[a]->getAgeOfLastImprovement() << " Fitness: " << species[a]->getFitness() << "*" << species[a]->getMultiplier() << "=" << species[a]->getAdjustedFitness() <<  " Size: " << int(species[a]->getIndividualCount()) << " Offspring: " << int(species[a]->getOffspringCount()) << endl;
         }
 
-        //This is the new generation
-        vector<shared_ptr<GeneticIndividual> > babies;
+        //The parents of the new generation
+        vector<Offspring> offspring;
 
         double totalIndividualFitness=0;
 
@@ -447,12 +601,12 @@ namespace NEAT
         }
 
         int smallestSpeciesSizeWithElitism
-        = int(Globals::getSingleton()->getParameterValue("SmallestSpeciesSizeWithElitism"));
+        = int(Globals::getSingleton()->getParameterValue(PARAMETER_SMALLEST_SPECIES_SIZE_WITH_ELITISM));
         double mutateSpeciesChampionProbability
-        = Globals::getSingleton()->getParameterValue("MutateSpeciesChampionProbability");
+        = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_SPECIES_CHAMPION_PROBABILITY);
         bool forceCopyGenerationChampion
         = (
-              Globals::getSingleton()->getParameterValue("ForceCopyGenerationChampion")>
+              Globals::getSingleton()->getParameterValue(PARAMETER_FORCE_COPY_GENERATION_CHAMPION)>
               Globals::getSingleton()->getRandom().getRandomDouble()
           );
 
@@ -481,7 +635,7 @@ namespace NEAT
                         mutateChampion = true;
                     else
                         mutateChampion = false;
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,mutateChampion)));
+                    offspring.push_back(Offspring(ind,mutateChampion));
                     species->decrementOffspringCount();
                 }
 
@@ -501,18 +655,21 @@ namespace NEAT
             cout << "Champion data: " << generations[onGeneration]->getIndividual(0)->getUserData() << endl;
         }
         cout << "# of Species: " << int(species.size()) << endl;
-        cout << "compat threshold: " << Globals::getSingleton()->getParameterValue("CompatibilityThreshold") << endl;
+        cout << "compat threshold: " << Globals::getSingleton()->getParameterValue(PARAMETER_COMPATIBILITY_THRESHOLD) << endl;
 
         for (int a=0;a<(int)species.size();a++)
         {
-            //cout << "Making babies\n";
-            species[a]->makeBabies(babies, minFitness);
+            species[a]->chooseParents(offspring);
         }
-        if ((int)babies.size()!=generations[onGeneration]->getIndividualCount())
+        if ((int)offspring.size()!=generations[onGeneration]->getIndividualCount())
         {
             cout << "Population size changed!\n";
             throw CREATE_LOCATEDEXCEPTION_INFO("Population size changed!");
         }
+
+        //This is the new generation
+        vector<shared_ptr<GeneticIndividual> > babies;
+        makeBabies(offspring,minFitness,babies);
         cout << "Done Making Babies" << endl;
 
         //cout << "Making new generation\n";
@@ -534,6 +691,79 @@ namespace NEAT
     }
 
 
+    void GeneticPopulation::makeBabies(
+        const vector<Offspring> &offspring,
+        double minFitness,
+        vector<shared_ptr<GeneticIndividual> > &babies
+        )
+    {
+        int numBabies = int(offspring.size());
+        int generationNumber = onGeneration+1;
+
+        babies.assign(numBabies,shared_ptr<GeneticIndividual>());
+        vector<InnovationLog> logs(numBabies);
+
+        int numThreads = 1;
+        if (Globals::getSingleton()->hasParameterValue("ReproductionThreads"))
+        {
+            numThreads = int(Globals::getSingleton()->getParameterValue("ReproductionThreads"));
+            if (numThreads<=0)
+            {
+                numThreads = max(1,int(boost::thread::hardware_concurrency()));
+            }
+        }
+        numThreads = max(1,min(numThreads,numBabies));
+
+        vector<string> errors(numThreads);
+
+        if (numThreads==1)
+        {
+            makeOffspring(&offspring,minFitness,generationNumber,0,1,&babies,&logs,&errors[0]);
+        }
+        else
+        {
+            //Babies are dealt round robin, so the crossovers of a large species
+            //end up on different threads
+            boost::thread_group threads;
+            for (int t=0;t<numThreads;t++)
+            {
+                threads.create_thread(
+                    boost::bind(
+                        &makeOffspring,
+                        &offspring,
+                        minFitness,
+                        generationNumber,
+                        t,
+                        numThreads,
+                        &babies,
+                        &logs,
+                        &errors[t]
+                        )
+                    );
+            }
+            threads.join_all();
+        }
+
+        for (int t=0;t<numThreads;t++)
+        {
+            if (errors[t].length())
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO(string("Error making babies: ")+errors[t]);
+            }
+        }
+
+        //Number the new genes in baby order, as if the babies were made one by one
+        vector<int> nodeIDs,linkIDs;
+        for (int a=0;a<numBabies;a++)
+        {
+            if (logs[a].nodeCount || logs[a].links.size())
+            {
+                Globals::getSingleton()->commitInnovations(logs[a],nodeIDs,linkIDs);
+                babies[a]->commitInnovations(nodeIDs,linkIDs);
+            }
+        }
+    }
+
     void GeneticPopulation::dump(string filename,bool includeGenes,bool doGZ)
     {
         TiXmlDocument doc( filename );
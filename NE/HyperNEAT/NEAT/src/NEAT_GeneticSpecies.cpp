@@ -34,7 +34,7 @@ namespace NEAT
 
     void GeneticSpecies::setMultiplier()
     {
-        int dropoffAge = int(Globals::getSingleton()->getParameterValue("DropoffAge"));
+        int dropoffAge = int(Globals::getSingleton()->getParameterValue(PARAMETER_DROPOFF_AGE));
 
         multiplier = 1;
 
@@ -49,7 +49,7 @@ namespace NEAT
         //The age_significance parameter is a system parameter
         //  if it is 1, then young species get no fitness boost
         if (age<10)
-            multiplier *= Globals::getSingleton()->getParameterValue("AgeSignificance");
+            multiplier *= Globals::getSingleton()->getParameterValue(PARAMETER_AGE_SIGNIFICANCE);
 
         //Share fitness with the species
         multiplier /= currentIndividuals.size();
@@ -86,16 +86,16 @@ namespace NEAT
         }
     }
 
-    void GeneticSpecies::makeBabies(vector<shared_ptr<GeneticIndividual> > &babies, double minGenerationalFitness)
+    void GeneticSpecies::chooseParents(vector<Offspring> &offspring)
     {
-        int lastIndex = int(Globals::getSingleton()->getParameterValue("SurvivalThreshold")*currentIndividuals.size());
+        int lastIndex = int(Globals::getSingleton()->getParameterValue(PARAMETER_SURVIVAL_THRESHOLD)*currentIndividuals.size());
 
         for (int a=lastIndex+1;a<(int)currentIndividuals.size();a++)
         {
             currentIndividuals[a]->setCanReproduce(false);
         }
 
-        double mutateOnlyProb = Globals::getSingleton()->getParameterValue("MutateOnlyProbability");
+        double mutateOnlyProb = Globals::getSingleton()->getParameterValue(PARAMETER_MUTATE_ONLY_PROBABILITY);
         for (int a=0;offspringCount>0;a++)
         {
             if (a>=1000000)
@@ -104,7 +104,7 @@ namespace NEAT
                 //Something messed up, bail
                 int parent = 0;
                 shared_ptr<GeneticIndividual> ind = currentIndividuals[parent];
-                babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,true)));
+                offspring.push_back(Offspring(ind,true));
                 offspringCount--;
                 continue;
             }
@@ -114,7 +114,7 @@ namespace NEAT
             {
                 int parent = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
                 shared_ptr<GeneticIndividual> ind = currentIndividuals[parent];
-                babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,true)));
+                offspring.push_back(Offspring(ind,true));
                 offspringCount--;
             }
             else
@@ -145,11 +145,11 @@ namespace NEAT
 
                 if (parent1==parent2)
                 {
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,true)));
+                    offspring.push_back(Offspring(parent1,true));
                 }
                 else
                 {
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,parent2,false,minGenerationalFitness)));
+                    offspring.push_back(Offspring(parent1,parent2));
                 }
                 offspringCount--;
             }
@@ -8,6 +8,7 @@
 #define DEBUG_NEAT_GLOBALS (0)
 
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/tss.hpp>
 
 const char* activationFunctionNames[ACTIVATION_FUNCTION_END] =
 {
@@ -21,39 +22,166 @@ const char* activationFunctionNames[ACTIVATION_FUNCTION_END] =
     "ONES_COMPLIMENT"
 };
 
+const char* parameterSlotNames[PARAMETER_SLOT_END] =
+{
+    "DisjointCoefficient",
+    "ExcessCoefficient",
+    "WeightDifferenceCoefficient",
+    "FitnessCoefficient",
+    "CompatibilityThreshold",
+    "CompatibilityModifier",
+    "SpeciesSizeTarget",
+    "DropoffAge",
+    "AgeSignificance",
+    "SurvivalThreshold",
+    "MutateAddNodeProbability",
+    "MutateAddLinkProbability",
+    "MutateDemolishLinkProbability",
+    "MutateLinkWeightsProbability",
+    "MutateLinkProbability",
+    "MutateOnlyProbability",
+    "MutateSpeciesChampionProbability",
+    "MutationPower",
+    "AdultLinkAge",
+    "AllowRecurrentConnections",
+    "AllowSelfRecurrentConnections",
+    "AllowAddNodeToRecurrentConnection",
+    "SmallestSpeciesSizeWithElitism",
+    "ForceCopyGenerationChampion",
+    "LinkGeneMinimumWeightForPhentoype",
+    "ExtraActivationFunctions",
+    "AddBiasToHiddenNodes",
+    "OnlyGaussianHiddenNodes",
+    "MinPossibleFitness"
+};
+
 namespace NEAT
 {
     double signedSigmoidTable[6001];
     double unsignedSigmoidTable[6001];
 
     Globals *Globals::singleton = NULL;
+
+    //Per thread random stream, see Globals::setRandomStream
+    static boost::thread_specific_ptr<Random> threadRandomStream;
+
+    //Per thread innovation log, see Globals::deferInnovations.  The log
+    //belongs to the caller, so the pointer is never deleted here.
+    static void keepInnovationLog(InnovationLog *)
+    {}
+
+    static boost::thread_specific_ptr<InnovationLog> threadInnovationLog(&keepInnovationLog);
+
     void Globals::assignNodeID(GeneticNodeGene *testNode)
     {
+        InnovationLog *log = threadInnovationLog.get();
+        if (log)
+        {
+            testNode->setID(InnovationLog::FIRST_PROVISIONAL_ID+log->nodeCount);
+            log->nodeCount++;
+            return;
+        }
+
         testNode->setID(generateNodeID());
     }
 
-    void Globals::assignLinkID(GeneticLinkGene *testLink,bool ignoreHistory)
+    void Globals::assignLinkID(GeneticLinkGene *testLink)
     {
-        if (ignoreHistory)
+        pair<int,int> nodeIDs(testLink->getFromNodeID(),testLink->getToNodeID());
+
+        InnovationLog *log = threadInnovationLog.get();
+        if (log)
         {
-            testLink->setID(generateLinkID());
+            boost::unordered_map<pair<int,int>,int>::iterator existing = log->linkIndex.find(nodeIDs);
+            int index;
+            if (existing!=log->linkIndex.end())
+            {
+                index = existing->second;
+            }
+            else
+            {
+                index = int(log->links.size());
+                log->links.push_back(nodeIDs);
+                log->linkIndex[nodeIDs] = index;
+            }
+            testLink->setID(InnovationLog::FIRST_PROVISIONAL_ID+index);
+            return;
         }
+
+        testLink->setID(registerLink(nodeIDs.first,nodeIDs.second));
+    }
+
+    int Globals::registerLink(int fromNodeID,int toNodeID)
+    {
+        pair<int,int> nodeIDs(fromNodeID,toNodeID);
+
+        boost::unordered_map<pair<int,int>,int>::iterator existing = linkHistoryIndex.find(nodeIDs);
+        if (existing!=linkHistoryIndex.end())
+        {
+            return existing->second;
+        }
+
+        int ID = generateLinkID();
+        shared_ptr<GeneticLinkGene> link(new GeneticLinkGene());
+        link->updateLegacy(fromNodeID,toNodeID);
+        link->setWeight(0.0);
+        link->setFixed(false);
+        link->setID(ID);
+        linkGenesThisGeneration.push_back(link);
+        linkHistoryIndex[nodeIDs] = ID;
+        return ID;
+    }
+
+    void Globals::rebuildLinkHistoryIndex()
+    {
+        linkHistoryIndex.clear();
         for (int a=0;a<(int)linkGenesThisGeneration.size();a++)
         {
             shared_ptr<GeneticLinkGene> link = linkGenesThisGeneration[a];
-            if (link->getFromNodeID()==testLink->getFromNodeID()&&link->getToNodeID()==testLink->getToNodeID())
+            pair<int,int> nodeIDs(link->getFromNodeID(),link->getToNodeID());
+            if (linkHistoryIndex.find(nodeIDs)==linkHistoryIndex.end())
             {
-                testLink->setID( link->getID() );
-                return;
+                linkHistoryIndex[nodeIDs] = link->getID();
             }
         }
-        testLink->setID(generateLinkID());
-        linkGenesThisGeneration.push_back(shared_ptr<GeneticLinkGene>(new GeneticLinkGene(*testLink)));
     }
 
     void Globals::clearLinkHistory()
     {
         linkGenesThisGeneration.clear();
+        linkHistoryIndex.clear();
+    }
+
+    void Globals::deferInnovations(InnovationLog *log)
+    {
+        threadInnovationLog.reset(log);
+    }
+
+    void Globals::commitInnovations(const InnovationLog &log,vector<int> &nodeIDs,vector<int> &linkIDs)
+    {
+        nodeIDs.resize(log.nodeCount);
+        for (int a=0;a<log.nodeCount;a++)
+        {
+            nodeIDs[a] = generateNodeID();
+        }
+
+        linkIDs.resize(log.links.size());
+        for (int a=0;a<(int)log.links.size();a++)
+        {
+            int fromNodeID = log.links[a].first;
+            int toNodeID = log.links[a].second;
+
+            if (InnovationLog::isProvisional(fromNodeID))
+            {
+                fromNodeID = nodeIDs[fromNodeID-InnovationLog::FIRST_PROVISIONAL_ID];
+            }
+            if (InnovationLog::isProvisional(toNodeID))
+            {
+                toNodeID = nodeIDs[toNodeID-InnovationLog::FIRST_PROVISIONAL_ID];
+            }
+
+            linkIDs[a] = registerLink(fromNodeID,toNodeID);
+        }
     }
 
     int Globals::generateSpeciesID()
@@ -74,6 +202,8 @@ namespace NEAT
     void Globals::addParameter(string name,double value)
     {
         parameters.insert(name,value);
+
+        updateParameterSlot(name,value);
     }
 
     void Globals::setParameterValue(string name,double value)
@@ -88,7 +218,9 @@ namespace NEAT
             nodeCounter(0),
             linkCounter(0),
             speciesCounter(0),
-            minPossibleFitness(0)
+            minPossibleFitness(0),
+            parameterSlotValues(),
+            parameterSlotSet()
     {
         cout << "Populating sigmoid table...";
         for (int a=0;a<6001;a++)
@@ -147,7 +279,9 @@ namespace NEAT
             nodeCounter(0),
             linkCounter(0),
             speciesCounter(0),
-            minPossibleFitness(0)
+            minPossibleFitness(0),
+            parameterSlotValues(),
+            parameterSlotSet()
     {
         cout << "Populating sigmoid table...";
         for (int a=0;a<6001;a++)
@@ -208,7 +342,9 @@ namespace NEAT
             nodeCounter(-1),
             linkCounter(-1),
             speciesCounter(-1),
-            minPossibleFitness(-1)
+            minPossibleFitness(-1),
+            parameterSlotValues(),
+            parameterSlotSet()
     {
         cout << "Populating sigmoid table...";
         for (int a=0;a<6001;a++)
@@ -267,6 +403,24 @@ namespace NEAT
         }
     }
 
+    Random &Globals::getRandom()
+    {
+        Random *stream = threadRandomStream.get();
+        return stream ? *stream : random;
+    }
+
+    void Globals::setRandomStream(int generation,int individual)
+    {
+        threadRandomStream.reset(
+            new Random(Random::deriveSeed(random.getSeed(),generation,individual))
+            );
+    }
+
+    void Globals::clearRandomStream()
+    {
+        threadRandomStream.reset();
+    }
+
     void Globals::seedRandom(unsigned int newSeed)
     {
         cout << "Reseeding random with seed: " << newSeed << endl;
@@ -275,7 +429,7 @@ namespace NEAT
 
     void Globals::dump(TiXmlElement *root)
     {
-        root->SetAttribute("ActualRandomSeed",getRandom().getSeed());
+        root->SetAttribute("ActualRandomSeed",random.getSeed());
         root->SetAttribute("NodeCounter",nodeCounter);
         root->SetAttribute("LinkCounter",linkCounter);
         root->SetAttribute("SpeciesCounter",speciesCounter);
@@ -309,8 +463,27 @@ namespace NEAT
     Globals::~Globals()
     {}
 
+    void Globals::updateParameterSlot(const string &name,double value)
+    {
+        for (int a=0;a<PARAMETER_SLOT_END;a++)
+        {
+            if (name==parameterSlotNames[a])
+            {
+                parameterSlotValues[a] = value;
+                parameterSlotSet[a] = true;
+                return;
+            }
+        }
+    }
+
 	void Globals::cacheParameters()
 	{
+        for (int a=0;a<PARAMETER_SLOT_END;a++)
+        {
+            parameterSlotSet[a] = hasParameterValue(parameterSlotNames[a]);
+            parameterSlotValues[a] = parameterSlotSet[a] ? getParameterValue(parameterSlotNames[a]) : 0.0;
+        }
+
           //cout << "ExtraActivationUpdates" << endl;
         extraActivationUpdates = int(getParameterValue("ExtraActivationUpdates"));
 
@@ -333,5 +506,44 @@ namespace NEAT
 		{
 			useTanhSigmoid = false;
 		}
+
+		fastNetworkEngine = FAST_NETWORK_ENGINE_LINKS;
+		if(hasParameterValue("FastNetworkEngine"))
+		{
+			int engine = int(getParameterValue("FastNetworkEngine"));
+			if(engine<0 || engine>=FAST_NETWORK_ENGINE_END)
+			{
+				throw CREATE_LOCATEDEXCEPTION_INFO("Unknown FastNetworkEngine!");
+			}
+			fastNetworkEngine = FastNetworkEngine(engine);
+		}
+
+		layeredNetworkEngine = LAYERED_NETWORK_ENGINE_DENSE;
+		if(hasParameterValue("LayeredNetworkEngine"))
+		{
+			int engine = int(getParameterValue("LayeredNetworkEngine"));
+			if(engine<0 || engine>=LAYERED_NETWORK_ENGINE_END)
+			{
+				throw CREATE_LOCATEDEXCEPTION_INFO("Unknown LayeredNetworkEngine!");
+			}
+			layeredNetworkEngine = LayeredNetworkEngine(engine);
+		}
+
+		layeredNetworkInputs = LAYERED_NETWORK_INPUTS_DENSE;
+		if(hasParameterValue("LayeredNetworkInputs"))
+		{
+			int inputs = int(getParameterValue("LayeredNetworkInputs"));
+			if(inputs<0 || inputs>=LAYERED_NETWORK_INPUTS_END)
+			{
+				throw CREATE_LOCATEDEXCEPTION_INFO("Unknown LayeredNetworkInputs!");
+			}
+			layeredNetworkInputs = LayeredNetworkInputs(inputs);
+		}
+
+		frameSkip = 1;
+		if(hasParameterValue("FrameSkip"))
+		{
+			frameSkip = max(1,int(getParameterValue("FrameSkip")+0.001));
+		}
 	}
 }
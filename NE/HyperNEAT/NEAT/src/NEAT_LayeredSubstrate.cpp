@@ -4,6 +4,8 @@
 
 #include "NEAT_GeneticIndividual.h"
 
+#include "NEAT_Profiler.h"
+
 #include "Board.h"
 #include <boost/lexical_cast.hpp>
 
@@ -15,6 +17,9 @@
 
 #define DEBUG_MAX_DELTA_RANGE (2)
 
+//Number of CPPN queries evaluated together by FastNetwork::updateBatch
+#define LAYERED_SUBSTRATE_CPPN_BATCH_SIZE (256)
+
 namespace NEAT
 {
     template<class NetworkDataType>
@@ -35,6 +40,47 @@ namespace NEAT
             }
     };
 
+    /**
+     * flushCppnBatch: Evaluates the queued CPPN queries, records the resulting
+     * links in the order they were queued and empties the queue.  Returns the
+     * number of queries processed.
+     */
+    template< class NetworkDataType >
+    int LayeredSubstrate<NetworkDataType>::flushCppnBatch(
+        NEAT::FastNetwork<NetworkDataType> &cppn,
+        vector<NetworkDataType> &batchValues,
+        int batchSize,
+        int outputIndex,
+        vector<JGTL::Vector3<int> > &batchInputNodes,
+        vector<JGTL::Vector3<int> > &batchOutputNodes,
+        map<JGTL::Vector3<int>, vector<LinkWeightPair<NetworkDataType> > > &allIncomingLinks
+        )
+    {
+        cppn.updateBatch(&batchValues[0],batchSize);
+
+        int numQueries = int(batchInputNodes.size());
+        for (int lane=0;lane<numQueries;lane++)
+        {
+            NetworkDataType output = batchValues[outputIndex*batchSize+lane];
+
+            output = convertOutputToWeight(output);
+
+            // Set the output value for this link
+            vector<LinkWeightPair<NetworkDataType> > &incomingLinks = allIncomingLinks[batchOutputNodes[lane]];
+            if(fabs(output)>0.0)
+            {
+                incomingLinks.push_back(LinkWeightPair<NetworkDataType> (batchInputNodes[lane],output));
+            }
+        }
+
+        // Equivalent of cppn.reinitialize() for the next block
+        std::fill(batchValues.begin(),batchValues.end(),(NetworkDataType)0);
+        batchInputNodes.clear();
+        batchOutputNodes.clear();
+
+        return numQueries;
+    }
+
     template< class NetworkDataType >
     LayeredSubstrate<NetworkDataType>::LayeredSubstrate()
     {
@@ -108,6 +154,8 @@ namespace NEAT
         shared_ptr<NEAT::GeneticIndividual> individual
         )
     {
+        NEAT_PROFILE_SCOPE("substratePopulation");
+
         nameLookup.clear();
 
         NEAT::FastNetwork<NetworkDataType> cppn = individual->spawnFastPhenotypeStack<NetworkDataType>();
@@ -173,6 +221,39 @@ namespace NEAT
                 JGTL::Vector2<int> validOutputStart = (layerSizes[z2] - layerValidSizes[z2])/2;
                 JGTL::Vector2<int> validOutputEnd = ((layerSizes[z2] - layerValidSizes[z2])/2) + layerValidSizes[z2];
 
+                // Resolve the CPPN inputs once per layer pair instead of once per query
+                int x1Index=-1,y1Index=-1,x2Index=-1,y2Index=-1,deltaXIndex=-1,deltaYIndex=-1,biasIndex=-1;
+                if (cppn.hasNode("X1"))
+                {
+                    x1Index = cppn.getNodeIndex("X1");
+                    y1Index = cppn.getNodeIndex("Y1");
+                }
+                if (cppn.hasNode("X2"))
+                {
+                    x2Index = cppn.getNodeIndex("X2");
+                    y2Index = cppn.getNodeIndex("Y2");
+                }
+                // TODO self input node
+                if(cppn.hasNode("DeltaX"))
+                {
+                    deltaXIndex = cppn.getNodeIndex("DeltaX");
+                    deltaYIndex = cppn.getNodeIndex("DeltaY");
+                }
+                if(cppn.hasNode("Bias"))
+                {
+                    biasIndex = cppn.getNodeIndex("Bias");
+                }
+                int outputIndex = cppn.getNodeIndex(outputNodeName);
+
+                // Queries are queued into a block and evaluated together.  The
+                // block is laid out node-major, see FastNetwork::updateBatch.
+                const int batchSize = LAYERED_SUBSTRATE_CPPN_BATCH_SIZE;
+                vector<NetworkDataType> batchValues(size_t(cppn.getNodeCount())*batchSize,(NetworkDataType)0);
+                vector<JGTL::Vector3<int> > batchInputNodes;
+                vector<JGTL::Vector3<int> > batchOutputNodes;
+                batchInputNodes.reserve(batchSize);
+                batchOutputNodes.reserve(batchSize);
+
                 for (int y1=validInputStart.y;y1<validInputEnd.y;y1++)
                 {
                     for (int x1=validInputStart.x;x1<validInputEnd.x;x1++)
@@ -235,17 +316,17 @@ namespace NEAT
                                     y2normal = 0.0f;
                                 }
 
-                                // Set the values of the CPPNs inputs
-                                cppn.reinitialize();
-                                if (cppn.hasNode("X1"))
+                                // Set the values of the CPPNs inputs for this pattern
+                                int lane = int(batchInputNodes.size());
+                                if (x1Index!=-1)
                                 {
-                                    cppn.setValue("X1",x1normal);
-                                    cppn.setValue("Y1",y1normal);
+                                    batchValues[x1Index*batchSize+lane] = x1normal;
+                                    batchValues[y1Index*batchSize+lane] = y1normal;
                                 }
-                                if (cppn.hasNode("X2"))
+                                if (x2Index!=-1)
                                 {
-                                    cppn.setValue("X2",x2normal);
-                                    cppn.setValue("Y2",y2normal);
+                                    batchValues[x2Index*batchSize+lane] = x2normal;
+                                    batchValues[y2Index*batchSize+lane] = y2normal;
                                 }
                                 // This is a specialized handler for Atari Game CPPNs
                                 // for (int inputSubstrate=0; ; inputSubstrate++) {
@@ -260,8 +341,7 @@ namespace NEAT
                                 //   } else
                                 //     break;
                                 // }
-                                // TODO self input node
-                                if(cppn.hasNode("DeltaX"))
+                                if(deltaXIndex!=-1)
                                 {
                                     if(
 #if DEBUG_USE_DELTAS_ON_LONG_RANGE
@@ -271,104 +351,47 @@ namespace NEAT
                                         chessDistance<=maxDeltaLength
                                         )
                                     {
-                                        //cout << x1 << ',' << x2 << ',' << y1 << ',' << y2 << endl;
-                                        //cout << x1normal << ',' << x2normal << ',' << y1normal << ',' << y2normal << endl;
-                                        //cout << "DeltaX:" << (x2normal-x1normal)
-                                        //<< ", DeltaY: " << (y2normal-y1normal)
-                                        //<< endl;
-                                        cppn.setValue("DeltaX",x2normal-x1normal);
-                                        cppn.setValue("DeltaY",y2normal-y1normal);
+                                        batchValues[deltaXIndex*batchSize+lane] = x2normal-x1normal;
+                                        batchValues[deltaYIndex*batchSize+lane] = y2normal-y1normal;
                                     }
                                     else
                                     {
-                                        cppn.setValue("DeltaX",0);
-                                        cppn.setValue("DeltaY",0);
+                                        batchValues[deltaXIndex*batchSize+lane] = 0;
+                                        batchValues[deltaYIndex*batchSize+lane] = 0;
                                     }
                                 }
 
-                                if(cppn.hasNode("Bias"))
-                                {
-                                    cppn.setValue("Bias",(NetworkDataType)0.3);
-                                }
-
-                                cppn.update();
-
-                                NetworkDataType output;
-
-                                output = cppn.getValue(outputNodeName);
-
-                                output = convertOutputToWeight(output);
-
-                                JGTL::Vector3<int> inputNode(x1,y1,z1);
-                                JGTL::Vector3<int> outputNode(x2,y2,z2);
-                                if(allIncomingLinks.find(outputNode)==allIncomingLinks.end())
-                                {
-                                    allIncomingLinks[outputNode] = vector<LinkWeightPair<NetworkDataType> >();
-                                }
-
-                                vector<LinkWeightPair<NetworkDataType> > &incomingLinks = allIncomingLinks[outputNode];
-                                // Set the output value for this link
-                                if(fabs(output)>0.0)
+                                if(biasIndex!=-1)
                                 {
-                                    incomingLinks.push_back(LinkWeightPair<NetworkDataType> (inputNode,output));
+                                    batchValues[biasIndex*batchSize+lane] = (NetworkDataType)0.3;
                                 }
 
-                                linkCounter++;
+                                batchInputNodes.push_back(JGTL::Vector3<int>(x1,y1,z1));
+                                batchOutputNodes.push_back(JGTL::Vector3<int>(x2,y2,z2));
 
-#if LAYERED_SUBSTRATE_ENABLE_BIASES
-                                throw CREATE_LOCATEDEXCEPTION_INFO("NOT SUPPORTED YET");
-                                if (x1==0&&y1==0&&z1==0)
+                                if (int(batchInputNodes.size())==batchSize)
                                 {
-                                    NetworkDataType nodeBias;
-
-                                    if (z2==1)
-                                    {
-                                        nodeBias = network.getValue("Bias_b");
-
-                                        nodeBias = convertOutputToWeight(nodeBias);
-
-                                        /*{
-                                          cout << "Setting bias for "
-                                          << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,1)]
-                                          << endl;
-                                          cout << "Bias: " << nodeBias << endl;
-                                          CREATE_PAUSE("");
-                                          }*/
-
-                                        substrate.setBias(
-                                            *nameLookup.getData(Node(x2,y2,z2)),
-                                            nodeBias
-                                            );
-                                    }
-                                    else if (z2==2)
-                                    {
-                                        nodeBias = network.getValue("Bias_c");
-
-                                        nodeBias = convertOutputToWeight(nodeBias);
-
-                                        /*{
-                                          cout << "Setting bias for "
-                                          << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,2)]
-                                          << endl;
-                                          cout << "Bias: " << nodeBias << endl;
-                                          CREATE_PAUSE("");
-                                          }*/
-
-                                        substrate.setBias(
-                                            *nameLookup.getData(Node(x2,y2,z2)),
-                                            nodeBias
-                                            );
-                                    }
-                                    else
-                                    {
-                                        throw CREATE_LOCATEDEXCEPTION_INFO("wtf");
-                                    }
+                                    linkCounter += flushCppnBatch(
+                                        cppn,batchValues,batchSize,outputIndex,
+                                        batchInputNodes,batchOutputNodes,allIncomingLinks
+                                        );
                                 }
-#endif
                             }
                         }
                     }
                 }
+
+                if (batchInputNodes.size())
+                {
+                    linkCounter += flushCppnBatch(
+                        cppn,batchValues,batchSize,outputIndex,
+                        batchInputNodes,batchOutputNodes,allIncomingLinks
+                        );
+                }
+
+#if LAYERED_SUBSTRATE_ENABLE_BIASES
+                throw CREATE_LOCATEDEXCEPTION_INFO("NOT SUPPORTED YET");
+#endif
             }
         }
 
@@ -553,6 +576,14 @@ namespace NEAT
             }
         }
 
+        // Measure each layer pair's weight density once so update() can
+        // pick its dense or sparse path without rescanning the weights
+        if(Globals::getSingleton()->getLayeredNetworkEngine()!=LAYERED_NETWORK_ENGINE_DENSE ||
+           Globals::getSingleton()->getLayeredNetworkInputs()!=LAYERED_NETWORK_INPUTS_DENSE)
+        {
+            network.compileWeights();
+        }
+
 #if 0
         delete[] tmpNodes;
         delete[] tmpLinks;
@@ -0,0 +1,295 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_Profiler.h"
+
+#include "JGTL_QuickProf.h"
+
+#include <boost/thread/tss.hpp>
+
+namespace NEAT
+{
+    bool Profiler::enabled = false;
+
+    namespace
+    {
+        boost::mutex profileMutex;
+
+        JGTL::Clock profileClock;
+
+        JGTL::Profiler *quickProf = NULL;
+
+        //The name of each scope ID
+        vector<string> scopeNames;
+
+        //Whether each scope has been timed since start(), so the summaries
+        //list the scopes in the order they were first timed
+        vector<int> timedScopes;
+        vector<bool> scopeTimed;
+
+        ofstream profileFile;
+
+        bool writeJSON = false;
+
+        bool inGeneration = false;
+
+        unsigned long generationStartMicroseconds = 0;
+
+        /**
+         *  ThreadTimes: the time and number of runs of each scope on one
+         *  thread in the current generation.  Only the thread itself adds to
+         *  them, so its lock is only contended while a generation begins or
+         *  ends.
+         */
+        class ThreadTimes
+        {
+        public:
+            boost::mutex mutex;
+            vector<unsigned long> microseconds;
+            vector<unsigned long> runs;
+        };
+
+        //The times of every thread that has run a scope (under profileMutex)
+        vector<ThreadTimes*> threadTimes;
+
+        //The times of the threads that have exited in this generation
+        ThreadTimes exitedThreadTimes;
+
+        void addThreadTimes(ThreadTimes &total,const ThreadTimes &times)
+        {
+            if (total.microseconds.size()<times.microseconds.size())
+            {
+                total.microseconds.resize(times.microseconds.size(),0);
+                total.runs.resize(times.runs.size(),0);
+            }
+
+            for (int a=0;a<(int)times.microseconds.size();a++)
+            {
+                total.microseconds[a] += times.microseconds[a];
+                total.runs[a] += times.runs[a];
+            }
+        }
+
+        void clearThreadTimes(ThreadTimes &times)
+        {
+            fill(times.microseconds.begin(),times.microseconds.end(),0);
+            fill(times.runs.begin(),times.runs.end(),0);
+        }
+
+        void retireThreadTimes(ThreadTimes *times)
+        {
+            boost::mutex::scoped_lock lock(profileMutex);
+
+            addThreadTimes(exitedThreadTimes,*times);
+            threadTimes.erase(find(threadTimes.begin(),threadTimes.end(),times));
+            delete times;
+        }
+
+        boost::thread_specific_ptr<ThreadTimes> currentThreadTimes(&retireThreadTimes);
+    }
+
+    void Profiler::start(const string &fileName)
+    {
+        boost::mutex::scoped_lock lock(profileMutex);
+
+        if (enabled)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("The profiler has already been started!");
+        }
+
+        //Runs that continue a run, or produce one generation each, add to the same file
+        bool newFile = !boost::filesystem::exists(fileName) || boost::filesystem::file_size(fileName)==0;
+
+        profileFile.open(fileName.c_str(),ios::out|ios::app);
+        if (!profileFile)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not open the profile file ")+fileName);
+        }
+
+        writeJSON = iends_with(fileName,".json");
+        if (!writeJSON && newFile)
+        {
+            profileFile << "generation,scope,milliseconds,percent" << endl;
+        }
+
+        quickProf = new JGTL::Profiler();
+        quickProf->init();
+        timedScopes.clear();
+        scopeTimed.assign(scopeNames.size(),false);
+        inGeneration = false;
+
+        enabled = true;
+    }
+
+    void Profiler::stop()
+    {
+        boost::mutex::scoped_lock lock(profileMutex);
+
+        if (!enabled)
+        {
+            return;
+        }
+
+        //Scopes that are still open check inGeneration before they add their time
+        enabled = false;
+        inGeneration = false;
+
+        delete quickProf;
+        quickProf = NULL;
+
+        profileFile.close();
+    }
+
+    void Profiler::beginGeneration()
+    {
+        if (!enabled)
+        {
+            return;
+        }
+
+        boost::mutex::scoped_lock lock(profileMutex);
+
+        quickProf->beginCycle();
+        inGeneration = true;
+        generationStartMicroseconds = getMicroseconds();
+
+        //Drop what the threads timed between the generations
+        for (int a=0;a<(int)threadTimes.size();a++)
+        {
+            boost::mutex::scoped_lock threadLock(threadTimes[a]->mutex);
+            clearThreadTimes(*threadTimes[a]);
+        }
+        clearThreadTimes(exitedThreadTimes);
+    }
+
+    void Profiler::endGeneration(int generation)
+    {
+        if (!enabled)
+        {
+            return;
+        }
+
+        boost::mutex::scoped_lock lock(profileMutex);
+
+        if (!inGeneration)
+        {
+            return;
+        }
+
+        double generationMilliseconds = (getMicroseconds()-generationStartMicroseconds)/1000.0;
+
+        //Merge the times of all threads, and leave them cleared for the next
+        //generation
+        ThreadTimes total;
+        addThreadTimes(total,exitedThreadTimes);
+        clearThreadTimes(exitedThreadTimes);
+        for (int a=0;a<(int)threadTimes.size();a++)
+        {
+            boost::mutex::scoped_lock threadLock(threadTimes[a]->mutex);
+            addThreadTimes(total,*threadTimes[a]);
+            clearThreadTimes(*threadTimes[a]);
+        }
+
+        for (int scopeID=0;scopeID<(int)total.runs.size();scopeID++)
+        {
+            if (!total.runs[scopeID])
+            {
+                continue;
+            }
+
+            if (!scopeTimed[scopeID])
+            {
+                scopeTimed[scopeID] = true;
+                timedScopes.push_back(scopeID);
+            }
+            quickProf->addBlockTime(scopeNames[scopeID],total.microseconds[scopeID]);
+        }
+
+        quickProf->endCycle();
+        inGeneration = false;
+
+        if (writeJSON)
+        {
+            profileFile << "{\"generation\":" << generation
+                        << ",\"milliseconds\":" << generationMilliseconds
+                        << ",\"scopes\":{";
+        }
+        else
+        {
+            profileFile << generation << ",generation," << generationMilliseconds << ",100" << endl;
+        }
+
+        for (int a=0;a<(int)timedScopes.size();a++)
+        {
+            const string &scopeName = scopeNames[timedScopes[a]];
+
+            //Without smoothing, the average is the time in the cycle that just ended
+            double milliseconds = quickProf->getAvgDuration(scopeName,JGTL::MILLISECONDS);
+            double percent = (generationMilliseconds>0) ? 100.0*milliseconds/generationMilliseconds : 0.0;
+
+            if (writeJSON)
+            {
+                profileFile << (a ? "," : "") << "\"" << scopeName << "\":{"
+                            << "\"milliseconds\":" << milliseconds
+                            << ",\"percent\":" << percent << "}";
+            }
+            else
+            {
+                profileFile << generation << "," << scopeName << ","
+                            << milliseconds << "," << percent << endl;
+            }
+        }
+
+        if (writeJSON)
+        {
+            profileFile << "}}" << endl;
+        }
+
+        profileFile.flush();
+    }
+
+    unsigned long Profiler::getMicroseconds()
+    {
+        return profileClock.getTimeMicroseconds();
+    }
+
+    int Profiler::getScopeID(const char *scope)
+    {
+        boost::mutex::scoped_lock lock(profileMutex);
+
+        string scopeName(scope);
+
+        vector<string>::iterator scopeIterator = find(scopeNames.begin(),scopeNames.end(),scopeName);
+        if (scopeIterator!=scopeNames.end())
+        {
+            return int(scopeIterator-scopeNames.begin());
+        }
+
+        scopeNames.push_back(scopeName);
+        scopeTimed.push_back(false);
+        return int(scopeNames.size())-1;
+    }
+
+    void Profiler::addTime(int scopeID,unsigned long microseconds)
+    {
+        ThreadTimes *times = currentThreadTimes.get();
+        if (!times)
+        {
+            times = new ThreadTimes();
+            currentThreadTimes.reset(times);
+
+            boost::mutex::scoped_lock lock(profileMutex);
+            threadTimes.push_back(times);
+        }
+
+        boost::mutex::scoped_lock threadLock(times->mutex);
+
+        if (scopeID>=(int)times->microseconds.size())
+        {
+            times->microseconds.resize(scopeID+1,0);
+            times->runs.resize(scopeID+1,0);
+        }
+
+        times->microseconds[scopeID] += microseconds;
+        times->runs[scopeID]++;
+    }
+}
@@ -20,6 +20,25 @@ namespace NEAT
             normalGen(generator,normalDist)
     {}
 
+    unsigned long long Random::mixBits(unsigned long long value)
+    {
+        //SplitMix64 finalizer, a cheap mixing function with full avalanche
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    unsigned int Random::deriveSeed(unsigned int seed,int stream,int substream)
+    {
+        unsigned long long value = mixBits(seed);
+        value = mixBits(value ^ (unsigned int)stream);
+        value = mixBits(value ^ (unsigned int)substream);
+
+        //minstd_rand needs a seed in [1,2^31-2]
+        return 1 + (unsigned int)(value % 2147483646ULL);
+    }
+
     int Random::getRandomInt(int limit)
     {
         int randNum = intGen()%limit;
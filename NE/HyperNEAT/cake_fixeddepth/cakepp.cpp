@@ -41,19 +41,18 @@ int max(int a,int b)
 #endif
 
 //-------------------------------------------------------------------------------//
-// globals below here are shared - even with these, cake *should* be thread-safe //
+// globals below here are shared - they are only written by initcake, so cake is //
+// thread-safe as long as every thread searches with its own CAKE_CONTEXT       //
 //-------------------------------------------------------------------------------//
 
-static int iscapture[MAXDEPTH];		// tells whether move at realdepth was a capture
-
 int hashmegabytes = 64;				// default hashtable size in MB if no value in registry is found
 int dbmegabytes = 128;				// default db cache size in MB if no value in registry is found
 int usethebook = BOOKALLKINDS;					// default: use best moves if no value in the registry is found
 
-static HASHENTRY *hashtable;		// pointer to the hashtable, is allocated at startup
+static CAKE_CONTEXT *defaultcontext;	// context of analyze and bookgen, is allocated at startup
 static HASHENTRY *book;				// pointer to the book hashtable, is allocated at startup
 
-int hashsize = HASHSIZE;
+int hashsize = HASHSIZE;			// hashtable size of new contexts
 
 #ifdef SPA
 static SPA_ENTRY *spatable;
@@ -65,11 +64,6 @@ int maxNdb=0;						// the largest number of stones which is still in the databas
 
 static int cakeisinit = 0;			// is set to 1 after cake is initialized, i.e. initcake has been called
 
-// history table array
-#ifdef MOHISTORY
-int32 history[32][32];
-#endif
-
 // hashxors array.
 int32 hashxors[2][4][32];			// this is initialized to constant hashxors stored in the code.
 
@@ -78,8 +72,6 @@ static unsigned char bitsinword[65536];
 static unsigned char bitsinbyte[256];
 static unsigned char LSBarray[256];
 
-static int   norefresh;
-
 int bookentries = 0; // number of entries in book hashtable
 int bookmovenum = 0; // number of used entries in book
 
@@ -144,7 +136,14 @@ int initcake(char str[1024])
 	// allocate hashtable
 	sprintf(str,"allocating hashtable...");
 	printf("Allocating hashtable...");
-	hashtable = inithashtable(hashsize);
+	defaultcontext = cake_newcontext();
+	if(defaultcontext == NULL)
+	{
+		printf("malloc failure in initcake (hashtable memory allocation failed)");
+		sprintf(str,"malloc failure in initcake (hashtable memory allocation failed)");
+		logtofile(str);
+		exit(0);
+	}
 	printf("Done!\n");
 
 	// initialize xors 
@@ -180,7 +179,7 @@ void resetsearchinfo(SEARCHINFO *s)
 {
 	// resets the search info structure nearly completely, with the exception of
 	// the pointer si.repcheck, to which we allocated memory during initialization - 
-	// we don't want to create a memory leak here.
+	// we don't want to create a memory leak here. si.context is kept as well.
 	s->aborttime = 0;
 	s->allscores = 0;
 	s->bk = 0;
@@ -223,14 +222,67 @@ void resetsearchinfo(SEARCHINFO *s)
 
 
 
+static int allocatehashtable(CAKE_CONTEXT *c, int size)
+{
+	// (re)allocates the hashtable of a context with size entries, aligned on 
+	// a 64-byte-boundary. returns 0 and leaves the context alone if there is 
+	// not enough memory.
+	void *memory;
+	size_t address;
+
+	memory = malloc((size+HASHITER)*sizeof(HASHENTRY)+64);
+	if(memory == NULL)
+		return 0;
+
+	free(c->hashmemory);
+
+	address = (size_t)memory;
+	address += (64-(address%64));
+
+	c->hashmemory = memory;
+	c->hashtable = (HASHENTRY*)address;
+	c->hashsize = size;
+	memset(c->hashtable,0,(size+HASHITER)*sizeof(HASHENTRY));
+	return 1;
+}
+
+CAKE_CONTEXT *cake_newcontext(void)
+{
+	// allocates a search context with a hashtable of hashsize entries. 
+	// set si->context to it before calling cake_getmove; searches that run
+	// at the same time must not share a context. returns NULL if there is 
+	// not enough memory.
+	CAKE_CONTEXT *c;
+
+	c = (CAKE_CONTEXT*)malloc(sizeof(CAKE_CONTEXT));
+	if(c == NULL)
+		return NULL;
+
+	memset(c,0,sizeof(CAKE_CONTEXT));
+	c->randomseed = 1;
+
+	if(!allocatehashtable(c,hashsize))
+	{
+		free(c);
+		return NULL;
+	}
+	return c;
+}
+
+void cake_freecontext(CAKE_CONTEXT *c)
+{
+	if(c == NULL)
+		return;
+	free(c->hashmemory);
+	free(c);
+}
+
 int hashreallocate(int x)
 {
 	// TODO: move to little-used functions file
-	// reallocates the hashtable to x MB
-
-	static int currenthashsize;
+	// reallocates the hashtable of the default context to x MB; contexts 
+	// allocated afterwards get the same size.
 
-	HASHENTRY *pointer;
 	int newsize;
 
 	hashmegabytes = x;
@@ -240,18 +292,9 @@ int hashreallocate(int x)
 	// with sizeof(HASHENTRY) == 8 bytes, but if i ever change that it will
 	// fail
 
-#ifdef WINMEM
-	VirtualFree(hashtable, 0, MEM_RELEASE);
-	pointer = VirtualAlloc(0, (newsize+HASHITER)*sizeof(HASHENTRY), MEM_COMMIT, PAGE_READWRITE);
-#else
-	pointer = (HASHENTRY*)realloc(hashtable,(newsize+HASHITER)*sizeof(HASHENTRY));
-#endif
-	if(pointer != NULL)
-	{
+	if(allocatehashtable(defaultcontext,newsize))
 		hashsize = newsize;
-		hashtable = pointer;
-	}
-	// TODO: do something if pointer == NULLbut what do we do when pointer == 0 here??
+	// TODO: do something if the allocation fails
 	return 1;
 }
 
@@ -306,6 +349,7 @@ int bookgen(OLDPOSITION *q, int color, int *numberofmoves, int values[MAXMOVES],
 
 	// reset all counters, nodes, database lookups etc 
 	resetsearchinfo(&si);
+	si.context = defaultcontext;
 
 	// allocate memory for repcheck array
 	si.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET) * sizeof(REPETITION));
@@ -330,15 +374,15 @@ int bookgen(OLDPOSITION *q, int color, int *numberofmoves, int values[MAXMOVES],
 
 #ifdef MOHISTORY
 	// reset history table 
-	memset(history,0,32*32*sizeof(int));
+	memset(si.context->history,0,32*32*sizeof(int32));
 #endif
 
 	printboard(&p);
 
 	// clear the hashtable 
-	memset(hashtable,0,(hashsize+HASHITER)*sizeof(HASHENTRY));
+	memset(si.context->hashtable,0,(si.context->hashsize+HASHITER)*sizeof(HASHENTRY));
 
-	norefresh=0;
+	si.context->norefresh=0;
 
 	n = makecapturelist(&p, movelist, values, 0);
 	if(!n)
@@ -457,7 +501,7 @@ int bookgen(OLDPOSITION *q, int color, int *numberofmoves, int values[MAXMOVES],
 
 		lastvalue=value;	// save the value for this iteration 
 		last=best;			// save the best move on this iteration 
-		norefresh=1;
+		si.context->norefresh=1;
 	}
 
 	free(si.repcheck);
@@ -538,6 +582,7 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 	d = getorderedmovelist(p, movelist);
 
 	resetsearchinfo(&si);
+	si.context = defaultcontext;
 
 	// allocate memory for repcheck array
 	si.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET) * sizeof(REPETITION));
@@ -558,7 +603,7 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 
 #ifdef MOHISTORY
 	// reset history table 
-	memset(history,0,32*32*sizeof(int));
+	memset(si.context->history,0,32*32*sizeof(int32));
 #endif
 
 
@@ -570,10 +615,10 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 	//if((analyzedpositions % 100000) == 0)
 	//	{
 	printf("\nresetting hashtable");
-	memset(hashtable,0,(hashsize+HASHITER)*sizeof(HASHENTRY));
+	memset(si.context->hashtable,0,(si.context->hashsize+HASHITER)*sizeof(HASHENTRY));
 	//	}
 
-	norefresh=0;
+	si.context->norefresh=0;
 
 	// initialize hash key 
 	absolutehashkey(p, &(si.hash));
@@ -643,7 +688,7 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 
 		lastvalue=value;	// save the value for this iteration 
 		last=best;			// save the best move on this iteration 
-		norefresh=1;
+		si.context->norefresh=1;
 	}
 
 	free(si.repcheck);
@@ -671,6 +716,8 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 	/*		if(log&2) cake will also print the information to stdout.
 	/*		if reset!=0 cake++ will reset hashtables and repetition checklist
 	/*		reset==0 generally means that the normal course of the game was disturbed
+	/*		si->context must be a context from cake_newcontext which no other search
+	/*		uses at the same time; with one context each, threads can search in parallel.
 	// info currently has uses for it's first 4 bits:
 	// info&1 means reset
 	// info&2 means exact time level
@@ -709,7 +756,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 	resetsearchinfo(si);
 
 	for(i=0;i<MAXDEPTH;i++)
-		iscapture[i] = 0;
+		si->context->iscapture[i] = 0;
 
 
 	*playnow = 0;
@@ -740,13 +787,11 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 
 #ifdef MOHISTORY
 	// reset history table 
-	fflush(stdout);
-	memset(history,0,32*32*sizeof(int));
+	memset(si->context->history,0,32*32*sizeof(int32));
 #endif
 
 	// clear the hashtable 
-	fflush(stdout);
-	memset(hashtable,0,(hashsize+HASHITER)*sizeof(HASHENTRY));
+	memset(si->context->hashtable,0,(si->context->hashsize+HASHITER)*sizeof(HASHENTRY));
 
 	// initialize hash key 
 	absolutehashkey(p, &(si->hash));
@@ -757,7 +802,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 #endif
 
 	// what is this doing at all?
-	norefresh=0;
+	si->context->norefresh=0;
 
 	// what is this doing here?
 	n = makecapturelist(p, movelist, values, 0);
@@ -796,7 +841,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 		bookfound=0;
 		bookindex=0;
 
-		if(booklookup(p,&booklookupvalue,0,&bookdepth,&bookindex,str))
+		if(booklookup(si->context,p,&booklookupvalue,0,&bookdepth,&bookindex,str))
 		{
 			// booklookup was successful, it sets bookindex to the index of the move in movelist that it wants to play
 			bookfound = 1;
@@ -929,7 +974,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 
 			lastvalue=value;	// save the value for this iteration 
 			last=best;			// save the best move on this iteration 
-			norefresh=1;
+			si->context->norefresh=1;
 		}
 	}
 
@@ -1128,7 +1173,7 @@ int windowsearch(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int
 int allscoresearch(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int d, CAKE_MOVE *best)
 {
 	int i, j, n;
-	static int values[MAXMOVES];
+	int values[MAXMOVES];
 	int bestindex = 0;
 	char str[256], tmpstr[256], movestr[256];
 	int Lkiller;
@@ -1235,15 +1280,14 @@ int firstnegamax(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int
 	--------------------------------------------------------------------------*/
 
 	int i,value,swap=0,bestvalue=-MATE;
-	static int n;
-	static CAKE_MOVE ml2[MAXMOVES];
+	int n;
+	CAKE_MOVE ml2[MAXMOVES];
 	MATERIALCOUNT Lmatcount;
 	int Lalpha=alpha;
 	int forcefirst=0;
 	int Lkiller=0;
-	static POSITION last;
 	CAKE_MOVE tmpmove;
-	static int values[MAXMOVES];	/* holds the values of the respective moves - use to order */
+	int values[MAXMOVES];			/* holds the values of the respective moves - use to order */
 	int refnodes[MAXMOVES];			/* number of nodes searched to refute a move */
 	int statvalues[MAXMOVES];
 	int tmpnodes;
@@ -1255,9 +1299,6 @@ int firstnegamax(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int
 #endif
 	si->negamax++;
 
-	// TODO: will static position last work here? and static movelist??
-	// probably i need to make a movelist in mtdf and send it to firstnegamax!
-
 	for(i=0;i<MAXMOVES;i++)
 		refnodes[i] = 0;
 
@@ -1319,7 +1360,7 @@ int firstnegamax(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int
 	// what if we don't set forcefirst here, i.e. set it to 0?
 	n = makecapturelist(p, ml2, statvalues, 0);
 
-	iscapture[si->realdepth] = n;
+	si->context->iscapture[si->realdepth] = n;
 
 	if(n==0)
 		n = makemovelist(si, p, ml2, statvalues, 0,0);
@@ -1351,7 +1392,6 @@ int firstnegamax(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int
 		movelist[0] = tmpmove;
 		refnodes[0] = tmpnodes;
 	}
-	last=*p;
 	return bestvalue;
 }
 
@@ -1524,7 +1564,7 @@ int negamax(SEARCHINFO *si, POSITION *p, int d, int alpha, int *protokiller, int
 	else
 		n = 0;
 
-	iscapture[si->realdepth] = n;
+	si->context->iscapture[si->realdepth] = n;
 
 	//--------------------------------------------//
 	// check for database use                     // 
@@ -1799,6 +1839,8 @@ void hashstore(SEARCHINFO *si, POSITION *p, int value, int alpha, int depth, CAK
 	int32 index,minindex;
 	int mindepth=1000,iter=0;
 	int from,to;
+	HASHENTRY *hashtable = si->context->hashtable;
+	int hashsize = si->context->hashsize;
 
 	si->hashstores++;
 	//assert(alpha == beta-1);
@@ -1809,13 +1851,13 @@ void hashstore(SEARCHINFO *si, POSITION *p, int value, int alpha, int depth, CAK
 	{
 		from = (best->bm|best->bk)&(p->bm|p->bk);    /* bit set on square from */
 		to   = (best->bm|best->bk)&(~(p->bm|p->bk));
-		history[LSB(from)][LSB(to)]++;
+		si->context->history[LSB(from)][LSB(to)]++;
 	}
 	else
 	{
 		from = (best->wm|best->wk)&(p->wm|p->wk);    /* bit set on square from */
 		to   = (best->wm|best->wk)&(~(p->wm|p->wk));
-		history[LSB(from)][LSB(to)]++;
+		si->context->history[LSB(from)][LSB(to)]++;
 	}
 #endif
 
@@ -1894,6 +1936,8 @@ int hashlookup(SEARCHINFO *si, int *value, int *valuetype, int depth, int *force
 
 	int32 index;
 	int iter=0;
+	HASHENTRY *hashtable = si->context->hashtable;
+	int hashsize = si->context->hashsize;
 
 	index = si->hash.key & (hashsize-1); // expects that hashsize is a power of 2!
 
@@ -1929,6 +1973,8 @@ int pvhashlookup(SEARCHINFO *si, int *value, int *valuetype, int depth, int32 *f
 	// in the hashtable as being part of the PV
 	int32 index;
 	int iter=0;
+	HASHENTRY *hashtable = si->context->hashtable;
+	int hashsize = si->context->hashsize;
 
 	index = si->hash.key & (hashsize-1);
 
@@ -2208,7 +2254,7 @@ void countmaterial(POSITION *p, MATERIALCOUNT *m)
 
 // TODO: put this into book.c
 
-int booklookup(POSITION *p, int *value, int depth, int32 *remainingdepth, int *best, char str[256])
+int booklookup(CAKE_CONTEXT *context, POSITION *p, int *value, int depth, int32 *remainingdepth, int *best, char str[256])
 {
 	/* searches for a position in the book hashtable.
 	*/
@@ -2231,6 +2277,7 @@ int booklookup(POSITION *p, int *value, int depth, int32 *remainingdepth, int *b
 	HASH hash;
 	SEARCHINFO s;
 	resetsearchinfo(&s);
+	s.context = context;
 
 	bucketsize = BUCKETSIZEBOOK;
 	pointer = book;
@@ -2388,7 +2435,10 @@ int booklookup(POSITION *p, int *value, int depth, int32 *remainingdepth, int *b
 			if(bookmoves !=0)
 			{
 				//srand( (unsigned)time( NULL ) );
-				i = rand() % bookmoves;
+				// same generator as the example rand() of the C standard, but
+				// with the state in the context so that threads don't share it
+				context->randomseed = context->randomseed*1103515245 + 12345;
+				i = ((context->randomseed>>16) & 0x7FFF) % bookmoves;
 				*remainingdepth = depths[i];
 				*value = values[i];
 				*best = indices[i];
@@ -11,8 +11,10 @@
 void absolutehashkey(POSITION *p, HASH *hash);
 int allscoresearch(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int d, CAKE_MOVE *best);
 int bitcount(int32 n);
-static int booklookup(POSITION *p, int *value, int depth, int32 *best, int *bestindex, char str[256]);
+static int booklookup(CAKE_CONTEXT *context, POSITION *p, int *value, int depth, int32 *best, int *bestindex, char str[256]);
 int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maxtime, int depthtosearch,int32 maxnodes, char str[1024], int *playnow, int logging,int reset);
+void cake_freecontext(CAKE_CONTEXT *c);
+CAKE_CONTEXT *cake_newcontext(void);
 void countmaterial(POSITION *p, MATERIALCOUNT *m);
 int exitcake();
 static int firstnegamax(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int d, int alpha, int beta, CAKE_MOVE *best);
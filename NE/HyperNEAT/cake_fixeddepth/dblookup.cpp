@@ -79,6 +79,28 @@ typedef long long int int64;
 
 #include "dblookup.h"
 
+#ifdef MMAPDB
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+// the block cache is the only part of the database that changes after db_init.
+// searches with their own CAKE_CONTEXT may look up positions at the same time,
+// so they take turns on the cache.
+#ifdef WIN32
+#define NOMINMAX
+#include <windows.h>
+static CRITICAL_SECTION cache_access;
+#define LOCKCACHE EnterCriticalSection(&cache_access)
+#define UNLOCKCACHE LeaveCriticalSection(&cache_access)
+#else
+#include <pthread.h>
+static pthread_mutex_t cache_access = PTHREAD_MUTEX_INITIALIZER;
+#define LOCKCACHE pthread_mutex_lock(&cache_access)
+#define UNLOCKCACHE pthread_mutex_unlock(&cache_access)
+#endif
+#endif
+
 
 
 
@@ -114,6 +136,11 @@ static int parseindexfile(char idxfilename[256],int blockoffset,int fpcount);
 static int preload(char out[256]);
 #endif
 
+#ifdef MMAPDB
+static void mapdbfile(int n);
+static void preloadmap(int fpcount);
+#endif
+
 #define hiword(x) (((x)&0xFFFF0000)>>16)
 #define loword(x) ((x)&0xFFFF)
 
@@ -134,7 +161,9 @@ static struct bi
 	int prev;     // which is the index of the last blockinfo in the linked list
 	} *blockinfo;
 
+#ifndef MMAPDB
 static int head,tail; // array index of head and tail of the linked list.
+#endif
 
 
 // run-length-decoder definitions and variables.
@@ -161,6 +190,12 @@ static int maxblockid = 0;  // maximal unique block id, set by initlookup after
 static FILE *dbfp[MAXFP]; // file pointers to db2...dbn - always open.
 static char dbnames[MAXFP][256]; // write in here what each dbfp is pointing to
 
+#ifdef MMAPDB
+static unsigned char *dbmap[MAXFP]; // read-only mapping of each db file, NULL if dbfp[i] is NULL
+static size_t dbmapsize[MAXFP];
+static unsigned char *blockresident; // 1 if block #i (unique block id) is known to be in memory
+#endif
+
 // database path
 char DBpath[256];
 
@@ -204,9 +239,17 @@ int dblookup(POSITION *q,int cl)
 
 	int reverse = 0;
 	int returnvalue=DB_UNKNOWN;
-	int memsize = 0;
 	unsigned char *diskblock;
+#ifdef MMAPDB
+	size_t blockstart;
+#ifdef __linux__
+	unsigned char pageresident;
+#else
+	char pageresident;
+#endif
+#else
 	int newhead,prev, next;
+#endif
 
 	int n;
 	int n1,n2,n3;
@@ -435,6 +478,29 @@ int dblookup(POSITION *q,int cl)
 					blocknumber;
 
 
+#ifdef MMAPDB
+	// the whole file is mapped - the OS reads the block in if it's not in memory yet.
+	blockstart = (size_t)(blocknumber+dbpointer->firstblock)*1024;
+	if(blockstart >= dbmapsize[dbpointer->fp])
+		return DB_UNKNOWN;
+	diskblock = dbmap[dbpointer->fp] + blockstart;
+
+	// as with the block cache, a "conditional lookup" doesn't wait for the disk:
+	// it only goes ahead if the block is in memory already. blocks are 1K-aligned
+	// in the file, so a block never straddles two pages.
+	if(!blockresident[uniqueblockid])
+		{
+		if(cl==1)
+			{
+			if(mincore(dbmap[dbpointer->fp] + (blockstart & ~(size_t)(sysconf(_SC_PAGESIZE)-1)),1,&pageresident) != 0
+				|| !(pageresident & 1))
+				return DB_NOT_LOOKED_UP;
+			}
+		blockresident[uniqueblockid] = 1;
+		}
+#else
+	LOCKCACHE;
+
 	// check if it is loaded:
 	if(blockpointer[uniqueblockid] != NULL)
 		//yes!
@@ -484,7 +550,10 @@ int dblookup(POSITION *q,int cl)
 		{
 		// if the lookup was a "conditional lookup", we don't load the block
 		if(cl==1)
+			{
+			UNLOCKCACHE;
 			return DB_NOT_LOOKED_UP;
+			}
 
 		//------------------------------------------------
 		// new LRU code
@@ -535,6 +604,7 @@ int dblookup(POSITION *q,int cl)
 	printf("\nblock with ID %i, loaded to address %i",uniqueblockid,diskblock);
 #endif
 		}
+#endif // MMAPDB
 	// the block we were looking for is now pointed to by diskblock
 	// and it has been moved to the head of the linked list
 	// now we decompress the memory block
@@ -636,6 +706,10 @@ int dblookup(POSITION *q,int cl)
 				break;
 			}
 		}
+
+#ifndef MMAPDB
+	UNLOCKCACHE;
+#endif
 	
 	returnvalue++;
 
@@ -792,13 +866,28 @@ int db_exit(void)
     free(cachebaseaddress);
     free(blockpointer);
     free(blockinfo);
+#ifdef MMAPDB
+	free(blockresident);
+	blockresident = NULL;
+#endif
 	
 	for(i=0;i<50;i++)
 		{
+#ifdef MMAPDB
+		if(dbmap[i] != NULL)
+			{
+			munmap(dbmap[i],dbmapsize[i]);
+			dbmap[i] = NULL;
+			}
+#endif
 		if(dbfp[i] != NULL)
 			fclose(dbfp[i]);	
 		}
 
+#ifdef WIN32
+	DeleteCriticalSection(&cache_access);
+#endif
+
 	return 1;
 	}
 
@@ -817,15 +906,21 @@ int db_init(int suggestedMB, char out[256])
 	int bm,bk,wm,wk;
 	int singlevalue=0;
 	int blockoffset = 0;
-	int autoloadnum = 0;
 	int fpcount = 0;
 	int pifreturnvalue;
 	int pieces=0;
+#ifndef MMAPDB
+	int autoloadnum = 0;
 	int memsize;
+#endif
 	char str[256];
 
 
 	
+#ifdef WIN32
+	InitializeCriticalSection(&cache_access);
+#endif
+
 	//dblogfp = fopen("dbinit.txt","w");
 	// initialize bitsinword, the number of bits in a word
 	
@@ -1082,6 +1177,18 @@ int db_init(int suggestedMB, char out[256])
 	// index files are parsed!
 	
 	
+#ifdef MMAPDB
+	// the db files are mapped below; there is no cache to set up, only the
+	// flags of the blocks which are known to be in memory. cachesize is the
+	// number of blocks which are read in at the start, like PRELOAD does.
+	blockresident = (unsigned char*)calloc(maxblocknum,1);
+	if(blockresident == NULL && maxblocknum != 0)
+		{
+		sprintf(str,"\ncould not allocate block flags (%i blocks)",maxblocknum);
+		logtofile(str);
+		exit(0);
+		}
+#else
 	// allocate memory for the cache
 	memsize = cachesize*1024;
 	//cachebaseaddress = VirtualAlloc(0,memsize,MEM_RESERVE|MEM_COMMIT|MEM_TOP_DOWN,PAGE_READWRITE);
@@ -1166,6 +1273,7 @@ int db_init(int suggestedMB, char out[256])
 	
 	head=autoloadnum; //0
 	tail = cachesize-1;
+#endif // MMAPDB
 
 
 
@@ -1183,6 +1291,9 @@ int db_init(int suggestedMB, char out[256])
 			//getch();
 			//exit(0);
 			}
+#ifdef MMAPDB
+		mapdbfile(fpcount);
+#endif
 		fpcount++;
 		}
 
@@ -1211,15 +1322,86 @@ int db_init(int suggestedMB, char out[256])
 						//getch();
 						//exit(0);
 						}
+#ifdef MMAPDB
+					mapdbfile(fpcount);
+#endif
 					fpcount++;
 					}
 				}
 			}
 		}
 	
+#ifdef MMAPDB
+	preloadmap(fpcount);
+#endif
 	return maxpieces;
 	}
 
+#ifdef MMAPDB
+static void mapdbfile(int n)
+	{
+	// maps the open db file dbfp[n] read-only. the mapping shares its pages with
+	// every other process which maps the same file. if the file can't be mapped,
+	// it is closed, and the databases in it count as not present.
+	struct stat filestat;
+	void *map;
+	char str[512];
+
+	dbmap[n] = NULL;
+	dbmapsize[n] = 0;
+	if(dbfp[n] == NULL)
+		return;
+
+	if(fstat(fileno(dbfp[n]),&filestat) == 0 && filestat.st_size > 0)
+		{
+		map = mmap(NULL,filestat.st_size,PROT_READ,MAP_SHARED,fileno(dbfp[n]),0);
+		if(map != MAP_FAILED)
+			{
+			// lookups jump all over the file, reading ahead would only waste memory
+			madvise(map,filestat.st_size,MADV_RANDOM);
+			dbmap[n] = (unsigned char*)map;
+			dbmapsize[n] = filestat.st_size;
+			return;
+			}
+		}
+
+	sprintf(str,"\ncould not map %s",dbnames[n]);
+	logtofile(str);
+	fclose(dbfp[n]);
+	dbfp[n] = NULL;
+	}
+
+static void preloadmap(int fpcount)
+	{
+	// the mapped counterpart of preload(): reads the dbs in the same order until
+	// cachesize blocks are in memory, and marks them, so that conditional lookups
+	// find the same blocks as with the preloaded cache.
+	int n;
+	int uniqueid = 0;
+	size_t blockstart;
+	volatile unsigned char touch = 0;
+
+	for(n=0;n<fpcount;n++)
+		{
+		if(dbmap[n] == NULL)
+			{
+			// preload() stops at the first missing split db
+			if(n < SPLITSIZE-2)
+				return;
+			continue;
+			}
+		for(blockstart=0;blockstart<dbmapsize[n];blockstart+=1024)
+			{
+			if(uniqueid == cachesize || uniqueid == maxblocknum)
+				return;
+			touch ^= dbmap[n][blockstart];
+			blockresident[uniqueid] = 1;
+			uniqueid++;
+			}
+		}
+	}
+#endif
+
 #ifdef PRELOAD
 static int preload(char out[256])
 	{
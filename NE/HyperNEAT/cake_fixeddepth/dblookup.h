@@ -7,7 +7,16 @@
 
 // choose which db you want to use
 
+// map the db files into memory instead of reading blocks into a private cache?
+// then all processes on a machine share the db through the OS page cache, and
+// a block is only read from disk when a lookup first touches it.
+#ifndef WIN32
+#define MMAPDB
+#endif
+
+#ifndef MMAPDB
 #define PRELOAD // preload (parts) of db in cache? 
+#endif
 
 #define AUTOLOADSIZE 0
 
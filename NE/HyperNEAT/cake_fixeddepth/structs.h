@@ -9,6 +9,8 @@
  */
 /* structs.h: data structures for cake++ */
 
+#include "switches.h"
+
 /*definitions for platform-independence*/
 #define int32 unsigned int
 #define int16 unsigned short
@@ -56,6 +58,9 @@ typedef struct
 	int irreversible;
 	} REPETITION;
 
+class CheckersAdvisor;
+struct cakecontext;
+
 typedef struct
 	{
 	int32 negamax;
@@ -89,6 +94,7 @@ typedef struct
 	HASH hash;
 	MATERIALCOUNT matcount;
 	REPETITION *repcheck;
+	struct cakecontext *context;	// the hashtable etc. of this search, see cake_newcontext
 	double start;
 	double maxtime;
 	double aborttime;
@@ -183,6 +189,21 @@ typedef struct
 	unsigned int valuetype:2;
 	} HASHENTRY;
 
+typedef struct cakecontext
+	// everything a search writes to apart from its SEARCHINFO. searches that
+	// run at the same time need a context each; the book, the endgame database
+	// and the evaluation tables are only read during a search and are shared.
+	{
+	HASHENTRY *hashtable;
+	void *hashmemory;			// hashtable before it was aligned - this is what we free
+	int hashsize;
+	int iscapture[MAXDEPTH];	// tells whether move at realdepth was a capture
+	int32 history[32][32];		// history table for move ordering
+	int norefresh;
+	int32 randomseed;			// picks among equivalent book moves
+	CheckersAdvisor *advisor;	// if not NULL, orders the moves deeper in the tree
+	} CAKE_CONTEXT;
+
 
 
 struct bookhashentry
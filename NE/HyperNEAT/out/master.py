@@ -31,7 +31,7 @@
 import argparse, os, subprocess, time, sys
 
 # Submits a condor job which starts a worker running
-def startWorker(workerNum, executable, resultsDir, dataFile, numIndividuals, numGenerations, seed, rom):
+def startWorker(workerNum, executable, resultsDir, dataFile, numIndividuals, numGenerations, seed, rom, batchSize=0):
     cOutFile = os.path.join(resultsDir,"worker" + str(workerNum) + ".out")
     cErrFile = os.path.join(resultsDir,"worker" + str(workerNum) + ".err")
     cLogFile = os.path.join(resultsDir,"worker" + str(workerNum) + ".log")
@@ -42,7 +42,7 @@ def startWorker(workerNum, executable, resultsDir, dataFile, numIndividuals, num
     universe = vanilla\n\
     getenv = true\n\
     Executable = " + "/lusr/bin/python" + "\n\
-    Arguments = worker.py -e "+ executable + " -r " + resultsDir + " -d " + dataFile + " -n " + str(numIndividuals) + " -g " + str(numGenerations) + " -R " + str(seed) + " -G " + rom + "\n\
+    Arguments = worker.py -e "+ executable + " -r " + resultsDir + " -d " + dataFile + " -n " + str(numIndividuals) + " -g " + str(numGenerations) + " -R " + str(seed) + " -G " + rom + " -b " + str(batchSize) + "\n\
     Requirements = Lucid && Arch == \"x86_64\"\n\
     +Group=\"GRAD\"\n\
     +Project=\"AI_ROBOTICS\"\n\
@@ -90,6 +90,9 @@ parser.add_argument('-w', metavar='num-workers', required=True, type=int,
                     help='The number of workers devoted to running this game.')
 parser.add_argument('-R', metavar='random-seed', required=False, type=int, default=-1,
                     help='Seed the random number generator.')
+parser.add_argument('-b', metavar='batch-size', required=False, type=int, default=0,
+                    help='Individuals per request to each worker\'s evaluation server. '
+                    '0 starts a process per individual.')
 
 
 args = parser.parse_args()
@@ -102,6 +105,7 @@ maxGeneration            = args.g
 resultsDir               = args.r
 individualsPerGeneration = args.n
 numWorkers               = args.w
+batchSize                = args.b
 
 if not os.path.exists(rom):
     print 'Rom not found. Exiting.'
@@ -139,7 +143,7 @@ procIDs = {} # Maps pid --> worker num
 for i in range(numWorkers):
     pid = -1
     while pid < 0:
-        pid = startWorker(workerNum, executable, resultsDir, dataFile, individualsPerGeneration, maxGeneration, seed, rom)
+        pid = startWorker(workerNum, executable, resultsDir, dataFile, individualsPerGeneration, maxGeneration, seed, rom, batchSize)
     procIDs[pid] = workerNum
     workerNum += 1
 
@@ -197,7 +201,7 @@ while currentGeneration < maxGeneration:
             pid = -1
             while pid < 0:
                 pid = startWorker(workerNum, executable, resultsDir, dataFile,
-                                  individualsPerGeneration, maxGeneration, seed, rom)
+                                  individualsPerGeneration, maxGeneration, seed, rom, batchSize)
             procIDs[pid] = workerNum
             workerNum += 1
 
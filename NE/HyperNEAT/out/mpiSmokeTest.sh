@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# Runs a few generations of an experiment with Hypercube_NEAT_MPI under
+# mpirun -np N for each N, and checks that every N gives the same champion
+# fitness in every generation.  Build the binary with BUILD_MPI=ON, and run
+# this from the directory with cake_engines/, like the other binaries.
+#
+# Set MPI_BINARY to use another binary, and MPIRUN_FLAGS to pass extra flags
+# to mpirun (for example --allow-run-as-root).
+
+if [ $# -lt 1 ]
+then
+    echo "Usage: $0 params_file [generations] [seed] [process counts]"
+    echo "Example: $0 data/FindClusterExperiment.dat 5 1 1 2 4"
+    exit 1
+fi
+
+PARAMS=$1
+GENERATIONS=${2:-5}
+SEED=${3:-1}
+if [ $# -gt 3 ]
+then
+    shift 3
+    COUNTS=$*
+else
+    COUNTS="1 2 4"
+fi
+BINARY=${MPI_BINARY:-./Hypercube_NEAT_MPI}
+
+WORKDIR=$(mktemp -d)
+trap "rm -rf $WORKDIR" EXIT
+
+sed "s/^MaxGenerations.*/MaxGenerations $GENERATIONS.0/" $PARAMS > $WORKDIR/params.dat
+
+REFERENCE=
+for N in $COUNTS; do
+    mpirun --oversubscribe $MPIRUN_FLAGS -np $N $BINARY -R $SEED -I $WORKDIR/params.dat -O $WORKDIR/np$N.xml > $WORKDIR/np$N.out 2>&1
+    grep "Champion fitness" $WORKDIR/np$N.out > $WORKDIR/np$N.fitness
+
+    if [ ! -s $WORKDIR/np$N.fitness ]
+    then
+        echo "-np $N: no fitness in the output:"
+        tail -n 20 $WORKDIR/np$N.out
+        exit 1
+    fi
+
+    echo "-np $N: $(wc -l < $WORKDIR/np$N.fitness) generations, $(tail -n 1 $WORKDIR/np$N.fitness)"
+
+    if [ -z "$REFERENCE" ]
+    then
+        REFERENCE=$N
+    elif ! diff $WORKDIR/np$REFERENCE.fitness $WORKDIR/np$N.fitness > /dev/null
+    then
+        echo "-np $N gives a different fitness than -np $REFERENCE:"
+        diff $WORKDIR/np$REFERENCE.fitness $WORKDIR/np$N.fitness | head -n 10
+        exit 1
+    fi
+done
+
+echo "The fitness is the same for every process count"
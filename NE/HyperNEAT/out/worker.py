@@ -24,14 +24,54 @@
 # `--`\____       __..---~~ ~~--..~--------~~   |                  ,'       ,'
 #                                           "Catbus" (from "My Neighbor Totoro")
 
-import argparse, os, random, time, sys
+import argparse, os, random, socket, subprocess, time, sys
 
 # This runs a single Atari game.
 def run_game(executable, dataFile, generationFile, individualId, fitnessFile, seed, rom):
     from subprocess import check_call
     check_call(["./" + executable, "-I", dataFile, "-P", generationFile, "-N",
                      str(individualId), "-F", fitnessFile, "-R", seed, "-G", rom])
-                    
+
+# Keeps one atari_evaluate process running in server mode, so the rom is
+# loaded once and the population once per generation.
+class EvaluationServer:
+    def __init__(self, executable, dataFile, seed, rom, socketPath):
+        if os.path.exists(socketPath):
+            os.remove(socketPath)
+        self.process = subprocess.Popen(["./" + executable, "-I", dataFile, "-R", seed,
+                                         "-G", rom, "-S", socketPath])
+        start = time.time()
+        while not os.path.exists(socketPath):
+            if self.process.poll() is not None or time.time() - start >= 300:
+                raise RuntimeError('Evaluation server failed to start')
+            time.sleep(1)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(socketPath)
+        self.stream = self.sock.makefile('rw')
+
+    def request(self, line):
+        self.stream.write(line + '\n')
+        self.stream.flush()
+        response = self.stream.readline().strip()
+        if not response or response.startswith('ERROR'):
+            raise RuntimeError('Evaluation server: ' + line.split()[0] + ' failed: ' + response)
+        return response
+
+    def load(self, generationFile):
+        self.request('LOAD ' + generationFile)
+
+    def evaluate(self, individualIds):
+        response = self.request('EVAL ' + ' '.join(str(i) for i in individualIds))
+        return [float(f) for f in response.split()[1:]]
+
+    def close(self):
+        try:
+            self.request('QUIT')
+        except Exception:
+            pass
+        self.sock.close()
+        self.process.wait()
+
 parser = argparse.ArgumentParser(description='Runs Atari games without tire.')
 parser.add_argument('-e', metavar='atari_evaulate', required=True,
                     help='This should point to atari_evaluate executable.')
@@ -47,6 +87,9 @@ parser.add_argument('-G', metavar='rom-file', required=True,
                     help='This should point to the rom to be run.')
 parser.add_argument('-R', metavar='random-seed', required=False, type=int, default=-1,
                     help='Seed the random number generator.')
+parser.add_argument('-b', metavar='batch-size', required=False, type=int, default=0,
+                    help='Evaluate through one long-lived atari_evaluate server, sending this '
+                    'many individuals per request. 0 starts a process per individual.')
 
 args = parser.parse_args()
 rom                      = args.G
@@ -56,6 +99,12 @@ dataFile                 = args.d
 maxGeneration            = args.g
 resultsDir               = args.r
 individualsPerGeneration = args.n
+batchSize                = args.b
+
+server = None
+if batchSize > 0:
+    socketPath = os.path.join('/tmp', 'atari_evaluate.' + str(os.getpid()) + '.sock')
+    server = EvaluationServer(executable, dataFile, seed, rom, socketPath)
 
 # Detect the current generation
 currentGeneration = -1
@@ -81,20 +130,41 @@ while currentGeneration < maxGeneration:
             sys.stderr.flush()
             sys.exit(0)
 
+    if server:
+        server.load(generationPath)
+
     # Look for fitness files which indicate that games are being run
     individualIds = range(individualsPerGeneration)
     random.shuffle(individualIds)
-    for individualId in individualIds:
+    while individualIds:
         # Break out of this loop if the generation has ended
         nextGenPath = os.path.join(resultsDir,"generation" + str(currentGeneration+1) + ".ser.gz")
         if os.path.exists(nextGenPath): 
             break
-        fitnessFile = "fitness."+str(currentGeneration)+"."+str(individualId)
-        fitnessPath = os.path.join(resultsDir,fitnessFile)
-        if os.path.exists(fitnessPath):
+
+        # Take the next individuals nobody has evaluated yet
+        batch = []
+        while individualIds and len(batch) < max(1, batchSize):
+            individualId = individualIds.pop(0)
+            fitnessPath = os.path.join(resultsDir,"fitness."+str(currentGeneration)+"."+str(individualId))
+            if not os.path.exists(fitnessPath):
+                batch.append(individualId)
+        if not batch:
             continue
 
-        run_game(executable, dataFile, generationPath, individualId, fitnessPath, seed, rom)
+        if server:
+            fitnesses = server.evaluate(batch)
+            for individualId, fitness in zip(batch, fitnesses):
+                fitnessPath = os.path.join(resultsDir,"fitness."+str(currentGeneration)+"."+str(individualId))
+                fout = open(fitnessPath, 'w')
+                fout.write(str(fitness) + '\n')
+                fout.close()
+        else:
+            fitnessPath = os.path.join(resultsDir,"fitness."+str(currentGeneration)+"."+str(batch[0]))
+            run_game(executable, dataFile, generationPath, batch[0], fitnessPath, seed, rom)
 
     # By this time all fitness evaluations should be complete
     currentGeneration += 1
+
+if server:
+    server.close()